@@ -407,8 +407,13 @@ void Process(string ncdffile, string waspfile) {
 		exit(1);
 	}
 
+	// Integer wavelets require the netCDF-4 format
+	//
+	int cmode = opt.wname.compare(0, 3, "int") == 0 ? 
+		NC_NETCDF4 : NC_64BIT_OFFSET;
+
 	rc = wasp.Create(
-        waspfile, NC_64BIT_OFFSET, 0, chunksize, opt.cratios.size()
+        waspfile, cmode, 0, chunksize, opt.cratios.size()
     );
 	if (rc<0) {
 		MyBase::SetErrMsg("Error opening %s for writing", waspfile.c_str());
@@ -18,6 +18,11 @@ struct opt_t {
 	std::vector <size_t> bs;
     std::vector <size_t> cratios;
 	string wname;
+	int deflate;
+	int keepbits;
+	std::vector <string> wnames;
+	double errbound;
+	OptionParser::Boolean_T relerr;
 	string xtype;
 	string xcoords;
 	string ycoords;
@@ -58,6 +63,30 @@ OptionParser::OptDescRec_T	set_opts[] = {
 		"bior1.5, bior2.2, bior2.4 ,bior2.6, bior2.8, bior3.1, bior3.3, "
 		"bior3.5, bior3.7, bior3.9, bior4.4"
 	},
+	{
+		"deflate", 1, "0", "Entropy code the wavelet coefficients of "
+		"compressed variables with the given deflate level (1 to 9). "
+		"0 => no entropy coding"
+	},
+	{
+		"keepbits", 1, "0", "Number of mantissa bits retained in entropy "
+		"coded wavelet coefficients. 0 => retain all bits"
+	},
+	{
+		"wnames", 1, "", "Colon delimited list of candidate wavelets, in "
+		"addition to wname, from which the wavelet of each block of "
+		"compressed variables is selected (e.g. bior3.3:bior1.1). "
+		"Default is to use wname for all blocks"
+	},
+	{
+		"errbound", 1, "0", "Bound the maximum pointwise error of each "
+		"block of compressed variables at the finest level-of-detail. "
+		"0 => no error bound"
+	},
+	{
+		"relerr", 0, "", "The error bound is relative to the range of "
+		"data values within each block"
+	},
 	{
 		"xtype", 1,"float", "External data type representation. "
 		"Valid values are uint8 int8 int16 int32 int64 float double"
@@ -144,6 +173,11 @@ OptionParser::Option_T	get_options[] = {
 	{"bs", Wasp::CvtToSize_tVec, &opt.bs, sizeof(opt.bs)},
 	{"cratios", Wasp::CvtToSize_tVec, &opt.cratios, sizeof(opt.cratios)},
 	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"deflate", Wasp::CvtToInt, &opt.deflate, sizeof(opt.deflate)},
+	{"keepbits", Wasp::CvtToInt, &opt.keepbits, sizeof(opt.keepbits)},
+	{"wnames", Wasp::CvtToStrVec, &opt.wnames, sizeof(opt.wnames)},
+	{"errbound", Wasp::CvtToDouble, &opt.errbound, sizeof(opt.errbound)},
+	{"relerr", Wasp::CvtToBoolean, &opt.relerr, sizeof(opt.relerr)},
 	{"xtype", Wasp::CvtToCPPStr, &opt.xtype, sizeof(opt.xtype)},
 	{"xcoords", Wasp::CvtToCPPStr, &opt.xcoords, sizeof(opt.xcoords)},
 	{"ycoords", Wasp::CvtToCPPStr, &opt.ycoords, sizeof(opt.ycoords)},
@@ -339,6 +373,15 @@ int	main(int argc, char **argv) {
 	);
 	if (rc<0) exit(1);
 
+	rc = vdc.SetEntropyCode(opt.deflate, opt.keepbits);
+	if (rc<0) exit(1);
+
+	rc = vdc.SetAdaptiveWavelets(opt.wnames);
+	if (rc<0) exit(1);
+
+	rc = vdc.SetErrorBound(opt.errbound, opt.relerr);
+	if (rc<0) exit(1);
+
 	vector <float> xcoords, ycoords, zcoords, tcoords;
 	if (! opt.xcoords.empty()) {
 		rc = read_float_vec(opt.xcoords, opt.dim.nx, xcoords);
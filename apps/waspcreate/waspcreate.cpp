@@ -132,8 +132,13 @@ int	main(int argc, char **argv) {
     }
 	
 
+	// Integer wavelets require the netCDF-4 format
+	//
+	int cmode = opt.wname.compare(0, 3, "int") == 0 ? 
+		NC_NETCDF4 : NC_64BIT_OFFSET;
+
 	int rc = wasp.Create(
-		opt.ofile, NC_64BIT_OFFSET, 0, chunksize, cratios3D.size()
+		opt.ofile, cmode, 0, chunksize, cratios3D.size()
 	);
 	if (rc<0) exit(1);
 
@@ -18,6 +18,11 @@ struct opt_t {
 	std::vector <size_t> bs;
     std::vector <size_t> cratios;
 	string wname;
+	int deflate;
+	int keepbits;
+	std::vector <string> wnames;
+	double errbound;
+	OptionParser::Boolean_T relerr;
 	int nthreads;
     std::vector <string> vars;
 	OptionParser::Boolean_T	force;
@@ -40,6 +45,30 @@ OptionParser::OptDescRec_T	set_opts[] = {
 		"bior1.5, bior2.2, bior2.4 ,bior2.6, bior2.8, bior3.1, bior3.3, "
 		"bior3.5, bior3.7, bior3.9, bior4.4"
 	},
+	{
+		"deflate", 1, "0", "Entropy code the wavelet coefficients of "
+		"compressed variables with the given deflate level (1 to 9). "
+		"0 => no entropy coding"
+	},
+	{
+		"keepbits", 1, "0", "Number of mantissa bits retained in entropy "
+		"coded wavelet coefficients. 0 => retain all bits"
+	},
+	{
+		"wnames", 1, "", "Colon delimited list of candidate wavelets, in "
+		"addition to wname, from which the wavelet of each block of "
+		"compressed variables is selected (e.g. bior3.3:bior1.1). "
+		"Default is to use wname for all blocks"
+	},
+	{
+		"errbound", 1, "0", "Bound the maximum pointwise error of each "
+		"block of compressed variables at the finest level-of-detail. "
+		"0 => no error bound"
+	},
+	{
+		"relerr", 0, "", "The error bound is relative to the range of "
+		"data values within each block"
+	},
 	{
 		"nthreads",    1,  "0",    "Specify number of execution threads "
 		"0 => use number of cores"
@@ -62,6 +91,11 @@ OptionParser::Option_T	get_options[] = {
 	{"bs", Wasp::CvtToSize_tVec, &opt.bs, sizeof(opt.bs)},
 	{"cratios", Wasp::CvtToSize_tVec, &opt.cratios, sizeof(opt.cratios)},
 	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"deflate", Wasp::CvtToInt, &opt.deflate, sizeof(opt.deflate)},
+	{"keepbits", Wasp::CvtToInt, &opt.keepbits, sizeof(opt.keepbits)},
+	{"wnames", Wasp::CvtToStrVec, &opt.wnames, sizeof(opt.wnames)},
+	{"errbound", Wasp::CvtToDouble, &opt.errbound, sizeof(opt.errbound)},
+	{"relerr", Wasp::CvtToBoolean, &opt.relerr, sizeof(opt.relerr)},
 	{"nthreads", Wasp::CvtToInt, &opt.nthreads, sizeof(opt.nthreads)},
 	{"vars", Wasp::CvtToStrVec, &opt.vars, sizeof(opt.vars)},
 	{"force", Wasp::CvtToBoolean, &opt.force, sizeof(opt.force)},
@@ -136,6 +170,15 @@ int	main(int argc, char **argv) {
 	);
 	if (rc<0) exit(1);
 
+	rc = vdc.SetEntropyCode(opt.deflate, opt.keepbits);
+	if (rc<0) exit(1);
+
+	rc = vdc.SetAdaptiveWavelets(opt.wnames);
+	if (rc<0) exit(1);
+
+	rc = vdc.SetErrorBound(opt.errbound, opt.relerr);
+	if (rc<0) exit(1);
+
 	DCWRF	dcwrf;
 	rc = dcwrf.Initialize(wrffiles, vector <string> ());
 	if (rc<0) {
@@ -5,6 +5,9 @@
 #ifndef	_BlkMemMgr_h_
 #define	_BlkMemMgr_h_
 
+#include <map>
+#include <unordered_map>
+#include <mutex>
 #include <vapor/MyBase.h>
 
 namespace VAPoR {
@@ -19,6 +22,20 @@ namespace VAPoR {
 //! A block-based memory allocator. Allocates contiguous runs of
 //! memory blocks from a memory pool of user defined size.
 //!
+//! Free runs are indexed both by size and by address. Allocation
+//! is best-fit: the smallest free run that can satisfy a request is
+//! split, and freed runs are immediately coalesced with free neighbors.
+//! The block size is the allocation granularity, and can be small (a
+//! few KB) so that requests of widely varying size share the pool 
+//! without wasting the tail of a large fixed-size block.
+//!
+//! The pool is shared by all instances, which may be used from 
+//! multiple threads.
+//!
+//! On Linux the pool may be backed by huge pages, to reduce TLB misses
+//! when iterating over large grids, and its pages may be spread over
+//! the NUMA nodes of the machine. See SetPoolPolicy().
+//!
 //! N.B. the memory pool is stored in a static class member and
 //! can only be freed by calling RequestMemSize() with a zero value 
 //! after all instances of this class have been destroyed
@@ -71,17 +88,117 @@ public:
 
  static size_t GetBlkSize() {return(_blk_size);}
 
+ //! Page backing for the memory pool
+ //!
+ //! \li \b PAGES_DEFAULT : ordinary heap memory
+ //! \li \b PAGES_TRANSPARENT : anonymous memory advised for 
+ //! transparent huge pages (madvise(MADV_HUGEPAGE))
+ //! \li \b PAGES_EXPLICIT : memory from the reserved huge page pool 
+ //! (mmap(MAP_HUGETLB)). Falls back to PAGES_TRANSPARENT if no huge
+ //! pages are available.
+ //
+ enum PagePolicy {PAGES_DEFAULT, PAGES_TRANSPARENT, PAGES_EXPLICIT};
+
+ //! Placement of the memory pool on NUMA nodes
+ //!
+ //! \li \b NUMA_DEFAULT : pages are placed on the node of the thread
+ //! that first touches them
+ //! \li \b NUMA_INTERLEAVE : pages are interleaved round-robin over
+ //! all nodes, so that threads running on every node (e.g. threaded
+ //! decompression) see the same average memory bandwidth
+ //! \li \b NUMA_BIND : each region of the pool is bound to a single 
+ //! node, successive regions going to successive nodes
+ //
+ enum NumaPolicy {NUMA_DEFAULT, NUMA_INTERLEAVE, NUMA_BIND};
+
+ //! Set the page and NUMA policies used for the memory pool
+ //!
+ //! As with RequestMemSize(), the policies take effect when the 
+ //! static memory pool is next re-initialized. Policies that are not 
+ //! supported on the platform are ignored.
+ //
+ static void SetPoolPolicy(PagePolicy pages, NumaPolicy numa);
+
+ //! Parse a page policy name (default, transparent, or explicit)
+ //!
+ //! \retval bool False if \p name is not a known policy
+ //
+ static bool ParsePagePolicy(string name, PagePolicy &policy);
+
+ //! Parse a NUMA policy name (default, interleave, or bind)
+ //!
+ //! \retval bool False if \p name is not a known policy
+ //
+ static bool ParseNumaPolicy(string name, NumaPolicy &policy);
+
+ //! Memory pool occupancy and fragmentation counters
+ //!
+ //! All sizes are in blocks.
+ //
+ typedef struct {
+	size_t pool_blks;		// total blocks allocated for the pool
+	size_t max_blks;		// maximum blocks the pool may grow to
+	size_t used_blks;		// blocks currently handed out by Alloc()
+	size_t free_blks;		// blocks in the pool not in use
+	size_t largest_free_run;	// longest contiguous run of free blocks
+	size_t num_free_runs;	// number of distinct free runs
+	size_t num_allocs;	// number of live allocations
+	size_t num_alloc_calls;	// cumulative calls to Alloc()
+	size_t num_alloc_failures;	// cumulative failed Alloc() calls
+	size_t huge_page_blks;	// blocks in regions backed by huge pages
+	int numa_nodes;		// nodes the pool is placed on by policy, or 0
+
+	//! Fraction of the pool in use
+	//
+	double Occupancy() const {
+		return(pool_blks ? (double) used_blks / (double) pool_blks : 0.0);
+	}
+
+	//! External fragmentation: 1 - (largest free run / total free).
+	//! Zero when all free space is contiguous.
+	//
+	double Fragmentation() const {
+		return(free_blks ? 
+			1.0 - ((double) largest_free_run / (double) free_blks) : 0.0
+		);
+	}
+ } Stats;
+
+ static void GetStats(Stats &stats);
+
 private:
  typedef struct {
-	size_t _nfree;	// number of contiguous free blocks
-	size_t _nused;	// number of contiguous used blocks
-	void *_blk;		// pointer to first free/used block
- } _mem_allocation_t; 
+	int _region;	// index of pool region containing the run
+	size_t _nblks;	// length of run in blocks
+ } _mem_run_t; 
  
- static vector < vector <_mem_allocation_t > > _mem_regions;
+ // Free runs, keyed by start address and by length (best fit lookup)
+ //
+ static std::map <unsigned char *, _mem_run_t> _free_by_addr;
+ static std::multimap <size_t, unsigned char *> _free_by_size;
+
+ // Runs handed out by Alloc(), keyed by start address
+ //
+ static std::unordered_map <void *, _mem_run_t> _used;
+
  static vector <size_t>	_mem_region_sizes;	// size of mem in blocks
  static vector <unsigned char *> _blks;	// memory pool
 
+ // How each pool region was allocated
+ //
+ typedef struct {
+	size_t _nbytes;	// size of allocation
+	bool _mapped;	// allocated with mmap(), else new[]
+	bool _huge;		// backed by huge pages
+ } _region_info_t;
+ static vector <_region_info_t> _region_info;
+
+ static PagePolicy _page_policy_req;
+ static NumaPolicy _numa_policy_req;
+ static PagePolicy _page_policy;
+ static NumaPolicy _numa_policy;
+ static int _numa_nodes;
+
  static size_t	_mem_size_max_req;	// max requested size of mem in blocks
  static bool	_page_aligned_req;	// requested page align memory 
  static size_t	_blk_size_req;	// requested size of block in bytes
@@ -92,7 +209,20 @@ private:
 
  static int _ref_count;	// # instances of object.
 
+ static size_t _num_alloc_calls;
+ static size_t _num_alloc_failures;
+
+ static std::mutex _mutex;	// guards all of the above
+
  static int	_Reinit(size_t n);
+ static unsigned char *_alloc_region(size_t nbytes, _region_info_t &info);
+ static void _free_region(unsigned char *ptr, const _region_info_t &info);
+ static void _place_region(unsigned char *ptr, size_t nbytes, int region);
+ static void _insert_free(unsigned char *ptr, const _mem_run_t &run);
+ static void _remove_free(
+	std::map <unsigned char *, _mem_run_t>::iterator itr
+ );
+ static void _free_all();
 
 };
 };
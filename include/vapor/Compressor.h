@@ -54,6 +54,25 @@ public:
 	const string &wname
  );
 
+ //! Construct a compressor with a limited number of transformation levels
+ //!
+ //! Identical to Compressor(std::vector <size_t> dims, const string &wname)
+ //! except that no more than \p maxlevels forward transformations are
+ //! applied. Limiting the number of levels permits wavelets with 
+ //! different filter lengths to produce multiresolution hierarchies of
+ //! the same depth.
+ //!
+ //! \param[in] maxlevels The maximum number of transformation levels. 
+ //! If negative, or larger than the number of levels supported by the
+ //! wavelet and \p dims, the supported number of levels is used.
+ //!
+ //! \sa GetNumLevels()
+ //
+ Compressor(
+	std::vector <size_t> dims,
+	const string &wname, int maxlevels
+ );
+
  virtual ~Compressor();
 
  //! Compress an array
@@ -278,7 +297,7 @@ public:
  //!
  size_t GetSigMapSize(size_t num_entries) const { 
 	std::vector <size_t> dims; dims.push_back(GetNumWaveCoeffs());
-	return(SignificanceMap::GetMapSize(dims, num_entries));
+	return(SignificanceMap::GetMapSize(dims, num_entries, _sigmap_version));
   };
 
 
@@ -387,6 +406,65 @@ public:
  //!
  double &Epsilon() {return (_epsilon); };
 
+ //! Set or get the error bound attribute
+ //!
+ //! When set, Compress() and Decompose() retain only as many wavelet
+ //! coefficients as are needed to reconstruct the array to within a
+ //! maximum pointwise error of ErrorBound(). The requested number of
+ //! coefficients (the length of the destination array, or the length of
+ //! the final partition for Decompose()) becomes an upper bound. 
+ //! The number actually retained is given by the 
+ //! SignificanceMap::GetNumSignificant() method of the (final)
+ //! significance map. If the bound can't be met with the requested
+ //! number of coefficients all are retained. By default the attribute
+ //! is disabled.
+ //!
+ //! \note Coefficient counts are found by bisection, reconstructing 
+ //! the array once for each candidate, which makes compression 
+ //! substantially more expensive. Decompression cost is unaffected.
+ //!
+ //! \sa ErrorBound(), ErrorBoundRelativeOnOff(), GetError()
+ //!
+ bool &ErrorBoundOnOff() {return (_errbound_flag); };
+
+ //! Set or get the error bound value
+ //!
+ //! \sa ErrorBoundOnOff(), ErrorBoundRelativeOnOff()
+ //!
+ double &ErrorBound() {return (_errbound); };
+
+ //! Set or get the relative error bound attribute
+ //!
+ //! When set, ErrorBound() is interpreted relative to the range 
+ //! (maximum minus minimum) of the array being compressed. Otherwise it
+ //! is an absolute error. By default the attribute is disabled.
+ //!
+ //! \sa ErrorBoundOnOff(), ErrorBound()
+ //!
+ bool &ErrorBoundRelativeOnOff() {return (_errbound_rel_flag); };
+
+ //! Return the achieved error
+ //!
+ //! Returns the maximum absolute pointwise error of the reconstruction
+ //! of the array most recently compressed with Compress() or
+ //! Decompose() while ErrorBoundOnOff() was set.
+ //!
+ //! \sa ErrorBoundOnOff()
+ //!
+ double GetError() const {return (_error); };
+
+ //! Set or get the significance map encoding version
+ //!
+ //! This attribute selects the encoding version of significance maps
+ //! configured by Compress() or Decompose(), and the map sizes reported
+ //! by GetSigMapSize(). The default is the latest version supported
+ //! by SignificanceMap. Older versions may be selected for 
+ //! compatibility with previously encoded data.
+ //!
+ //! \sa SignificanceMap::SetVersion(), GetSigMapSize()
+ //!
+ int &SigMapVersion() {return (_sigmap_version); };
+
  static bool CompressionInfo(
 	vector <size_t> dims, const string wavename,
 	bool keepapp, size_t &nlevels, size_t &maxcratio
@@ -416,8 +494,14 @@ private:
 	double _clamp_min;
 	double _clamp_max;
 	double _epsilon;
-
-	void _Compressor(std::vector <size_t> dims);
+	int _sigmap_version;	// significance map encoding version
+	bool _czero;	// true if all of _C is known to be zero
+	bool _errbound_flag;
+	bool _errbound_rel_flag;
+	double _errbound;
+	double _error;	// achieved error of last error bounded compression
+
+	void _Compressor(std::vector <size_t> dims, int maxlevels = -1);
 
 };
 
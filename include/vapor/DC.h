@@ -1967,6 +1967,75 @@ public:
 	return(readRegionBlock(fd, min, max, region));
  }
 
+ //! Return the address of the currently opened variable in a memory 
+ //! mapped view of its file
+ //!
+ //! If the data for the currently opened variable are stored 
+ //! uncompressed and contiguously on disk this method sets \p data
+ //! to the address of a read-only, memory mapped copy of all of the 
+ //! variable's spatial values at the opened time step. 
+ //! The address remains valid 
+ //! until the variable is closed with CloseVariable().
+ //!
+ //! The values are stored in blocks of dimension \p bs. The blocks,
+ //! and the values within each block, are ordered as by Read(). Blocks
+ //! on the boundary are padded to a full block. If all elements of 
+ //! \p bs are one the values are simply ordered as by Read().
+ //!
+ //! Mapped data must not be used if the variable has missing values 
+ //! that are stored in a separate mask. Such variables are not mapped.
+ //!
+ //! \param[in] fd A valid file descriptor returned by OpenVariableRead()
+ //! \param[out] data Address of the first value 
+ //! \param[out] swap If true, the bytes of each value are stored in 
+ //! reverse order from the native representation and must be swapped.
+ //! \param[out] bs Block dimensions of the mapped values, ordered 
+ //! like the variable's spatial dimensions
+ //!
+ //! \retval status Returns false if the variable can not be mapped.
+ //! No error is reported.
+ //!
+ //! \sa OpenVariableRead(), ReadRegion()
+ //
+ virtual bool MapVariable(
+	int fd, const float *&data, bool &swap, std::vector <size_t> &bs
+ ) {
+	return(mapVariable(fd, data, swap, bs));
+ }
+
+ //! Read the pre-computed per-block summaries of the currently opened 
+ //! variable
+ //!
+ //! If the data collection records a summary for each storage 
+ //! block of a variable this method returns, for each block, 
+ //! the range of the valid data values within the block, and whether 
+ //! any of the block's values are missing. The blocks are those
+ //! described by the block size returned by GetDimLensAtLevel(), and
+ //! are the same for every refinement level. No variable data
+ //! are read.
+ //!
+ //! \param[in] fd A valid file descriptor returned by OpenVariableRead()
+ //! \param[out] bdims Ordered list of the variable's dimensions in 
+ //! blocks. Empty if no summaries are available for the variable.
+ //! \param[out] mins Minimum valid data value of each block. Blocks
+ //! are ordered with the first dimension varying fastest.
+ //! \param[out] maxs Maximum valid data value of each block
+ //! \param[out] missing For each block, 0 if the block has no missing
+ //! values, 1 if some values are missing, and 2 if all values are missing.
+ //!
+ //! \retval status A negative int is returned on failure. The absence
+ //! of summaries is not an error.
+ //!
+ //! \sa OpenVariableRead(), GetDimLensAtLevel()
+ //
+ virtual int ReadBlockSummaries(
+	int fd, vector <size_t> &bdims, 
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+ ) {
+	return(readBlockSummaries(fd, bdims, mins, maxs, missing));
+ }
+
  //! Read an entire variable in one call
  //!
  //! This method reads and entire variable (all time steps, all grid points)
@@ -2572,6 +2641,31 @@ protected:
     const vector <size_t> &min, const vector <size_t> &max, int *region
  ) = 0;
 
+ //! \copydoc MapVariable()
+ //
+ virtual bool mapVariable(
+	int fd, const float *&data, bool &swap, std::vector <size_t> &bs
+ ) {
+	data = NULL;
+	swap = false;
+	bs.clear();
+	return(false);
+ }
+
+ //! \copydoc ReadBlockSummaries()
+ //
+ virtual int readBlockSummaries(
+	int fd, vector <size_t> &bdims, 
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+ ) {
+	bdims.clear();
+	mins.clear();
+	maxs.clear();
+	missing.clear();
+	return(0);
+ }
+
  //! \copydoc VariableExists()
  //
  virtual bool variableExists(
@@ -1,6 +1,15 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <map>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include "vapor/VAssert.h"
 #include <vapor/BlkMemMgr.h>
 #include <vapor/DC.h>
@@ -139,6 +148,41 @@ public:
  //! a list of input data files.
  //!
  //! \param[in] files A list of file paths
+ //!
+ //! \param[in] options A list of options. In addition to any options
+ //! understood by the underlying DC, the following are recognized:
+ //! \li \b -proj4 \a string : map projection to use
+ //! \li \b -project_to_pcs : transform geographic horizontal coordinates
+ //! \li \b -vertical_xform : transform vertical coordinates to meters
+ //! \li \b -cache_policy \a lru|gdsf|cost : cache eviction policy. 
+ //! \b lru (the default) evicts the least recently used region. 
+ //! \b gdsf is Greedy-Dual-Size-Frequency, which prefers evicting 
+ //! large, infrequently used regions. \b cost is GDSF weighted by the 
+ //! measured time to produce each region, so that expensive 
+ //! (e.g. decompressed or derived) regions outlive cheap ones.
+ //! \li \b -info_cache \a path : file used to persist data ranges,
+ //! variable extents, and coordinate bounds across sessions. The 
+ //! contents are discarded if any of the data files have been modified
+ //! (size or modification time). Values for variables added with 
+ //! AddDerivedVar() are not persisted.
+ //! \li \b -pool_pages \a default|transparent|explicit : back the
+ //! memory cache with ordinary pages, transparent huge pages, or 
+ //! reserved (hugetlbfs) huge pages. Huge pages reduce TLB misses
+ //! when iterating over large grids. Linux only.
+ //! \li \b -pool_numa \a default|interleave|bind : placement of the
+ //! memory cache on NUMA nodes. \b interleave spreads its pages over 
+ //! all nodes, so that threads on every socket, such as the threads
+ //! decompressing data, share the memory bandwidth of all nodes.
+ //! \b bind places each region of the cache on a single node, in turn.
+ //! The default is first touch placement. Linux only.
+ //! \li \b -trace \a path : log region reads, evictions, variable
+ //! opens, and derived variable evaluations to \a path in the Chrome
+ //! trace event format (JSON), for viewing with chrome://tracing or 
+ //! Perfetto.
+ //!
+ //! The pool options take effect when the memory cache is created,
+ //! which happens when the first variable is read, and are ignored if
+ //! another DataMgr already shares the cache (see BlkMemMgr).
  //! 
  //! \retval status A negative int is returned on failure and an error
  //! message will be logged with MyBase::SetErrMsg()
@@ -417,6 +461,14 @@ std::vector <size_t> GetCRatios(string varname) const;
  //! it is the caller's responsiblity to delete the returned object
  //! when it is no longer in use.
  //!
+ //! \note GetVariable() may be called concurrently from multiple threads.
+ //! Cache hits are served while other threads are reading, and 
+ //! concurrent requests for the same region wait on a single read. 
+ //! Data not locked with \p lock may be evicted by another thread's 
+ //! request at any time, so concurrent callers should lock the 
+ //! returned grid and release it with UnlockGrid(). Initialize() must
+ //! not be called while other threads are using the DataMgr.
+ //!
  VAPoR::Grid *GetVariable (
 	size_t ts, string varname, int level, int lod, 
 	std::vector <double> min, std::vector <double> max, bool lock=false
@@ -427,6 +479,158 @@ std::vector <size_t> GetCRatios(string varname) const;
 	std::vector <size_t> min, std::vector <size_t> max, bool lock=false
  );
 
+ //! Read a variable into the cache in the background
+ //!
+ //! This method queues a request to read the variable \p varname
+ //! into the memory cache and returns immediately. The request
+ //! is serviced by a background thread, so that a subsequent call to
+ //! GetVariable() with the same arguments is satisfied from the cache.
+ //! The typical use is to request time steps ahead of the current
+ //! time step during animation.
+ //!
+ //! Prefetching is opportunistic. It never evicts locked regions,
+ //! regions referenced since the previous call to Prefetch(), or 
+ //! other prefetched regions that haven't been used yet. If the request
+ //! doesn't fit in the cache under these constraints it is
+ //! discarded. Errors are not reported.
+ //!
+ //! Pending requests for \p varname are discarded if they are no 
+ //! longer useful: if their \p level, \p lod, or region differ from 
+ //! the new request, or if they lie on the opposite side (in time) of 
+ //! the most recent time step returned by GetVariable() for 
+ //! \p varname (i.e. the direction of animation was reversed).
+ //!
+ //! \param[in] min Minimum extents of the region of interest, in user
+ //! coordinates. If empty the entire domain is read.
+ //! \param[in] max Maximum extents of the region of interest, in user
+ //! coordinates. If empty the entire domain is read.
+ //!
+ //! \sa GetVariable(), CancelPrefetch()
+ //
+ void Prefetch(
+	size_t ts, string varname, int level, int lod,
+	std::vector <double> min, std::vector <double> max
+ );
+
+ void Prefetch(size_t ts, string varname, int level, int lod) {
+	Prefetch(ts, varname, level, lod, vector <double> (), vector <double> ());
+ }
+
+ //! Discard all pending prefetch requests
+ //!
+ //! \sa Prefetch()
+ //
+ void CancelPrefetch();
+
+ //! Callback used by GetVariableProgressive() to deliver refinements
+ //!
+ //! \param[in] grid A refined grid. The callee takes ownership of
+ //! \p grid, and must release it with UnlockGrid() before deleting it
+ //! if it was requested with \p lock set.
+ //! \param[in] level The refinement level of \p grid
+ //! \param[in] lod The level-of-detail of \p grid
+ //
+ typedef std::function <void (VAPoR::Grid *grid, int level, int lod)>
+	RefineCallback;
+
+ //! Read a variable hyperslab, refining it progressively
+ //!
+ //! This method is a non-blocking alternative to GetVariable() for
+ //! interactive use. It reads and returns the coarsest available
+ //! approximation of the variable (refinement level 0 and lod 0),
+ //! which is typically orders of magnitude cheaper to read than the
+ //! full resolution data. It then queues the intermediate and the 
+ //! requested \p level and \p lod for reading by a background thread. 
+ //! Each time a finer grid is ready it is passed to \p callback, 
+ //! from the background thread, in order of increasing resolution. 
+ //! The final call delivers the grid at \p level and \p lod.
+ //! Intermediate grids remain in the cache, so returning to a 
+ //! region that was viewed before refines quickly.
+ //!
+ //! A subsequent call for the same \p varname supersedes the
+ //! refinements of earlier calls: they are discarded, and any grid
+ //! being read when the new call is made is deleted rather than 
+ //! delivered. Refinements take priority over Prefetch() requests.
+ //! Refinement errors are not reported; the remaining refinements
+ //! for the request are discarded.
+ //!
+ //! \param[in] min Minimum extents of the region of interest, in user
+ //! coordinates. If empty the entire domain is read.
+ //! \param[in] max Maximum extents of the region of interest, in user
+ //! coordinates. If empty the entire domain is read.
+ //! \param[in] callback Receives the refined grids. May be empty, in
+ //! which case refinements are only read into the cache.
+ //!
+ //! \retval grid The coarsest approximation, or NULL on failure. No
+ //! refinements are queued if NULL is returned.
+ //!
+ //! \sa GetVariable(), CancelRefinement()
+ //
+ VAPoR::Grid *GetVariableProgressive(
+	size_t ts, string varname, int level, int lod,
+	std::vector <double> min, std::vector <double> max,
+	RefineCallback callback, bool lock=false
+ );
+
+ //! Discard all pending refinements
+ //!
+ //! A grid being read when this method is called is deleted rather
+ //! than delivered.
+ //!
+ //! \sa GetVariableProgressive()
+ //
+ void CancelRefinement();
+
+ //! Region cache and I/O counters
+ //!
+ //! Times are wall clock seconds.
+ //
+ typedef struct {
+	size_t hits;		// regions found in the cache
+	size_t superset_hits;	// regions copied from a larger cached region
+	size_t misses;		// regions read from the data collection
+	size_t pending_waits;	// hits that waited for another thread's read
+	size_t evictions;	// regions evicted to make room for others
+	size_t bytes_evicted;	// size of evicted regions
+	size_t bytes_read;	// size of regions read from the data collection
+	double read_time;	// time spent reading (and decompressing) regions
+	double lock_wait_time;	// time spent waiting for other threads' reads
+	size_t opens;		// variables opened for reading
+	double open_time;	// time spent opening variables
+	size_t derived_reads;	// reads of derived variables
+	double derived_time;	// time spent evaluating derived variables
+ } CacheCounters;
+
+ //! Statistics returned by GetCacheStats()
+ //!
+ //! Counters are broken down by variable and by time step. Evictions
+ //! are attributed to the variable and time step of the evicted region.
+ //
+ class CacheStats {
+ public:
+  CacheCounters total;
+  std::map <string, CacheCounters> variables;
+  std::map <size_t, CacheCounters> timesteps;
+  size_t num_regions;		// regions currently in the cache
+  size_t bytes_cached;		// total size of cached regions
+  BlkMemMgr::Stats pool;	// memory pool occupancy
+ };
+
+ //! Return region cache statistics
+ //!
+ //! Counters accumulate from the construction of the DataMgr, or the
+ //! last call to ResetCacheStats(). They are not reset by Initialize().
+ //!
+ //! \sa ResetCacheStats()
+ //
+ void GetCacheStats(CacheStats &stats) const;
+
+ //! Zero all region cache counters
+ //!
+ //! \sa GetCacheStats()
+ //
+ void ResetCacheStats();
+
  //! Compute the coordinate extents of a variable
  //!
  //! This method finds the spatial domain extents of a variable
@@ -447,6 +651,14 @@ std::vector <size_t> GetCRatios(string varname) const;
  //!
  //! This method finds the minimum and maximum value of a variable
  //!
+ //! If \p level and \p lod both select the native data (the finest 
+ //! refinement level and the highest level-of-detail), and per-block 
+ //! summaries are available for \p varname (see GetBlockSummaries()), 
+ //! the range is computed from the summaries without reading the 
+ //! variable. Otherwise the range is found from the data returned by
+ //! GetVariable(), as by the region-of-interest version of this method
+ //! with the variable's full extents.
+ //!
  //! \param[out] range A two element vector containing the minimum and maximum
  //! value, respectively, for the variable \p varname at the specified
  //! time step, lod, etc.
@@ -456,6 +668,44 @@ std::vector <size_t> GetCRatios(string varname) const;
     int lod, std::vector <double> &range
  ) ;
 
+ //! Return pre-computed per-block summaries of a variable
+ //!
+ //! If the data collection stores a summary for each block of
+ //! the variable \p varname this method returns, for every block, 
+ //! the range of the valid data values within the block and
+ //! whether any of the block's values are missing. Only metadata are 
+ //! read, and the results are cached. Renderers may use the summaries
+ //! to cull blocks (e.g. blocks that can not contain an iso-value)
+ //! without reading or decompressing them.
+ //!
+ //! Blocks are the native storage blocks given by GetDimLensAtLevel(),
+ //! and there are the same number of blocks at every refinement level in
+ //! the variable's multi-resolution hierarchy. Summaries are computed
+ //! from the native resolution data.
+ //!
+ //! \param[in] ts Time step
+ //! \param[in] varname Variable name
+ //! \param[out] bdims Ordered list of the dimensions of the variable
+ //! in blocks. Empty if no summaries are available, e.g. for derived 
+ //! variables or data collections written without summaries.
+ //! \param[out] mins Minimum valid value of each block. Blocks are
+ //! ordered with the first dimension of \p bdims varying fastest.
+ //! \param[out] maxs Maximum valid value of each block
+ //! \param[out] missing For each block, 0 if the block has no missing
+ //! values, 1 if some values are missing, and 2 if all values are missing,
+ //! in which case the block's \p mins and \p maxs are undefined.
+ //!
+ //! \retval status A negative int is returned on failure. The absence of
+ //! summaries is not an error.
+ //!
+ //! \sa GetDataRange(), DC::ReadBlockSummaries()
+ //
+ int GetBlockSummaries(
+	size_t ts, string varname, std::vector <size_t> &bdims,
+	std::vector <double> &mins, std::vector <double> &maxs,
+	std::vector <unsigned char> &missing
+ );
+
  //! Compute min and max value of a variable within a specified ROI
  //!
  //! This method finds the minimum and maximum value of a variable within
@@ -463,6 +713,9 @@ std::vector <size_t> GetCRatios(string varname) const;
  //! results returned by this method are equivalent to calling the 
  //! Grid::GetRange() method on a grid returned by DataMgr::GetVariable
  //! using the same arguments provided here.
+ //!
+ //! Per-block summaries are not used, even at the native resolution, 
+ //! because the region need not be aligned to block boundaries.
  //
  int GetDataRange(
     size_t ts, string varname, int level, int lod, 
@@ -646,6 +899,11 @@ std::vector <size_t> GetCRatios(string varname) const;
 	std::ostream &o, const BlkExts &b
   );
 
+  // Flatten to and restore from a vector of doubles
+  //
+  bool Encode(std::vector <double> &v) const;
+  bool Decode(const std::vector <double> &v);
+
  private:
 
 	std::vector <size_t> _bmin;
@@ -653,81 +911,341 @@ std::vector <size_t> GetCRatios(string varname) const;
 	std::vector < std::vector < double > > _mins;
 	std::vector < std::vector < double > > _maxs;
  };
-private:
 
- //
- // Cache for various metadata attributes 
- //
- template <typename C>
- class VarInfoCache  {
+ //! \class RegionCache
+ //! \brief Index of the memory regions held in the DataMgr cache
+ //!
+ //! Regions are stored on a list ordered from least recently used (front)
+ //! to most recently used (back). A hash table keyed on a compact
+ //! (time step, variable id, level, lod, bmin, bmax) tuple gives constant
+ //! time lookup, and promoting a region to the most recently used
+ //! position is a constant time list splice. Iterators remain valid
+ //! until the region they reference is erased.
+ //!
+ //! The order in which regions are chosen for eviction is determined
+ //! by the eviction policy. For the Greedy-Dual-Size-Frequency
+ //! policies each region is assigned a priority
+ //! H = L + hits * cost / size, where \a L is an aging term equal to 
+ //! the priority of the last evicted region, and the region 
+ //! with the lowest priority is evicted first. For GDSF \a cost is 1,
+ //! for COST it is the measured time to produce the region.
+ //!
+ class RegionCache {
  public:
+  enum EvictionPolicy {LRU, GDSF, COST};
 
-	//
-	//
-	void Set(
-		size_t ts, std::vector <string> varnames, int level, int lod, string key,
-		const std::vector <C> &values
-	);
+  typedef struct {
+	size_t ts;
+	string varname;
+	int level;
+	int lod;
+	std::vector <size_t> bmin;
+	std::vector <size_t> bmax;
+	int lock_counter;
+	void *blks;
+	size_t size;		// size of region in bytes
+	double cost;		// time in seconds to produce region
+	size_t hits;		// number of references
+	double priority;	// eviction priority. Lowest evicted first
+	size_t last_use;	// value of Clock() when last inserted or touched
+	bool prefetched;	// read by Prefetch() and not yet referenced
+  } region_t;
+
+  typedef std::list <region_t>::iterator iterator;
+
+  RegionCache() : _policy(LRU), _inflation(0.0), _clock(0) {}
+
+  //! Set the eviction policy. Priorities of cached regions are recomputed
+  //
+  void SetEvictionPolicy(EvictionPolicy policy);
+
+  EvictionPolicy GetEvictionPolicy() const { return(_policy); }
+
+  //! Parse a policy name (lru, gdsf, or cost)
+  //!
+  //! \retval bool False if \p name is not a known policy
+  //
+  static bool ParseEvictionPolicy(string name, EvictionPolicy &policy);
+
+  //! Find a region by its identifying tuple
+  //!
+  //! \retval iterator Returns end() if no matching region exists
+  //
+  iterator Find(
+	size_t ts, const string &varname, int level, int lod,
+	const std::vector <size_t> &bmin, const std::vector <size_t> &bmax
+  );
 
-	void Set(
-		size_t ts, string varname, int level, int lod, string key,
-		const std::vector <C> &values
-	) { 
-		std::vector <string> varnames;
-		varnames.push_back(varname);
-		Set(ts, varnames, level, lod, key, values);
-	}
+  //! Find the smallest region whose block extents contain 
+  //! \p bmin and \p bmax
+  //!
+  //! \retval iterator Returns end() if no region contains the extents
+  //
+  iterator FindContaining(
+	size_t ts, const string &varname, int level, int lod,
+	const std::vector <size_t> &bmin, const std::vector <size_t> &bmax
+  );
 
-	bool Get(
-		size_t ts, std::vector <string> varnames, int level, int lod, string key,
-		std::vector <C> &values
-	) const;
-
-	bool Get(
-		size_t ts, string varname, int level, int lod, string key,
-		std::vector <C> &values
-	) const { 
-		std::vector <string> varnames;
-		varnames.push_back(varname);
-		return Get(ts, varnames, level, lod, key, values);
-	}
+  //! Find a region by the address of its memory blocks
+  //!
+  //! \retval iterator Returns end() if no matching region exists
+  //
+  iterator Find(const void *blks);
+
+  //! Make a region the most recently used, and count a reference to it
+  //
+  void Touch(iterator itr);
+
+  //! Record the time in seconds taken to produce a region's contents
+  //
+  void SetCost(iterator itr, double cost);
+
+  //! Return the next region to evict according to the eviction policy.
+  //! Locked regions are never returned. 
+  //!
+  //! \param[in] max_last_use Only regions whose \a last_use is
+  //! less than this value are candidates
+  //! \param[in] skip_prefetched If true, regions marked \a prefetched
+  //! are not candidates
+  //!
+  //! \retval iterator Returns end() if there is no candidate
+  //
+  iterator Victim(
+	size_t max_last_use = (size_t) -1, bool skip_prefetched = false
+  );
 
-	void Purge(
-		size_t ts, std::vector <string> varnames, int level, int lod, string key
-	); 
-	void Purge(
-		size_t ts, string varname, int level, int lod, string key
-	) {
-		std::vector <string> varnames;
-		varnames.push_back(varname);
-		Purge(ts, varnames, level, lod, key);
-	} 
-	void Purge(std::vector <string> varnames); 
-
-	void Clear() {
-		_cache.clear(); 
-	}
+  //! Return a counter that is incremented every time a region is 
+  //! inserted or touched
+  //
+  size_t Clock() const { return(_clock); }
 
-  static string _make_hash(
-	string key, size_t ts, std::vector <string> cvars, int level, int lod
-  );
+  //! Remove a region chosen by Victim(), aging the priority of the
+  //! regions that remain
+  //
+  iterator Evict(iterator itr) {
+	_inflation = itr->priority;
+	return(Erase(itr));
+  }
 
-  void _decode_hash(
-	const string &hash,
-	string &key, size_t &ts, vector <string> &varnames, int &level, int &lod
+  //! Add a region as the most recently used. Any existing region with
+  //! the same identifying tuple is replaced in the index.
+  //
+  iterator Insert(const region_t &region);
+
+  //! Remove a region, returning an iterator to the next region
+  //
+  iterator Erase(iterator itr);
+
+  void Clear();
+
+  iterator begin() { return(_regions.begin()); }
+  iterator end() { return(_regions.end()); }
+  size_t Size() const { return(_regions.size()); }
+
+ private:
+  class region_key_t {
+  public:
+	size_t ts;
+	int varid;
+	int level;
+	int lod;
+	int ndim;
+	size_t bmin[3];
+	size_t bmax[3];
+
+	bool operator==(const region_key_t &rhs) const;
+  };
+
+  class region_key_hash {
+  public:
+	size_t operator()(const region_key_t &key) const;
+  };
+
+  EvictionPolicy _policy;
+  double _inflation;
+  std::atomic <size_t> _clock;
+
+  std::list <region_t> _regions;
+  std::unordered_map <region_key_t, iterator, region_key_hash> _keyIndex;
+
+  // All regions of a (ts, varid, level, lod) tuple, keyed on a 
+  // region_key_t with zero extents
+  //
+  std::unordered_multimap <region_key_t, iterator, region_key_hash> _varIndex;
+  std::unordered_map <const void *, iterator> _blksIndex;
+  std::unordered_map <string, int> _varIds;
+
+  // Regions ordered by eviction priority. Unused for LRU
+  //
+  std::multimap <double, iterator> _priorityIndex;
+
+  static region_key_t _var_key(region_key_t key);
+  double _priority(const region_t &region) const;
+  void _index_priority(iterator itr);
+  void _unindex_priority(iterator itr);
+
+  bool _make_key(
+	size_t ts, const string &varname, int level, int lod,
+	const std::vector <size_t> &bmin, const std::vector <size_t> &bmax,
+	bool intern, region_key_t &key
   );
+ };
+
+ //! \class VarInfoKey
+ //! \brief Identifies an entry in a VarInfoCache
+ //!
+ //! A key is the tuple (key, ts, varnames, level, lod, ext), where
+ //! \a key names the kind of information cached, \a varnames are
+ //! the variables it pertains to, and \a ext holds any additional
+ //! integer qualifiers (e.g. the voxel coordinates of a region of
+ //! interest).
+ //!
+ class VarInfoKey {
+ public:
+  VarInfoKey() : ts(0), level(0), lod(0) {}
+  VarInfoKey(
+	const string &key, size_t ts, const std::vector <string> &varnames,
+	int level, int lod,
+	const std::vector <size_t> &ext = std::vector <size_t> ()
+  ) : key(key), ts(ts), varnames(varnames), level(level), lod(lod),
+	ext(ext) {}
+  VarInfoKey(
+	const string &key, size_t ts, const string &varname,
+	int level, int lod,
+	const std::vector <size_t> &ext = std::vector <size_t> ()
+  ) : key(key), ts(ts), varnames(1, varname), level(level), lod(lod),
+	ext(ext) {}
+
+  bool operator==(const VarInfoKey &rhs) const {
+	return(
+		ts == rhs.ts && level == rhs.level && lod == rhs.lod &&
+		key == rhs.key && varnames == rhs.varnames && ext == rhs.ext
+	);
+  }
+
+  // Text representation used by the persistent info cache
+  //
+  string Encode() const;
+  bool Decode(const string &s);
+
+  string key;
+  size_t ts;
+  std::vector <string> varnames;
+  int level;
+  int lod;
+  std::vector <size_t> ext;
+ };
 
-  private:
+ class VarInfoKeyHash {
+ public:
+  size_t operator()(const VarInfoKey &key) const;
+ };
 
-  std::map <string, std::vector <C> > _cache;
+ //! \class VarInfoCache
+ //! \brief Cache for various metadata attributes
+ //!
+ //! Values are stored in a hash table keyed on a VarInfoKey.
+ //!
+ template <typename C>
+ class VarInfoCache  {
+ public:
+  typedef std::unordered_map <
+	VarInfoKey, std::vector <C>, VarInfoKeyHash
+  > cache_t;
+
+  void Set(const VarInfoKey &key, const std::vector <C> &values) {
+	_cache[key] = values;
+  }
+
+  void Set(
+	size_t ts, const std::vector <string> &varnames, int level, int lod,
+	const string &key, const std::vector <C> &values
+  ) {
+	Set(VarInfoKey(key, ts, varnames, level, lod), values);
+  }
+
+  void Set(
+	size_t ts, const string &varname, int level, int lod,
+	const string &key, const std::vector <C> &values
+  ) {
+	Set(VarInfoKey(key, ts, varname, level, lod), values);
+  }
+
+  bool Get(const VarInfoKey &key, std::vector <C> &values) const {
+	typename cache_t::const_iterator itr = _cache.find(key);
+	if (itr == _cache.end()) {
+		values.clear();
+		return(false);
+	}
+	values = itr->second;
+	return(true);
+  }
+
+  bool Get(
+	size_t ts, const std::vector <string> &varnames, int level, int lod,
+	const string &key, std::vector <C> &values
+  ) const {
+	return Get(VarInfoKey(key, ts, varnames, level, lod), values);
+  }
+
+  bool Get(
+	size_t ts, const string &varname, int level, int lod,
+	const string &key, std::vector <C> &values
+  ) const {
+	return Get(VarInfoKey(key, ts, varname, level, lod), values);
+  }
+
+  void Purge(const VarInfoKey &key) {
+	_cache.erase(key);
+  }
+
+  void Purge(
+	size_t ts, const std::vector <string> &varnames, int level, int lod,
+	const string &key
+  ) {
+	Purge(VarInfoKey(key, ts, varnames, level, lod));
+  }
+
+  void Purge(
+	size_t ts, const string &varname, int level, int lod, const string &key
+  ) {
+	Purge(VarInfoKey(key, ts, varname, level, lod));
+  }
+
+  // Remove all entries pertaining to exactly the variables \p varnames
+  //
+  void Purge(const std::vector <string> &varnames) {
+	typename cache_t::iterator itr = _cache.begin();
+	while (itr != _cache.end()) {
+		if (itr->first.varnames == varnames) itr = _cache.erase(itr);
+		else ++itr;
+	}
+  }
 
+  void Clear() {
+	_cache.clear();
+  }
+
+  // Raw access to the cached entries
+  //
+  const cache_t &GetEntries() const {
+	return(_cache);
+  }
+
+ private:
+  cache_t _cache;
  };
 
+private:
+
+
  mutable std::map <size_t, std::vector<string> > _dataVarNamesCache;
 
  string _format;
  int _nthreads;
  size_t _mem_size;
+ BlkMemMgr::PagePolicy _pagePolicy;
+ BlkMemMgr::NumaPolicy _numaPolicy;
 
  DC *_dc;
  VAPoR::UDUnits _udunits;
@@ -737,25 +1255,96 @@ private:
  bool _doTransformHorizontal;
  bool _doTransformVertical;
  string _openVarName;
+ size_t _openTs;
+ int _openLevel;
+ int _openLod;
 
  std::vector <double> _timeCoordinates;
  string _proj4String;
  string _proj4StringDefault;
  std::vector <size_t> _bs;
 
+ typedef RegionCache::region_t region_t;
+
+ // A recursive mutex whose holds by the calling thread can all be 
+ // given up, and later restored, while the thread blocks on something 
+ // else. Release() may only be called by a thread holding the mutex.
+ //
+ class ReleasableMutex {
+ public:
+  ReleasableMutex() : _depth(0) {}
+  void lock() { _m.lock(); _depth++; }
+  void unlock() { _depth--; _m.unlock(); }
+  size_t Release() {
+	size_t depth = _depth;
+	for (size_t i=0; i<depth; i++) unlock();
+	return(depth);
+  }
+  void Reacquire(size_t depth) {
+	for (size_t i=0; i<depth; i++) lock();
+  }
+ private:
+  std::recursive_mutex _m;
+  size_t _depth;
+ };
+
+ // Serializes access to the cache and other mutable state. It is 
+ // not held while data are read, so cache hits from one thread 
+ // are not held up by another thread's reads.
+ //
+ mutable ReleasableMutex _mutex;
+
+ // Serializes use of the DC and derived variable readers, which are 
+ // not reentrant. Must never be acquired while holding _mutex.
+ //
+ mutable std::recursive_mutex _dcMutex;
+
+ // Regions that have been allocated but are still being read. Threads
+ // that find a pending region in the cache wait for the read to 
+ // finish rather than reading the region again.
+ //
+ std::mutex _pendingMutex;
+ std::condition_variable _pendingCond;
+ std::set <const void *> _pendingRegions;
+
+ bool _is_pending(const void *blks);
+ void _set_pending(const void *blks, bool pending);
+ void _wait_pending(const void *blks);
+
  typedef struct {
 	size_t ts;
 	string varname;
 	int level;
 	int lod;
-	std::vector <size_t> bmin;
-	std::vector <size_t> bmax;
-	int lock_counter;
-	void *blks;
- } region_t;
-
- // a list of all allocated regions
- std::list <region_t> _regionsList;
+	std::vector <double> min;
+	std::vector <double> max;
+	RefineCallback callback;	// refinements only
+	bool lock;		// refinements only
+	size_t generation;	// refinements only
+ } prefetch_t;
+
+ std::mutex _prefetchMutex;	// protects prefetch state below
+ std::condition_variable _prefetchCond;
+ std::deque <prefetch_t> _prefetchQueue;
+ std::deque <prefetch_t> _refineQueue;	// serviced before _prefetchQueue
+ std::map <string, size_t> _refineGeneration;	// latest request per variable
+ std::map <string, size_t> _prefetchPlayhead;	// last ts read per variable
+ std::thread _prefetchThread;
+ bool _prefetchShutdown;
+ bool _prefetchNewFrame;	// GetVariable() called since last Prefetch()
+ size_t _prefetchEpoch;		// cache clock at start of current frame
+ size_t _prefetchEpochPrev;	// cache clock at start of previous frame
+ bool _prefetching() const;	// true while servicing a Prefetch() request
+ bool _refining() const;	// true while servicing a refinement request
+
+ void _prefetchWorker();
+ bool _refineCurrent(const prefetch_t &request);
+ void _refine(const prefetch_t &request);
+ void _prefetchNotify(size_t ts, string varname);
+ void _stopPrefetch();
+
+ // all allocated regions, in LRU order
+ RegionCache _regionsList;
 
  VAPoR::BlkMemMgr  *_blk_mem_mgr;
 
@@ -767,7 +1356,41 @@ private:
  mutable VarInfoCache <double> _varInfoCacheDouble;
  mutable VarInfoCache <void *> _varInfoCacheVoidPtr;
 
- std::map <string, BlkExts> _blkExtsCache;
+ std::unordered_map <VarInfoKey, BlkExts, VarInfoKeyHash> _blkExtsCache;
+
+ // Persistent copy of _varInfoCacheDouble and _blkExtsCache
+ //
+ string _infoCachePath;
+ string _infoCacheFingerprint;
+
+ string _getInfoCacheFingerprint(const vector <string> &files) const;
+ void _loadInfoCache();
+ void _saveInfoCache();
+
+ // Counters reported by GetCacheStats(). _statsMutex may be acquired 
+ // while holding _mutex, but not the reverse.
+ //
+ mutable std::mutex _statsMutex;
+ CacheStats _stats;
+
+ void _countStats(
+	size_t ts, const string &varname, 
+	const std::function <void (CacheCounters &)> &count
+ );
+
+ // Chrome trace event log written when the -trace option is given
+ //
+ std::mutex _traceMutex;
+ string _tracePath;
+ FILE *_traceFP;
+ size_t _traceEvents;
+
+ void _openTrace();
+ void _closeTrace();
+ void _trace(
+	const char *name, double t0, double t1, 
+	size_t ts, const string &varname, int level, int lod
+ );
 
  // Get the immediate variable dependencies of a variable
  //
@@ -966,6 +1589,18 @@ UnstructuredGrid2D *_make_grid_unstructured2d(
 	bool    lock
  );
 
+ template <typename T> 
+ T *_get_region_from_superset(
+	size_t ts,
+	string varname,
+	int level,
+	int lod,
+	const std::vector <size_t> &bs,
+	const std::vector <size_t> &bmin,
+	const std::vector <size_t> &bmax,
+	bool    lock
+ );
+
  template <typename T>
  int _get_unblocked_region_from_fs(
 	size_t ts, string varname, int level, int lod,
@@ -976,6 +1611,16 @@ UnstructuredGrid2D *_make_grid_unstructured2d(
 	T *blks
  );
 
+ template <typename T>
+ int _get_downsampled_region_from_fs(
+	int fd,
+	const vector <size_t> &file_min,
+	const vector <size_t> &file_max,
+	const vector <size_t> &grid_min,
+	const vector <size_t> &grid_max,
+	T *region
+ );
+
  template <typename T>
  int _get_blocked_region_from_fs(
 	size_t ts, string varname, int level, int lod,
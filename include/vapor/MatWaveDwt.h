@@ -258,6 +258,55 @@ public:
     const size_t L[27], int *sigOut
  );
 
+
+ //! Instruction sets for the multi-signal transform kernels
+ //!
+ //! The column pass of the 2D transforms, and the Z pass of the 3D
+ //! transforms, filter many signals that are interleaved in memory. 
+ //! Rather than transposing the data and filtering one signal at a time,
+ //! these passes filter several neighboring signals at once, one per 
+ //! SIMD lane. Every lane performs the same sequence of floating point
+ //! operations as the one signal at a time code, so results are 
+ //! bit-for-bit identical for all settings.
+ //!
+ //! \li \c SIMD_NONE Transpose, and filter one signal at a time
+ //! \li \c SIMD_GENERIC Filter several signals at a time, without 
+ //! SIMD instructions
+ //! \li \c SIMD_SSE2 Use SSE2 instructions (two lanes)
+ //! \li \c SIMD_AVX2 Use AVX2 instructions (four lanes)
+ //! \li \c SIMD_AVX512 Use AVX-512 instructions (eight lanes)
+ //!
+ //! Integer transforms always filter one signal at a time.
+ //!
+ enum simd_t {
+	SIMD_NONE, SIMD_GENERIC, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512
+ };
+
+ //! Select the instruction set used by the multi-signal kernels
+ //!
+ //! The setting is global to all MatWaveDwt objects, and should not
+ //! be changed while transforms are running. The default is the most 
+ //! capable instruction set supported by the host, as determined at
+ //! run time.
+ //!
+ //! \param[in] simd Requested instruction set. If the host does not 
+ //! support \p simd the most capable supported instruction set that
+ //! is less capable than \p simd is used.
+ //!
+ //! \sa GetSIMD()
+ //
+ static void SetSIMD(simd_t simd);
+
+ //! Return the instruction set used by the multi-signal kernels
+ //!
+ //! \sa SetSIMD()
+ //
+ static simd_t GetSIMD();
+
+ //! Return the most capable instruction set supported by the host
+ //
+ static simd_t GetSIMDSupported();
+
 private:
 
  // 1D buffers
@@ -246,6 +246,18 @@ public:
 
  static bool GetEnableErrMsg() {return Enabled; }
 
+ //!
+ //! Enable or disable error message reporting for the calling thread
+ //!
+ //! This is similar to EnableErrMsg() but only affects calls to 
+ //! SetErrMsg() made from the calling thread. It is intended for 
+ //! background worker threads whose failures should not be reported.
+ //!
+ //! \param[in] enable Boolean flag to enable or disable error reporting
+ //! \retval prev The previous setting for the calling thread
+ //!
+ static bool EnableErrMsgThread(bool enable);
+
  // N.B. the error codes/messages are stored in static class members!!!
  static char 	*ErrMsg;
  static int	ErrCode;
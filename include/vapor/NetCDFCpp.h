@@ -72,6 +72,38 @@ public:
 	string name, int xtype, vector <string> dimnames
  );
 
+ //! Enable compression of a variable
+ //!
+ //! Enable the shuffle filter and deflate (zlib) compression of the
+ //! variable \p name. Compression is only supported by files in the
+ //! netCDF-4 format, and must be enabled before the variable is written.
+ //!
+ //! \param[in] shuffle If true the shuffle filter is applied prior
+ //! to compression
+ //! \param[in] deflate_level Compression level, between 0 (no 
+ //! compression) and 9 (maximum compression)
+ //
+ virtual int DefVarDeflate(string name, bool shuffle, int deflate_level);
+
+ //! Define the chunk sizes of a variable
+ //!
+ //! Store the variable \p name in chunks with dimensions \p chunksizes.
+ //! Each chunk is compressed, and must be read, as a unit. 
+ //! Chunking is only supported by files in the netCDF-4 format, and 
+ //! must be defined before the variable is written.
+ //!
+ //! \param[in] chunksizes An ordered list of chunk dimensions, one
+ //! for each dimension of \p name
+ //
+ virtual int DefVarChunking(string name, vector <size_t> chunksizes);
+
+ //! Return the format of the currently opened file
+ //!
+ //! \param[out] format One of NC_FORMAT_CLASSIC, NC_FORMAT_64BIT_OFFSET,
+ //! NC_FORMAT_CDF5, NC_FORMAT_NETCDF4, or NC_FORMAT_NETCDF4_CLASSIC
+ //
+ virtual int InqFormat(int &format) const;
+
  //! Learn the dimension names associated with a variable
  virtual int InqVarDims(
 	string name, vector <string> &dimnames, vector <size_t> &dims
@@ -366,6 +398,12 @@ public:
  //
  virtual bool InqDimDefined(string dimname);
 
+ //! Returns true if the named variable is defined
+ //!
+ //! \param[in] varname A NetCDF variable name
+ //
+ virtual bool InqVarDefined(string varname) const;
+
  //! Returns true if the named attribute is defined
  //!
  //! \param[in] dimname A NetCDF dimension name
@@ -384,10 +422,54 @@ public:
  //!
  int GetNCID() const {return(_ncid); }
 
+ //! Return the address of a hyperslab in a memory mapped view of the file
+ //!
+ //! On first use the presently opened file is mapped read-only into 
+ //! memory and its header is parsed to locate the variable data. 
+ //! If the hyperslab of \p varname described by \p start and 
+ //! \p count is stored contiguously in the file \p addr is set to 
+ //! the address of its first element. The mapping remains valid until
+ //! the file is closed.
+ //!
+ //! Only files in the netCDF classic, 64-bit offset, and 64-bit data 
+ //! formats, opened with NC_NOWRITE, can be mapped. Values are 
+ //! in the external representation of these formats, which is 
+ //! big-endian.
+ //!
+ //! \param[in] xtype The external type the variable must have
+ //!
+ //! \retval status Returns false if the hyperslab can not be mapped.
+ //! No error is reported.
+ //
+ virtual bool MapVara(
+	string varname, vector <size_t> start, vector <size_t> count,
+	nc_type xtype, const void *&addr
+ );
+
 private:
 
  int _ncid;
  string _path;
+ int _mode;
+
+ // Location of a variable's data in a classic format file
+ //
+ typedef struct {
+	nc_type xtype;
+	vector <size_t> dims;	// dimension lengths, slowest varying first
+	bool record;		// true if the slowest dimension is unlimited
+	size_t begin;		// file offset of first element
+ } _var_layout_t;
+
+ void *_map;		// address of mapped file, or NULL
+ size_t _mapLen;	// length of mapping in bytes
+ bool _mapFailed;	// true if mapping was attempted and failed
+ size_t _recSize;	// size in bytes of a record
+ size_t _numRecs;	// number of records in the mapped file
+ std::map <string, _var_layout_t> _varLayouts;
+
+ bool _mapFile();
+ void _unmapFile();
 
  int _PutVara(
 	string varname, vector <size_t> start, vector <size_t> count,
@@ -186,6 +186,46 @@ public:
     size_t *x, size_t *y, size_t *z, size_t *t
  );
 
+ //! Scatter values into a dense array
+ //!
+ //! This method copies the i'th element of \p src to \p dst[idx], where
+ //! idx is the i'th significant coordinate in ascending order. I.e. it
+ //! is equivalent to calling GetNextEntryRestart() and then GetNextEntry()
+ //! GetNumSignificant() times, but avoids the per-entry call overhead.
+ //! The entries of \p dst not addressed by the map are not modified.
+ //!
+ //! \param[in] src Array of GetNumSignificant() values
+ //! \param[out] dst Array large enough to hold the largest coordinate
+ //!
+ //! \retval n The number of elements copied from \p src
+ //!
+ template <class T> size_t Scatter(const T *src, T *dst) {
+	if (! _sorted) Sort();
+
+	const size_t *idx = _sigMapVec.data();
+	size_t n = _sigMapVec.size();
+	for (size_t i = 0; i<n; i++) {
+		dst[idx[i]] = src[i];
+	}
+	return(n);
+ }
+
+ //! Set the significant entries of a dense array to a value
+ //!
+ //! This method assigns \p value to \p dst[idx] for each significant
+ //! coordinate, idx. It is typically used to restore a previously 
+ //! scattered array to zero without clearing the entire array.
+ //!
+ //! \sa Scatter()
+ //
+ template <class T> void Fill(T value, T *dst) const {
+	const size_t *idx = _sigMapVec.data();
+	size_t n = _sigMapVec.size();
+	for (size_t i = 0; i<n; i++) {
+		dst[idx[i]] = value;
+	}
+ }
+
  //! Return size in bytes of an encoded signficance map of given size
  //!
  //! This static member method returns the size in bytes of an encoded 
@@ -193,7 +233,16 @@ public:
  //! SignificanceMap of given dimension, \p dims, and number of 
  //! entries, \p num_entries.
  //
+ //!
+ //! \param[in] dims Dimensions of the significance map
+ //! \param[in] num_entries Number of entries in the signficance map
+ //! \param[in] version Encoding version. If not specified the 
+ //! current version, returned by GetLatestVersion(), is used.
+ //
  static size_t GetMapSize(vector <size_t> dims, size_t num_entries);
+ static size_t GetMapSize(
+	vector <size_t> dims, size_t num_entries, int version
+ );
 
  //! Return size in bytes of an encoded signficance map of given size
  //!
@@ -293,6 +342,34 @@ public:
  //
  void Sort();
 
+ //! Set the encoding version used by GetMap()
+ //!
+ //! Version 2 maps store each significant coordinate as a packed,
+ //! fixed-width integer. Version 3 maps additionally support a bitmap
+ //! encoding (one bit per coordinate), which is used whenever it is
+ //! no larger than the packed encoding. In either case the size of
+ //! an encoded map is a function only of the map dimensions and the
+ //! number of entries. SetMap() decodes all versions. The default is 
+ //! the latest version. A map initialized with SetMap() adopts
+ //! the version of the encoded map.
+ //!
+ //! \param[in] version Encoding version: 2 or 3
+ //!
+ //! \retval status a negative value is returned if \p version is not
+ //! supported
+ //!
+ //! \sa GetLatestVersion(), GetMapSize()
+ //
+ int SetVersion(int version);
+
+ //! Return the encoding version used by GetMap()
+ //
+ int GetVersion() const { return(_version); }
+
+ //! Return the latest encoding version supported by this class
+ //
+ static int GetLatestVersion() { return(VDF_VERSION); }
+
  SignificanceMap &operator=(const SignificanceMap& map);
 
  friend std::ostream &operator<<(
@@ -302,7 +379,7 @@ public:
 private:
 
 	static const int HEADER_SIZE = 64;
-	static const int VDF_VERSION = 2;
+	static const int VDF_VERSION = 3;
 	size_t _nx;
 	size_t _ny;
 	size_t _nz;
@@ -319,6 +396,7 @@ private:
 	size_t _sigMapEncodeSize;		// size of _sigMapEncode in bytes
 
 	size_t _idxentry;	// Counter for sequential access to sig. map
+	int _version;		// Encoding version used by GetMap()
 
 	int _SignificanceMap(std::vector <size_t> dims);
 	int _SignificanceMap(
@@ -326,6 +404,9 @@ private:
 	);
 
 	static size_t _GetBitsPerIdx(vector <size_t> dims);
+	static bool _UseBitmap(
+		const vector <size_t> &dims, size_t num_entries, int version
+	);
 
 };
 
@@ -263,6 +263,11 @@ public:
  //! Finally, \p cratios specifies a vector of compression factors for
  //! subsequent compressed variable definitions. 
  //!
+ //! Integer variables may be stored without loss with the integer 
+ //! wavelet \e intbior2.2 and a single compression factor of 1. The data
+ //! files of such variables are written in the NetCDF-4 format so that 
+ //! their wavelet coefficients can be entropy coded.
+ //!
  //! \note For compressed variables compression is applied to individual blocks.
  //! Larger blocks permit deeper grid refinement hierarchies, but may
  //! result in poor cache performance and slowed disk storage access
@@ -300,6 +305,111 @@ public:
 	std::vector <size_t> &cratios
  ) const;
 
+ //! Enable entropy coding of compressed variables
+ //!
+ //! This method enables lossless entropy coding of the wavelet 
+ //! coefficients of every compressed variable in the VDC. Coefficients
+ //! are coded with the NetCDF library's shuffle and deflate filters, 
+ //! and the data files of compressed variables are written in the 
+ //! NetCDF-4 format. Compressed variables small enough to be stored in 
+ //! the master file are not entropy coded. 
+ //!
+ //! The settings apply to the entire VDC, and are saved in the master
+ //! file so that they are honored by programs that later write data to 
+ //! the VDC (e.g. raw2vdc).
+ //!
+ //! \param[in] deflate_level Deflate compression level, between 
+ //! 1 (fastest) and 9 (smallest). A value of 0 disables entropy coding,
+ //! which is the default.
+ //! \param[in] keepbits Number of mantissa bits retained in floating 
+ //! point coefficients, or zero to retain all of them. Discarding 
+ //! low order bits improves entropy coding, at the cost of a small
+ //! additional error.
+ //!
+ //! \retval status A negative int is returned if not in define mode,
+ //! or if an invalid parameter is specified.
+ //!
+ //! \sa WASP::DefVarEntropyCode()
+ //
+ int SetEntropyCode(int deflate_level, int keepbits);
+
+ //! Retrieve current entropy coding settings
+ //!
+ //! \sa SetEntropyCode()
+ //
+ void GetEntropyCode(int &deflate_level, int &keepbits) const {
+	deflate_level = _deflate_level;
+	keepbits = _keepbits;
+ }
+
+ //! Enable per-block wavelet selection for compressed variables
+ //!
+ //! This method names candidate wavelets, in addition to the wavelet
+ //! given by SetCompressionBlock(), from which the wavelet used to 
+ //! compress each block of every compressed variable is selected. 
+ //! Candidates must be compatible with the wavelet of each variable 
+ //! (see WASP::DefVarAdaptiveWavelet()). Candidates that are the
+ //! variable's own wavelet, or that differ from it in being integer
+ //! or floating point wavelets, are ignored for that variable.
+ //!
+ //! The candidates apply to the entire VDC, and are saved in the master
+ //! file so that they are honored by programs that later write data to 
+ //! the VDC (e.g. raw2vdc). Data written with per-block wavelets 
+ //! can't be read by versions of VAPOR that predate the feature.
+ //!
+ //! \param[in] wnames Names of the candidate wavelets. An empty list,
+ //! the default, disables per-block selection.
+ //!
+ //! \retval status A negative int is returned if not in define mode,
+ //! or if an invalid wavelet is specified.
+ //!
+ //! \sa WASP::DefVarAdaptiveWavelet(), SetCompressionBlock()
+ //
+ int SetAdaptiveWavelets(std::vector <string> wnames);
+
+ //! Retrieve the candidate wavelets for per-block wavelet selection
+ //!
+ //! \sa SetAdaptiveWavelets()
+ //
+ void GetAdaptiveWavelets(std::vector <string> &wnames) const {
+	wnames = _adaptive_wnames;
+ }
+
+ //! Enable error bounded compression of compressed variables
+ //!
+ //! This method bounds the maximum pointwise error of each block of 
+ //! every compressed variable at the finest level-of-detail written.
+ //! The compression ratios set with SetCompressionBlock() continue to
+ //! determine file size; blocks that meet the bound with fewer 
+ //! coefficients store fewer. The achieved error of each block is
+ //! recorded.
+ //!
+ //! The bound applies to the entire VDC, and is saved in the master
+ //! file so that it is honored by programs that later write data to 
+ //! the VDC (e.g. raw2vdc).
+ //!
+ //! \param[in] errbound The maximum pointwise error. A value of 0 
+ //! disables error bounded compression, which is the default.
+ //! \param[in] relative If true \p errbound is relative to the range
+ //! of the data values within each block. Otherwise \p errbound is an
+ //! absolute error.
+ //!
+ //! \retval status A negative int is returned if not in define mode,
+ //! or if an invalid parameter is specified.
+ //!
+ //! \sa WASP::DefVarErrorBound(), WASP::GetBlockErrors()
+ //
+ int SetErrorBound(double errbound, bool relative);
+
+ //! Retrieve the error bound for compressed variables
+ //!
+ //! \sa SetErrorBound()
+ //
+ void GetErrorBound(double &errbound, bool &relative) const {
+	errbound = _errbound;
+	relative = _errbound_relative;
+ }
+
 
 
  //! Set the boundary periodic for subsequent variable definitions
@@ -994,6 +1104,11 @@ protected:
  std::vector <size_t> _bs;
  string _wname;
  std::vector <size_t> _cratios;
+ int _deflate_level;	// entropy coding level, or 0 if disabled
+ int _keepbits;		// mantissa bits retained when entropy coding
+ std::vector <string> _adaptive_wnames;	// per-block wavelet candidates
+ double _errbound;	// maximum pointwise error, or 0 if not bounded
+ bool _errbound_relative;	// _errbound is relative to block range
  vector <bool> _periodic;
  VAPoR::UDUnits _udunits;
 
@@ -252,6 +252,16 @@ protected:
     const vector <size_t> &min, const vector <size_t> &max, int *region
  );
 
+ bool mapVariable(
+	int fd, const float *&data, bool &swap, vector <size_t> &bs
+ );
+
+ int readBlockSummaries(
+	int fd, vector <size_t> &bdims, 
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+ );
+
  virtual bool variableExists(
     size_t ts,
     string varname,
@@ -347,6 +357,8 @@ private:
 
  bool _var_in_master(const VDC::BaseVar &var) const;
 
+ int _create_mode(const VDC::BaseVar &var) const;
+
  string _get_mask_varname(string varname, double &mv) const;
 
  unsigned char *_read_mask_var(
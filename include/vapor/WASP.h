@@ -198,6 +198,17 @@ public:
     string name, vector <string> &dimnames, vector <size_t> &dims
  ) const;
 
+ //! Learn the names of the user defined variables present
+ //!
+ //! Same as NetCDFCpp::InqVarnames() except that the block summary 
+ //! variables implicitly defined by DefVar(), the block error
+ //! variables defined by DefVarErrorBound(), and the block wavelet 
+ //! variables defined by DefVarAdaptiveWavelet() are not returned
+ //!
+ //! \sa NetCDFCpp::InqVarnames(), GetBlockSummaries()
+ //
+ virtual int InqVarnames(vector <string> &varnames) const;
+
  //! Returns compression paramaters associated with the named variable
  //!
  //! This method returns various compression parameters associated
@@ -317,6 +328,16 @@ public:
  //! created with \b numfiles parameter greater than one then the
  //! length of \p cratios must exactly match that of \b numfiles.
  //!
+ //! Integer variables (e.g. masks or categorical fields) may be 
+ //! stored without loss by specifying an integer wavelet, such as 
+ //! "intbior2.2", and a compression ratio of 1. Integer wavelets 
+ //! transform integer data reversibly, and the resulting coefficients
+ //! are further entropy coded by the NetCDF library's deflate filter.
+ //! Without entropy coding the coefficients would take about twice 
+ //! the space of the original data, so integer wavelets require a 
+ //! file created in the netCDF-4 format (NC_NETCDF4). An error is 
+ //! returned for other formats.
+ //!
  //! \sa NetCDFCpp::DefVar(), Create(), InqCompressionInfo()
  //
  virtual int DefVar(
@@ -344,6 +365,172 @@ public:
 	double missing_value
  );
 
+ //! Enable error bounded compression for a compressed variable
+ //!
+ //! By default the number of wavelet coefficients retained for each
+ //! block is fixed by the compression ratios passed to DefVar(). 
+ //! This method additionally bounds the maximum pointwise error of each 
+ //! block at the finest level-of-detail written. Each block retains only
+ //! as many coefficients as are needed to meet the bound, up to the
+ //! number permitted by the smallest compression ratio. The storage 
+ //! allocated per block is unchanged, so the compression ratios 
+ //! continue to determine file size. Blocks that
+ //! meet the bound with fewer coefficients store fewer and decode faster,
+ //! and the smallest compression ratio may be chosen to accommodate the
+ //! most demanding blocks.
+ //!
+ //! The achieved error of each block is recorded and may be 
+ //! retrieved with GetBlockErrors(). Errors are measured before the 
+ //! coefficients are converted to the variable's external type, which 
+ //! may add rounding error of the order of that type's precision.
+ //! Coarser levels-of-detail, and
+ //! levels written with a compression ratio of one, are not affected.
+ //!
+ //! This method must be called in define mode after the variable
+ //! \p name is defined with DefVar().
+ //!
+ //! \param[in] name Name of a compressed variable
+ //! \param[in] errbound The maximum pointwise error. Must be greater 
+ //! than zero.
+ //! \param[in] relative If true \p errbound is relative to the range
+ //! (maximum minus minimum) of the data values within each block.
+ //! Otherwise \p errbound is an absolute error.
+ //!
+ //! \sa Compressor::ErrorBoundOnOff(), InqVarErrorBound(), 
+ //! GetBlockErrors()
+ //
+ virtual int DefVarErrorBound(
+	string name, double errbound, bool relative = false
+ );
+
+ //! Return the error bound of a variable
+ //!
+ //! \param[in] name Name of a variable
+ //! \param[out] errbound The error bound set with DefVarErrorBound(), or 
+ //! zero if the variable is not error bounded.
+ //! \param[out] relative True if \p errbound is relative to block range
+ //!
+ //! \sa DefVarErrorBound()
+ //
+ virtual int InqVarErrorBound(
+	string name, double &errbound, bool &relative
+ ) const;
+
+ //! Enable entropy coding of a compressed variable
+ //!
+ //! By default the wavelet coefficients and significance maps of 
+ //! each block are stored verbatim. This method enables an additional
+ //! stage, applied after compression, that entropy codes them with 
+ //! the NetCDF library's shuffle and deflate filters. The variable is
+ //! chunked so that each block is coded, and may be decoded, 
+ //! independently of all others. Decoding is performed transparently 
+ //! by the NetCDF library when the variable is read, so readers need
+ //! not be aware of it.
+ //!
+ //! The NetCDF library is not thread safe, and inflates coefficients
+ //! while they are read, holding the lock that serializes all NetCDF
+ //! calls. Hence decoding of the entropy coding stage is serial: only 
+ //! the wavelet reconstruction of blocks proceeds in parallel. The 
+ //! read pipeline overlaps the serial decode of the next batch of 
+ //! blocks with the reconstruction of the current one.
+ //!
+ //! Floating point coefficients are incompressible in their low order 
+ //! mantissa bits. If \p keepbits is greater than zero each 
+ //! coefficient is first rounded to \p keepbits significant mantissa 
+ //! bits, which introduces a relative error of at most 
+ //! 2<sup>-(keepbits+1)</sup> per coefficient. A value of 
+ //! 10 to 16 is a reasonable choice for single precision data. 
+ //! Integer coefficients, and the significance maps, are always stored
+ //! without loss. Errors recorded for error bounded variables 
+ //! (see DefVarErrorBound()) do not account for rounding.
+ //!
+ //! Entropy coding is only supported by files created in the 
+ //! netCDF-4 format (NC_NETCDF4). This method must be called in define 
+ //! mode after the variable \p name is defined with DefVar().
+ //!
+ //! \param[in] name Name of a compressed variable
+ //! \param[in] deflate_level Deflate compression level, between 
+ //! 1 (fastest) and 9 (smallest)
+ //! \param[in] keepbits Number of mantissa bits retained in 
+ //! floating point coefficients, or zero to retain all of them
+ //!
+ //! \sa InqVarEntropyCode(), Create(), NetCDFCpp::DefVarDeflate()
+ //
+ virtual int DefVarEntropyCode(
+	string name, int deflate_level = 1, int keepbits = 0
+ );
+
+ //! Return the entropy coding parameters of a variable
+ //!
+ //! \param[in] name Name of a variable
+ //! \param[out] deflate_level The deflate level set with 
+ //! DefVarEntropyCode(), or zero if the variable is not entropy coded.
+ //! \param[out] keepbits The number of mantissa bits retained in 
+ //! coefficients, or zero if all are retained
+ //!
+ //! \sa DefVarEntropyCode()
+ //
+ virtual int InqVarEntropyCode(
+	string name, int &deflate_level, int &keepbits
+ ) const;
+
+ //! Enable per-block wavelet selection for a compressed variable
+ //!
+ //! By default every block of a variable is transformed with the 
+ //! wavelet passed to DefVar(). This method names additional candidate 
+ //! wavelets. When the variable is written each block is transformed
+ //! with every candidate and reconstructed from the coefficients 
+ //! retained at the finest level-of-detail written, and the
+ //! candidate with the smallest reconstruction error is used for the
+ //! block. Candidates whose errors are within a small tolerance of the
+ //! smallest are treated as equal, and the one with the shortest 
+ //! filter, which decodes fastest, is chosen. The wavelet selected for
+ //! each block is recorded, and may be retrieved with 
+ //! GetBlockWavelets(). Reading dispatches on it transparently.
+ //!
+ //! All blocks of a variable share a single storage layout and 
+ //! multiresolution hierarchy, which are determined by the wavelet 
+ //! passed to DefVar(). Candidates are restricted to the same number of
+ //! transformation levels, and must produce the same number of 
+ //! coefficients, and the same grid dimensions at each refinement 
+ //! level. Hence the wavelet passed to DefVar() should be the one 
+ //! with the longest filter. For example, "bior4.4" with candidates
+ //! "bior3.3" and "bior1.1" (the Haar wavelet with symmetric boundary
+ //! handling). Integer and floating point wavelets may not be mixed.
+ //!
+ //! Writing a variable with \b n candidates costs about 2n + 1 
+ //! forward and inverse transforms per block, rather than one. Reading
+ //! costs no more than with a single wavelet.
+ //!
+ //! Variables with per-block wavelets require WASP file version 5.
+ //! Older readers report an error when opening them rather than 
+ //! decoding them incorrectly.
+ //!
+ //! This method must be called in define mode after the variable
+ //! \p name is defined with DefVar().
+ //!
+ //! \param[in] name Name of a compressed variable
+ //! \param[in] wnames Names of the candidate wavelets, in addition to the
+ //! wavelet passed to DefVar(). At most 254 candidates may be given.
+ //!
+ //! \sa InqVarAdaptiveWavelet(), GetBlockWavelets(), DefVar()
+ //
+ virtual int DefVarAdaptiveWavelet(string name, vector <string> wnames);
+
+ //! Return the candidate wavelets of a variable
+ //!
+ //! \param[in] name Name of a variable
+ //! \param[out] wnames The wavelet passed to DefVar(), followed by the
+ //! candidates passed to DefVarAdaptiveWavelet(). The wavelet ids 
+ //! returned by GetBlockWavelets() are indices into \p wnames.
+ //! If per-block wavelet selection is not enabled \p wnames is empty.
+ //!
+ //! \sa DefVarAdaptiveWavelet()
+ //
+ virtual int InqVarAdaptiveWavelet(
+	string name, vector <string> &wnames
+ ) const;
+
  //! \copydoc NetCDFCpp::DefVar()
  // Is this needed?
  virtual int DefVar(
@@ -630,6 +817,111 @@ public:
  virtual int GetVar(int16_t *data);
  virtual int GetVar(unsigned char *data);
 
+ //! Return the address of a hyper-slab of the currently opened variable
+ //! in a memory mapped view of the file
+ //!
+ //! Variables opened for reading that are either not WASP variables 
+ //! (See InqVarWASP()), or are WASP variables that are blocked but not
+ //! compressed, can be mapped. The values of a blocked variable are
+ //! stored block by block: the blocks are ordered as the elements of
+ //! an array whose dimensions are the variable's dimensions in blocks
+ //! (rounded up), and the values within each block are ordered as the
+ //! elements of an array of dimension \p bs. Blocks on the boundary
+ //! are padded. For a blocked variable \p start and \p count must
+ //! select all of each blocked dimension.
+ //!
+ //! \param[in] start Same as NetCDFCpp::MapVara()
+ //! \param[in] count Same as NetCDFCpp::MapVara()
+ //! \param[in] xtype Same as NetCDFCpp::MapVara()
+ //! \param[out] addr Same as NetCDFCpp::MapVara()
+ //! \param[out] bs Block dimensions of the mapped hyper-slab, ordered
+ //! like \p count. All elements are one if the variable is not blocked.
+ //!
+ //! \retval status Returns false if the hyper-slab can not be mapped.
+ //! No error is reported.
+ //!
+ //! \sa NetCDFCpp::MapVara(), OpenVarRead()
+ //
+ virtual bool MapVara(
+	vector <size_t> start, vector <size_t> count, nc_type xtype,
+	const void *&addr, vector <size_t> &bs
+ );
+
+ //! Read the per-block summaries of the currently opened variable
+ //!
+ //! When a blocked variable is written with PutVara() the range of
+ //! valid (not missing) data values contained in each block, and 
+ //! whether any of the block's values are missing, are recorded.
+ //! This method returns these summaries for all of the blocks
+ //! intersecting the hyper-slab described by \p start and \p count 
+ //! without reading or reconstructing any of the blocks themselves.
+ //! The summaries are computed from the native data, before 
+ //! compression, and are independent of the refinement level and 
+ //! level-of-detail the variable was opened with.
+ //!
+ //! \param[in] start Same as PutVara(). Coordinates are expressed
+ //! relative to the native grid.
+ //! \param[in] count Same as PutVara().
+ //! \param[out] bdims Ordered list of the dimensions of the returned 
+ //! summary arrays in blocks. If the variable is not blocked, or was
+ //! written by a version of WASP that did not record summaries,
+ //! \p bdims will be empty.
+ //! \param[out] mins The minimum valid data value of each block. 
+ //! \param[out] maxs The maximum valid data value of each block. 
+ //! \param[out] missing For each block, 0 if the block has no missing
+ //! values, 1 if some values are missing, and 2 if all values are missing.
+ //! The values of \p mins and \p maxs are undefined for blocks whose
+ //! values are all missing.
+ //!
+ //! \sa OpenVarRead(), DefVar()
+ //
+ virtual int GetBlockSummaries(
+	vector <size_t> start, vector <size_t> count, vector <size_t> &bdims,
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+ );
+
+ //! Read the achieved per-block errors of the currently opened variable
+ //!
+ //! For variables defined with DefVarErrorBound() this method returns 
+ //! the maximum pointwise reconstruction error, as measured at 
+ //! compression time, of each block intersecting the hyper-slab described
+ //! by \p start and \p count. 
+ //!
+ //! \param[in] start Same as GetBlockSummaries()
+ //! \param[in] count Same as GetBlockSummaries()
+ //! \param[out] bdims Ordered list of the dimensions of \p errors in 
+ //! blocks. If the variable is not error bounded \p bdims will be empty.
+ //! \param[out] errors The achieved error of each block
+ //!
+ //! \sa DefVarErrorBound(), GetBlockSummaries()
+ //
+ virtual int GetBlockErrors(
+	vector <size_t> start, vector <size_t> count, vector <size_t> &bdims,
+	vector <double> &errors
+ );
+
+ //! Read the per-block wavelets of the currently opened variable
+ //!
+ //! For variables defined with DefVarAdaptiveWavelet() this method 
+ //! returns the id of the wavelet selected for each block intersecting
+ //! the hyper-slab described by \p start and \p count. 
+ //!
+ //! \param[in] start Same as GetBlockSummaries()
+ //! \param[in] count Same as GetBlockSummaries()
+ //! \param[out] bdims Ordered list of the dimensions of \p wavelets in 
+ //! blocks. If per-block wavelet selection is not enabled \p bdims will 
+ //! be empty.
+ //! \param[out] wavelets The wavelet id of each block, an index into 
+ //! the list of wavelets returned by InqVarAdaptiveWavelet()
+ //!
+ //! \sa DefVarAdaptiveWavelet(), GetBlockSummaries()
+ //
+ virtual int GetBlockWavelets(
+	vector <size_t> start, vector <size_t> count, vector <size_t> &bdims,
+	vector <unsigned char> &wavelets
+ );
+
  //! Copy a variable from one WASP file to another WASP file
  //!
  //! Copy a variable from the WASP file associated with this
@@ -706,6 +998,46 @@ public:
  //! NetCDF attribute name specifying WASP version number
  static string AttNameVersion() {return("WASP.Version");}
 
+ //! NetCDF variable name of the per-block summaries of variable \p name
+ static string VarNameBlockSummary(string name) {
+	return("WASP.BlockSummary." + name);
+ }
+
+ //! NetCDF dimension name of the per-block summary vectors 
+ static string DimNameBlockSummary() {return("WASP.BlockSummary");}
+
+ //! NetCDF attribute name specifying the error bound of a variable
+ static string AttNameErrorBound() {return("WASP.ErrorBound");}
+
+ //! NetCDF attribute name specifying if the error bound is relative
+ static string AttNameErrorBoundRelative() {
+	return("WASP.ErrorBoundRelative");
+ }
+
+ //! NetCDF variable name of the per-block achieved errors of variable 
+ //! \p name
+ static string VarNameBlockError(string name) {
+	return("WASP.BlockError." + name);
+ }
+
+ //! NetCDF attribute name specifying the candidate wavelets of a 
+ //! variable with per-block wavelet selection
+ static string AttNameWavelets() {return("WASP.Wavelets");}
+
+ //! NetCDF variable name of the per-block wavelet ids of variable 
+ //! \p name
+ static string VarNameBlockWavelet(string name) {
+	return("WASP.BlockWavelet." + name);
+ }
+
+ //! NetCDF attribute name specifying the deflate level of an entropy
+ //! coded variable
+ static string AttNameEntropyCode() {return("WASP.EntropyCode");}
+
+ //! NetCDF attribute name specifying the number of mantissa bits 
+ //! retained in the coefficients of an entropy coded variable
+ static string AttNameKeepBits() {return("WASP.KeepBits");}
+
 
 private:
 
@@ -729,12 +1061,18 @@ private:
  vector <size_t> _open_dims;    // compressed dims of opened variable
  int _open_lod; // level-of-detail of opened variable
  int _open_level;   // grid refinement level of opened variable
+ int _open_keepbits;	// mantissa bits retained in coefficients of opened var
  bool _open_write;  // opened variable open for writing?
  bool _open_waspvar;	// opened variable is a WASP variable?
  string _open_varname;  // name of opened variable
  nc_type _open_varxtype;  // external type of opened variable
  vector <Compressor *> _open_compressors;  // Compressor for opened variable
 
+ // Per-block wavelet candidates of opened variable, one set for each
+ // thread. The first candidate of each set is _open_compressors[i]
+ //
+ vector <vector <Compressor *> > _open_wcompressors;
+
 
  int _GetBlockAlignedDims(
 	vector <string> dimnames,
@@ -757,6 +1095,10 @@ private:
 
  int _InqDimlen(string name, size_t &len) const;
 
+ // Significance map encoding version used by files of version _fileVersion
+ //
+ int _sigmap_version() const;
+
  void _get_encoding_vectors(
     string wname, vector <size_t> bs, vector <size_t> cratios, int xtype,
     vector <size_t> &ncoeffs, vector <size_t> &encoded_dims
@@ -784,6 +1126,12 @@ private:
     vector <size_t> &udims, vector <size_t> &dims, string &wname
  ) const;
 
+ void _open_wavelet_compressors(
+	const vector <string> &wnames, const vector <size_t> &bs
+ );
+
+ void _close_wavelet_compressors();
+
  template <class T, class U>
  int _GetVara(
     vector <size_t> start, vector <size_t> count, bool unblock, T *data,
@@ -141,6 +141,13 @@ long FileUtils::GetFileModifiedTime(const string &path)
     return attrib.st_mtime;
 }
 
+long FileUtils::GetFileSize(const string &path)
+{
+	struct STAT64 attrib;
+    if (STAT64(path.c_str(), &attrib) != 0) return -1;
+    return attrib.st_size;
+}
+
 bool FileUtils::IsPathAbsolute(const std::string &path)
 {
 #ifdef WIN32
@@ -9,6 +9,7 @@
 #include <vector>
 #include <iostream>
 #include <sstream>
+#include <mutex>
 
 #include <vapor/MyBase.h>
 #ifdef WIN32
@@ -63,6 +64,23 @@ void (*MyBase::DiagMsgCB) (const char *msg) = NULL;
 
 bool MyBase::Enabled = true;
 
+namespace {
+
+// Messages are formatted into static buffers shared by all threads.
+// Serialize access so that worker threads can't corrupt them.
+//
+std::recursive_mutex msgMutex;
+
+thread_local bool threadEnabled = true;
+
+};
+
+bool MyBase::EnableErrMsgThread(bool enable) {
+	bool prev = threadEnabled;
+	threadEnabled = enable;
+	return(prev);
+}
+
 MyBase::MyBase() {
 	SetClassName("MyBase");
 }
@@ -135,7 +153,9 @@ void	MyBase::SetErrMsg(
 	va_list args;	// initialize to make valgrind shutup
 
 
-	if (! Enabled) return;
+	if (! Enabled || ! threadEnabled) return;
+
+	std::lock_guard <std::recursive_mutex> lock(msgMutex);
 	ErrCode = 1;
 
 	va_start(args, format);
@@ -158,7 +178,9 @@ void	MyBase::SetErrMsg(
 	va_list args;	// initialize to make valgrind shutup
 
 
-	if (! Enabled) return;
+	if (! Enabled || ! threadEnabled) return;
+
+	std::lock_guard <std::recursive_mutex> lock(msgMutex);
 	ErrCode = errcode;
 
 	va_start(args, format);
@@ -179,6 +201,8 @@ void	MyBase::SetDiagMsg(
 ) {
 	va_list args;	// initialize to make valgrind shutup
 
+	std::lock_guard <std::recursive_mutex> lock(msgMutex);
+
 	va_start(args, format);
 	_SetErrMsg(&DiagMsg, &DiagMsgSize, format, args);
 	va_end(args);
@@ -4,10 +4,17 @@
 #include <cerrno>
 #include <iostream>
 #include <new>
+#include <iterator>
+#include <algorithm>
 #ifndef WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
 
+#include "vapor/VAssert.h"
 #include <vapor/BlkMemMgr.h>
 
 using namespace Wasp;
@@ -26,11 +33,233 @@ size_t BlkMemMgr::_blk_size = 0;
 
 vector <size_t>	BlkMemMgr::_mem_region_sizes;
 vector <unsigned char *> BlkMemMgr::_blks;
-vector < vector <BlkMemMgr::_mem_allocation_t > > BlkMemMgr::_mem_regions;
-#ifdef	VAPOR3_0_0_ALPHA
-#endif
+vector <BlkMemMgr::_region_info_t> BlkMemMgr::_region_info;
+
+BlkMemMgr::PagePolicy BlkMemMgr::_page_policy_req = BlkMemMgr::PAGES_DEFAULT;
+BlkMemMgr::NumaPolicy BlkMemMgr::_numa_policy_req = BlkMemMgr::NUMA_DEFAULT;
+BlkMemMgr::PagePolicy BlkMemMgr::_page_policy = BlkMemMgr::PAGES_DEFAULT;
+BlkMemMgr::NumaPolicy BlkMemMgr::_numa_policy = BlkMemMgr::NUMA_DEFAULT;
+int BlkMemMgr::_numa_nodes = 0;
+std::map <unsigned char *, BlkMemMgr::_mem_run_t> BlkMemMgr::_free_by_addr;
+std::multimap <size_t, unsigned char *> BlkMemMgr::_free_by_size;
+std::unordered_map <void *, BlkMemMgr::_mem_run_t> BlkMemMgr::_used;
 
 int	BlkMemMgr::_ref_count = 0;
+size_t	BlkMemMgr::_num_alloc_calls = 0;
+size_t	BlkMemMgr::_num_alloc_failures = 0;
+
+std::mutex BlkMemMgr::_mutex;
+
+namespace {
+
+#ifdef __linux__
+
+// Linux memory policy modes (from <numaif.h>, which requires libnuma)
+//
+const int mpolBind = 2;
+const int mpolInterleave = 3;
+
+// Size of the default huge page in bytes, or 0 if unknown
+//
+size_t huge_page_size() {
+	FILE *fp = fopen("/proc/meminfo", "r");
+	if (! fp) return(0);
+
+	size_t kb = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) break;
+	}
+	fclose(fp);
+	return(kb * 1024);
+}
+
+// Return the online NUMA nodes, e.g. "0-1" or "0,2-3", as a bit mask. 
+// Only the first 64 nodes are considered
+//
+unsigned long online_numa_nodes() {
+	FILE *fp = fopen("/sys/devices/system/node/online", "r");
+	if (! fp) return(0);
+
+	char line[256];
+	if (! fgets(line, sizeof(line), fp)) line[0] = '\0';
+	fclose(fp);
+
+	unsigned long mask = 0;
+	const char *ptr = line;
+	while (*ptr) {
+		int first, last, n;
+		if (sscanf(ptr, "%d-%d%n", &first, &last, &n) == 2) ptr += n;
+		else if (sscanf(ptr, "%d%n", &first, &n) == 1) {
+			last = first;
+			ptr += n;
+		}
+		else break;
+
+		for (int i=first; i<=last && i<64; i++) mask |= 1UL << i;
+		if (*ptr == ',') ptr++;
+	}
+	return(mask);
+}
+
+// The online NUMA nodes don't change while the process runs, so they are
+// only read once
+//
+unsigned long online_numa_nodes_cached() {
+	static const unsigned long online = online_numa_nodes();
+	return(online);
+}
+
+#endif
+
+};
+
+void BlkMemMgr::_insert_free(unsigned char *ptr, const _mem_run_t &run) {
+	_free_by_addr[ptr] = run;
+	_free_by_size.insert(std::make_pair(run._nblks, ptr));
+}
+
+void BlkMemMgr::_remove_free(
+	std::map <unsigned char *, _mem_run_t>::iterator itr
+) {
+	auto range = _free_by_size.equal_range(itr->second._nblks);
+	for (auto sitr = range.first; sitr != range.second; ++sitr) {
+		if (sitr->second == itr->first) {
+			_free_by_size.erase(sitr);
+			break;
+		}
+	}
+	_free_by_addr.erase(itr);
+}
+
+unsigned char *BlkMemMgr::_alloc_region(
+	size_t nbytes, _region_info_t &info
+) {
+	info._nbytes = nbytes;
+	info._mapped = false;
+	info._huge = false;
+
+#ifdef __linux__
+	// Use anonymous mappings for anything but the defaults: huge pages
+	// require them, and memory policies must be applied to pages that
+	// haven't been touched yet
+	//
+	if (_page_policy != PAGES_DEFAULT || _numa_policy != NUMA_DEFAULT) {
+		void *ptr;
+
+		size_t hpsize = huge_page_size();
+		if (_page_policy == PAGES_EXPLICIT && hpsize) {
+			size_t n = ((nbytes + hpsize - 1) / hpsize) * hpsize;
+			ptr = mmap(
+				NULL, n, PROT_READ | PROT_WRITE, 
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+			);
+			if (ptr != MAP_FAILED) {
+				info._nbytes = n;
+				info._mapped = true;
+				info._huge = true;
+				return((unsigned char *) ptr);
+			}
+			SetDiagMsg(
+				"BlkMemMgr::_alloc_region() : no huge pages for %lu bytes (%M),"
+				" using transparent huge pages", nbytes
+			);
+		}
+
+		ptr = mmap(
+			NULL, nbytes, PROT_READ | PROT_WRITE, 
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+		);
+		if (ptr == MAP_FAILED) return(NULL);
+
+		info._mapped = true;
+
+#ifdef MADV_HUGEPAGE
+		if (_page_policy != PAGES_DEFAULT) {
+			info._huge = madvise(ptr, nbytes, MADV_HUGEPAGE) == 0;
+		}
+#endif
+		return((unsigned char *) ptr);
+	}
+#endif
+
+	return(new(nothrow) unsigned char[nbytes]);
+}
+
+void BlkMemMgr::_free_region(unsigned char *ptr, const _region_info_t &info) {
+#ifdef __linux__
+	if (info._mapped) {
+		(void) munmap(ptr, info._nbytes);
+		return;
+	}
+#endif
+	delete [] ptr;
+}
+
+// Apply the NUMA policy to a newly allocated pool region. 
+//
+void BlkMemMgr::_place_region(unsigned char *ptr, size_t nbytes, int region) {
+#ifdef __linux__
+	if (_numa_policy == NUMA_DEFAULT) return;
+
+	unsigned long online = online_numa_nodes_cached();
+	int nnodes = 0;
+	for (int i=0; i<64; i++) {
+		if (online & (1UL << i)) nnodes++;
+	}
+	if (nnodes < 2) return;
+
+	int mode;
+	unsigned long mask;
+	if (_numa_policy == NUMA_INTERLEAVE) {
+		mode = mpolInterleave;
+		mask = online;
+	}
+	else {
+
+		// Region i is bound to the i'th online node, modulo the number 
+		// of nodes
+		//
+		int target = region % nnodes;
+		mask = online;
+		for (int i=0; i<target; i++) mask &= mask - 1;
+		mask &= ~(mask - 1);
+		mode = mpolBind;
+	}
+
+	// The kernel expects 'maxnode' to be one more than the number of
+	// bits in the mask
+	//
+	long rc = syscall(
+		SYS_mbind, ptr, nbytes, mode, &mask, sizeof(mask) * 8 + 1, 0
+	);
+	if (rc != 0) {
+		SetDiagMsg("BlkMemMgr::_place_region() : mbind() failed : %M");
+		return;
+	}
+
+	// Interleaved regions span every node. Bound regions are assigned
+	// to nodes round robin, so the pool spans one more node with each
+	// region until all nodes are used
+	//
+	int nodes = _numa_policy == NUMA_INTERLEAVE ? 
+		nnodes : std::min(region + 1, nnodes);
+	if (nodes > _numa_nodes) _numa_nodes = nodes;
+#endif
+}
+
+void BlkMemMgr::_free_all() {
+	for (int i=0; i<_blks.size(); i++) {
+		if (_blks[i]) _free_region(_blks[i], _region_info[i]);
+	}
+	_blks.clear();
+	_region_info.clear();
+	_mem_region_sizes.clear();
+	_numa_nodes = 0;
+	_free_by_addr.clear();
+	_free_by_size.clear();
+	_used.clear();
+}
 
 int	BlkMemMgr::_Reinit(size_t n)
 {
@@ -42,18 +271,23 @@ int	BlkMemMgr::_Reinit(size_t n)
 	_page_aligned = _page_aligned_req;
 	_mem_size_max = _mem_size_max_req;
 	_blk_size = _blk_size_req;
+	_page_policy = _page_policy_req;
+	_numa_policy = _numa_policy_req;
 
 	//
-	// Calculate starting region size
+	// Calculate starting region size. With a fine grained block size
+	// the first request may be tiny, so start with a reasonable fraction 
+	// of the maximum pool size to avoid creating many small regions
 	//
 	size_t mem_size = n;
+	if (mem_size < _mem_size_max / 16) mem_size = _mem_size_max / 16;
 
 	//
 	// How much total memory already allocated
 	//
 	size_t total_size = 0;
 	int r;
-	for (r=0; r<_mem_regions.size(); r++) total_size += _mem_region_sizes[r];
+	for (r=0; r<_mem_region_sizes.size(); r++) total_size += _mem_region_sizes[r];
 
 	//
 	// New region size is double preceding one
@@ -78,11 +312,12 @@ int	BlkMemMgr::_Reinit(size_t n)
 	}
 
 	unsigned char *blks;
+	_region_info_t info;
 	do {
 		size = (size_t) _blk_size * (size_t) mem_size;
 		size += (size_t) page_size;
 
-		blks = new(nothrow) unsigned char[size];
+		blks = _alloc_region(size, info);
 		if (! blks) {
 			SetDiagMsg(
 				"BlkMemMgr::_Reinit() : failed to allocate %d blocks, retrying",
@@ -90,9 +325,9 @@ int	BlkMemMgr::_Reinit(size_t n)
 			);
 			mem_size = mem_size >> 1;
 		}
-	} while (blks == NULL && mem_size > 0 && _blk_size > 0);
+	} while (blks == NULL && mem_size >= n && _blk_size > 0);
 
-	if (! blks && mem_size > 0 && _blk_size > 0) {
+	if (! blks) {
 		SetDiagMsg("Memory allocation of %lu bytes failed", size);
 		return(false);
 	}
@@ -106,15 +341,15 @@ int	BlkMemMgr::_Reinit(size_t n)
 		blkptr += page_size - (((size_t) blks) % page_size);
 	}
 
-	_mem_allocation_t m;
-	vector <_mem_allocation_t> mem_region;
-	m._nfree = mem_size;
-	m._nused = 0;
-	m._blk = blkptr;
-	mem_region.push_back(m);
+	_place_region(blks, info._nbytes, _blks.size());
+
+	_mem_run_t run;
+	run._region = _blks.size();
+	run._nblks = mem_size;
+	_insert_free(blkptr, run);
 
-	_mem_regions.push_back(mem_region);
 	_blks.push_back(blks);
+	_region_info.push_back(info);
 	_mem_region_sizes.push_back(mem_size);
 
 	return(true);
@@ -139,6 +374,8 @@ int	BlkMemMgr::RequestMemSize(
 		return(-1);
 	}
 
+	std::lock_guard <std::mutex> guard(_mutex);
+
 	_blk_size_req = blk_size;
 	_mem_size_max_req = num_blks;
 	_page_aligned_req = page_aligned;
@@ -146,11 +383,37 @@ int	BlkMemMgr::RequestMemSize(
 	return(0);
 }
 
+void BlkMemMgr::SetPoolPolicy(PagePolicy pages, NumaPolicy numa) {
+	SetDiagMsg("BlkMemMgr::SetPoolPolicy(%d,%d)", pages, numa);
+
+	std::lock_guard <std::mutex> guard(_mutex);
+
+	_page_policy_req = pages;
+	_numa_policy_req = numa;
+}
+
+bool BlkMemMgr::ParsePagePolicy(string name, PagePolicy &policy) {
+	if (name == "default") policy = PAGES_DEFAULT;
+	else if (name == "transparent") policy = PAGES_TRANSPARENT;
+	else if (name == "explicit") policy = PAGES_EXPLICIT;
+	else return(false);
+	return(true);
+}
+
+bool BlkMemMgr::ParseNumaPolicy(string name, NumaPolicy &policy) {
+	if (name == "default") policy = NUMA_DEFAULT;
+	else if (name == "interleave") policy = NUMA_INTERLEAVE;
+	else if (name == "bind") policy = NUMA_BIND;
+	else return(false);
+	return(true);
+}
+
 BlkMemMgr::BlkMemMgr(
 ) {
 
 	SetDiagMsg("BlkMemMgr::BlkMemMgr()");
 
+	std::lock_guard <std::mutex> guard(_mutex);
 
 	//
 	// If there are no other instances of this object, re-initialized
@@ -161,16 +424,16 @@ BlkMemMgr::BlkMemMgr(
 		return;
 	}
 
-	for (int i=0; i<_blks.size(); i++) {
-		if (_blks[i]) delete [] _blks[i];
-	}
-	_mem_regions.clear();
-	_mem_region_sizes.clear();
-	_blks.clear();
+	_free_all();
 
 	_page_aligned = _page_aligned_req;
 	_mem_size_max = _mem_size_max_req;
 	_blk_size = _blk_size_req;
+	_page_policy = _page_policy_req;
+	_numa_policy = _numa_policy_req;
+
+	_num_alloc_calls = 0;
+	_num_alloc_failures = 0;
 
 	_ref_count = 1;
 
@@ -179,16 +442,13 @@ BlkMemMgr::BlkMemMgr(
 BlkMemMgr::~BlkMemMgr() {
 	SetDiagMsg("BlkMemMgr::~BlkMemMgr()");
 
+	std::lock_guard <std::mutex> guard(_mutex);
+
 	if (_ref_count > 0) _ref_count--;
 
 	if (_ref_count != 0) return;
 
-	for (int i=0; i<_blks.size(); i++) {
-		if (_blks[i]) delete [] _blks[i];
-	}
-	_blks.clear();
-	_mem_regions.clear();
-	_mem_region_sizes.clear();
+	_free_all();
 
 }
 
@@ -198,48 +458,52 @@ void	*BlkMemMgr::Alloc(
 ) {
 	SetDiagMsg("BlkMemMgr::Alloc(%d)", n);
 
+	std::unique_lock <std::mutex> guard(_mutex);
+
+	_num_alloc_calls++;
+
+	if (n == 0) n = 1;
+
 	//
-	// Check each region, find the first run of blocks large enough
-	// to satisfy the request
+	// Find the smallest free run large enough to satisfy the request. 
+	// If there is none try to grow the memory pool.
 	//
-	void *blk = NULL;
-	for (int r=0; r<_mem_regions.size() && ! blk; r++) {
-		vector <_mem_allocation_t> &mem_region = _mem_regions[r];
-		for (int i=0; i<mem_region.size() && ! blk; i++) {
-
-			if (n<=mem_region[i]._nfree) {	// Found a run of blocks
-				blk = mem_region[i]._blk;
-				mem_region[i]._nused = n;
-
-				//
-				// If run is strictly larger than request split it
-				//
-				if (n<mem_region[i]._nfree) {
-					_mem_allocation_t m;
-					m._nfree = mem_region[i]._nfree - n;
-					m._nused = 0;
-					m._blk = (unsigned char *) mem_region[i]._blk + (_blk_size * n);
-					mem_region.insert(mem_region.begin()+i+1, m);
-				}
-				mem_region[i]._nfree = 0;
-			}
+	auto sitr = _free_by_size.lower_bound(n);
+	if (sitr == _free_by_size.end()) {
+		if (! BlkMemMgr::_Reinit(n)) {
+			_num_alloc_failures++;
+			return(NULL);
 		}
+		sitr = _free_by_size.lower_bound(n);
+		VAssert(sitr != _free_by_size.end());
 	}
-				
-	
-	if (! blk) {
-		// Couldn't find space in existing memory pool.
-		// Try to allocate more memory.
-		//
-		if (! BlkMemMgr::_Reinit(n)) 
-			return(NULL);
 
-		return(Alloc(n,fill));
+	unsigned char *blk = sitr->second;
+	auto aitr = _free_by_addr.find(blk);
+	VAssert(aitr != _free_by_addr.end());
+
+	_mem_run_t run = aitr->second;
+	_remove_free(aitr);
+
+	//
+	// If run is strictly larger than request split it
+	//
+	if (n < run._nblks) {
+		_mem_run_t rest;
+		rest._region = run._region;
+		rest._nblks = run._nblks - n;
+		_insert_free(blk + (_blk_size * n), rest);
 	}
+
+	run._nblks = n;
+	_used[blk] = run;
+
+	// The run is ours now. Don't hold up other threads while clearing it
+	//
+	guard.unlock();
 				
 	if (fill) {
-		unsigned char *ptr = (unsigned char *) blk;
-		for (size_t i=0; i<n*_blk_size; i++) ptr[i] = 0;
+		memset(blk, 0, n*_blk_size);
 	}
 
 	return(blk);
@@ -250,38 +514,72 @@ void	BlkMemMgr::FreeMem(
 ) {
 	SetDiagMsg("BlkMemMgr::FreeMem()");
 
+	std::lock_guard <std::mutex> guard(_mutex);
 
-	bool found = false;
-	for (int r=0; r<_mem_regions.size() && ! found; r++) {
-		vector <_mem_allocation_t> &mem_region = _mem_regions[r];
-		for (int i=0; i<mem_region.size() && ! found; i++) {
-			if (ptr == mem_region[i]._blk) {
-				found = true;
-				mem_region[i]._nfree = mem_region[i]._nused;
-				mem_region[i]._nused = 0;
+	auto uitr = _used.find(ptr);
+	if (uitr == _used.end()) {
+		cerr << "Failed to free block " << ptr << endl;
+		return;
+	}
 
-			}
-		}
+	unsigned char *start = (unsigned char *) ptr;
+	_mem_run_t run = uitr->second;
+	_used.erase(uitr);
+
+	//
+	// Coalesce with the following run if it's free
+	//
+	auto next = _free_by_addr.find(start + (_blk_size * run._nblks));
+	if (next != _free_by_addr.end() && next->second._region == run._region) {
+		run._nblks += next->second._nblks;
+		_remove_free(next);
 	}
-	if (! found) cerr << "Failed to free block " << ptr << endl;
 
 	//
-	// Collapse any two adjacent runs of they're both free
+	// Coalesce with the preceding run if it's free
 	//
-	bool collapse;
-	do {
-		collapse = false;
-		for (int r=0; r<_mem_regions.size(); r++) {
-		vector <_mem_allocation_t> &mem_region = _mem_regions[r];
-			for (int i=0; i<mem_region.size()-1; i++) {
-				if (mem_region[i]._nfree && mem_region[i+1]._nfree) {
-					mem_region[i]._nfree += mem_region[i+1]._nfree;
-					mem_region.erase(mem_region.begin() + i+1);
-					collapse = true;
-					break;
-				}
-			}
+	next = _free_by_addr.lower_bound(start);
+	if (next != _free_by_addr.begin()) {
+		auto prev = std::prev(next);
+		if (
+			prev->second._region == run._region &&
+			prev->first + (_blk_size * prev->second._nblks) == start
+		) {
+			start = prev->first;
+			run._nblks += prev->second._nblks;
+			_remove_free(prev);
 		}
-	} while (collapse);
+	}
 
+	_insert_free(start, run);
+}
+
+void	BlkMemMgr::GetStats(Stats &stats) {
+
+	std::lock_guard <std::mutex> guard(_mutex);
+
+	stats.pool_blks = 0;
+	for (int r=0; r<_mem_region_sizes.size(); r++) {
+		stats.pool_blks += _mem_region_sizes[r];
+	}
+	stats.max_blks = _mem_size_max;
+
+	stats.used_blks = 0;
+	for (auto itr = _used.cbegin(); itr != _used.cend(); ++itr) {
+		stats.used_blks += itr->second._nblks;
+	}
+	stats.free_blks = stats.pool_blks - stats.used_blks;
+
+	stats.largest_free_run = _free_by_size.empty() ? 
+		0 : _free_by_size.rbegin()->first;
+	stats.num_free_runs = _free_by_addr.size();
+	stats.num_allocs = _used.size();
+	stats.num_alloc_calls = _num_alloc_calls;
+	stats.num_alloc_failures = _num_alloc_failures;
+
+	stats.huge_page_blks = 0;
+	for (int r=0; r<_mem_region_sizes.size(); r++) {
+		if (_region_info[r]._huge) stats.huge_page_blks += _mem_region_sizes[r];
+	}
+	stats.numa_nodes = _numa_nodes;
 }
@@ -1,12 +1,19 @@
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <functional>
 #include <stdio.h>
 #include <cstring>
+#include <cstdint>
 #include "vapor/VAssert.h"
 #include <cfloat>
 #include <vector>
 #include <map>
 #include <type_traits>
+#include <vapor/CFuncs.h>
+#include <vapor/EasyThreads.h>
+#include <vapor/FileUtils.h>
 #include <vapor/GeoUtil.h>
 #include <vapor/VDCNetCDF.h>
 #include <vapor/DCWRF.h>
@@ -389,6 +396,61 @@ void downsample(
 }
 
 
+//
+// Downsample 'nplanes' consecutive planes (arrays of dimension 
+// inDims.size() - 1, ignoring the slowest varying dimension) from 
+// 'signalIn' into 'signalOut', splitting the planes across 'nthreads' 
+// threads
+//
+template <typename T>
+void downsample_planes_par(
+	int nthreads,
+	const T *signalIn, const vector <size_t> &inDims,
+	T *signalOut, const vector <size_t> &outDims,
+	size_t nplanes
+) {
+	VAssert(inDims.size() == 2 || inDims.size() == 3);
+	VAssert(inDims.size() == outDims.size());
+
+	vector <size_t> inPlaneDims(inDims.begin(), inDims.end()-1);
+	vector <size_t> outPlaneDims(outDims.begin(), outDims.end()-1);
+	size_t nIn = VProduct(inPlaneDims);
+	size_t nOut = VProduct(outPlaneDims);
+
+	vector <float> wgts;
+	downsample_compute_weights(inPlaneDims[0], outPlaneDims[0], wgts);
+
+	auto worker = [&](size_t first, size_t n) {
+		for (size_t i=first; i<first+n; i++) {
+			if (inPlaneDims.size() == 1) {
+				downsample1d(
+					signalIn + i*nIn, nIn, 1, signalOut + i*nOut, nOut, 1, wgts
+				);
+			}
+			else {
+				downsample2d(
+					signalIn + i*nIn, inPlaneDims, signalOut + i*nOut, 
+					outPlaneDims
+				);
+			}
+		}
+	};
+
+	if (nthreads > nplanes) nthreads = nplanes;
+	if (nthreads < 2) {
+		worker(0, nplanes);
+		return;
+	}
+
+	vector <std::thread> threads;
+	for (int t=0; t<nthreads; t++) {
+		int offset, length;
+		Wasp::EasyThreads::Decompose(nplanes, nthreads, t, &offset, &length);
+		threads.push_back(std::thread(worker, offset, length));
+	}
+	for (int t=0; t<threads.size(); t++) threads[t].join();
+}
+
 // Map voxel to block coordinates
 //
 void map_vox_to_blk(
@@ -536,19 +598,166 @@ void copy_block(
 	}
 }
 
+//
+// Same as copy_block() but the copy is split along the slowest axis
+// (2) across 'nthreads' threads. The region must be 3D.
+//
+template <class T>
+void copy_block_par(
+	int nthreads,
+	const T *src, 
+	T *dst, 
+	const vector <size_t> &min, 
+	const vector <size_t> &max, 
+	const vector <size_t> &bs, 
+	const vector <size_t> &grid_min,
+	const vector <size_t> &grid_max
+) {
+	VAssert(min.size() == 3);
+
+	size_t nz = max[2] - min[2] + 1;
+	if (nthreads > nz) nthreads = nz;
+	if (nthreads < 2) {
+		copy_block(src, dst, min, max, bs, grid_min, grid_max);
+		return;
+	}
+
+	size_t slice_size = (max[0] - min[0] + 1) * (max[1] - min[1] + 1);
+
+	vector <std::thread> threads;
+	for (int t=0; t<nthreads; t++) {
+		int offset, length;
+		Wasp::EasyThreads::Decompose(nz, nthreads, t, &offset, &length);
+
+		vector <size_t> tmin = min;
+		vector <size_t> tmax = max;
+		tmin[2] = min[2] + offset;
+		tmax[2] = tmin[2] + length - 1;
+		const T *tsrc = src + offset * slice_size;
+
+		threads.push_back(std::thread([=]() {
+			copy_block(tsrc, dst, tmin, tmax, bs, grid_min, grid_max);
+		}));
+	}
+	for (int t=0; t<threads.size(); t++) threads[t].join();
+}
+
+//
+// Copy a subregion of a (possibly blocked) source array into a blocked grid. 
+//
+// src : pointer to entire (contiguous) source array
+// swap : if true, reverse the byte order of each value
+// dst : pointer to blocked grid
+// dims : dimensions of source array (in voxels)
+// src_bs : block size of source array (in voxels). If all ones the
+// source is not blocked
+// bs : block size of destination grid (in voxels)
+// grid_min : min coordinates of destination grid within source (in voxels)
+// grid_max : max coordinates of destination grid within source (in voxels)
+//
+// NaNs are replaced with infinity as by _sanitizeFloats()
+//
+void copy_mapped_block(
+	const float *src, 
+	bool swap,
+	float *dst, 
+	const vector <size_t> &dims, 
+	const vector <size_t> &src_bs, 
+	const vector <size_t> &bs, 
+	const vector <size_t> &grid_min,
+	const vector <size_t> &grid_max
+) {
+	const int ndim = 3;
+	VAssert(dims.size() <= ndim);
+	VAssert(dims.size() == src_bs.size());
+	VAssert(dims.size() == bs.size());
+	VAssert(dims.size() == grid_min.size());
+	VAssert(dims.size() == grid_max.size());
+
+	vector <size_t> dims3(ndim, 1);
+	vector <size_t> src_bs3(ndim, 1);
+	vector <size_t> bs3(ndim, 1);
+	vector <size_t> grid_min3(ndim, 0);
+	vector <size_t> grid_max3(ndim, 0);
+	for (int i=0; i<dims.size(); i++) {
+		dims3[i] = dims[i];
+		src_bs3[i] = src_bs[i];
+		bs3[i] = bs[i];
+		grid_min3[i] = grid_min[i];
+		grid_max3[i] = grid_max[i];
+		VAssert(grid_max3[i] < dims3[i]);
+	}
+
+	// An unblocked source is a single block
+	//
+	if (VProduct(src_bs3) == 1) src_bs3 = dims3;
+
+	vector <size_t> src_bdims3;	// dimensions of source array in blocks
+	vector <size_t> bdims3;	// dimensions of destination grid in blocks
+	for (int i=0; i<ndim; i++) {
+		src_bdims3.push_back(((dims3[i] - 1) / src_bs3[i]) + 1);
+		bdims3.push_back(((grid_max3[i] - grid_min3[i]) / bs3[i]) + 1);
+	}
+
+	size_t src_block_size = VProduct(src_bs3);
+	size_t block_size = VProduct(bs3);
+
+	for (size_t k=grid_min3[2]; k<=grid_max3[2]; k++) {
+		size_t dst_k_b = (k - grid_min3[2]) / bs3[2];
+		size_t dst_k = (k - grid_min3[2]) % bs3[2];
+		size_t src_k_b = k / src_bs3[2];
+		size_t src_k = k % src_bs3[2];
+
+		for (size_t j=grid_min3[1]; j<=grid_max3[1]; j++) {
+			size_t dst_j_b = (j - grid_min3[1]) / bs3[1];
+			size_t dst_j = (j - grid_min3[1]) % bs3[1];
+			size_t src_j_b = j / src_bs3[1];
+			size_t src_j = j % src_bs3[1];
+
+			// Copy runs of the row that fall within a single source
+			// block and a single destination block
+			//
+			for (size_t i=grid_min3[0]; i<=grid_max3[0]; ) {
+				size_t dst_i_b = (i - grid_min3[0]) / bs3[0];
+				size_t dst_i = (i - grid_min3[0]) % bs3[0];
+				size_t src_i_b = i / src_bs3[0];
+				size_t src_i = i % src_bs3[0];
+				size_t n = std::min(bs3[0] - dst_i, grid_max3[0] - i + 1);
+				n = std::min(n, src_bs3[0] - src_i);
+
+				float *dstptr = dst + 
+					(dst_k_b * bdims3[0]*bdims3[1] + 
+					dst_j_b * bdims3[0] + dst_i_b) * block_size +
+					dst_k * bs3[0]*bs3[1] + dst_j*bs3[0] + dst_i;
+				const float *srcptr = src + 
+					(src_k_b * src_bdims3[0]*src_bdims3[1] + 
+					src_j_b * src_bdims3[0] + src_i_b) * src_block_size +
+					src_k * src_bs3[0]*src_bs3[1] + src_j*src_bs3[0] + src_i;
+
+				for (size_t ii=0; ii<n; ii++) {
+					uint32_t u;
+					memcpy(&u, srcptr + ii, sizeof(u));
+					if (swap) {
+						u = (u >> 24) | ((u >> 8) & 0xff00) | 
+							((u << 8) & 0xff0000) | (u << 24);
+					}
+					float v;
+					memcpy(&v, &u, sizeof(v));
+					if (std::isnan(v)) v = std::numeric_limits<float>::infinity();
+					dstptr[ii] = v;
+				}
+				i += n;
+			}
+		}
+	}
+}
+
 bool is_blocked(const vector <size_t> &bs) {
 	return(
 		! std::all_of(bs.cbegin(), bs.cend(), [] (size_t i) {return i == 1;})
 	);
 }
 
-// Is string a number?
-//
-bool is_int(std::string str) {
-	if (! str.empty() && str[0] == '-') str.erase(0,1);
-	return str.find_first_not_of("0123456789") == std::string::npos;
-}
-
 
 template< typename T, enable_if_t<std::is_floating_point<T>::value, int> = 0 >
 void _sanitizeFloats(T *buffer, size_t n) {
@@ -583,6 +792,8 @@ DataMgr::DataMgr(
 	_format = format;
 	_nthreads = nthreads;
 	_mem_size = mem_size;
+	_pagePolicy = BlkMemMgr::PAGES_DEFAULT;
+	_numaPolicy = BlkMemMgr::NUMA_DEFAULT;
 
 	if (! _mem_size) _mem_size = 100;
 
@@ -592,7 +803,7 @@ DataMgr::DataMgr(
 
 	_PipeLines.clear();
 
-	_regionsList.clear();
+	_regionsList.Clear();
 
 	_varInfoCacheSize_T.Clear();
 	_varInfoCacheDouble.Clear();
@@ -604,6 +815,19 @@ DataMgr::DataMgr(
 	_proj4String.clear();
 	_proj4StringDefault.clear();
 	_bs = {64,64,64};
+
+	_prefetchShutdown = false;
+	_prefetchNewFrame = false;
+	_prefetchEpoch = 0;
+	_prefetchEpochPrev = 0;
+
+	_openTs = 0;
+	_openLevel = 0;
+	_openLod = 0;
+
+	_traceFP = NULL;
+	_traceEvents = 0;
+	ResetCacheStats();
 }
 
 
@@ -611,6 +835,11 @@ DataMgr::~DataMgr(
 ) {
 	SetDiagMsg("DataMgr::~DataMgr()");
 
+	_stopPrefetch();
+
+	_saveInfoCache();
+	_closeTrace();
+
 	if (_dc) delete _dc;
 	_dc = NULL;
 
@@ -652,6 +881,55 @@ int DataMgr::_parseOptions(vector <string> &options) {
 		if (options[i] == "-vertical_xform") {
 			_doTransformVertical = true;
 		}
+		else if (options[i] == "-info_cache") {
+			i++;
+			if (i>=options.size()) {
+				ok = false;
+			}
+			else {
+				_infoCachePath = options[i];
+			}
+		}
+		else if (options[i] == "-pool_pages") {
+			i++;
+			if (
+				i>=options.size() || 
+				! BlkMemMgr::ParsePagePolicy(options[i], _pagePolicy)
+			) {
+				ok = false;
+			}
+		}
+		else if (options[i] == "-pool_numa") {
+			i++;
+			if (
+				i>=options.size() || 
+				! BlkMemMgr::ParseNumaPolicy(options[i], _numaPolicy)
+			) {
+				ok = false;
+			}
+		}
+		else if (options[i] == "-trace") {
+			i++;
+			if (i>=options.size()) {
+				ok = false;
+			}
+			else {
+				_tracePath = options[i];
+			}
+		}
+		else if (options[i] == "-cache_policy") {
+			i++;
+			RegionCache::EvictionPolicy policy;
+			if (
+				i>=options.size() || 
+				! RegionCache::ParseEvictionPolicy(options[i], policy)
+			) {
+				ok = false;
+			}
+			else {
+				_regionsList.SetEvictionPolicy(policy);
+			}
+		}
 		else {
 			newOptions.push_back(options[i]);
 		}
@@ -671,13 +949,33 @@ int DataMgr::Initialize(
 	const vector <string> &files, const std::vector <string> &options
 ) {
 
+	CancelPrefetch();
+	CancelRefinement();
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
+	// Persist what we learned about the previous data set, if any
+	//
+	_saveInfoCache();
+	_infoCachePath.clear();
+	_infoCacheFingerprint.clear();
+	_closeTrace();
+	_tracePath.clear();
+
 	vector <string> deviceOptions = options;
 	int rc = _parseOptions(deviceOptions);
 	if (rc<0) return(-1);
 
+	if (! _tracePath.empty()) _openTrace();
+
 	Clear();
 	if (_dc) delete _dc;
 
+	_varInfoCacheSize_T.Clear();
+	_varInfoCacheDouble.Clear();
+	_varInfoCacheVoidPtr.Clear();
+	_blkExtsCache.clear();
+
 	_dc = NULL;
 	if (files.empty()) {
 		SetErrMsg("Empty file list");
@@ -735,6 +1033,11 @@ int DataMgr::Initialize(
 		SetErrMsg("Failed to get time coordinates");
 		return(-1);
 	}
+
+	if (! _infoCachePath.empty()) {
+		_infoCacheFingerprint = _getInfoCacheFingerprint(files);
+		_loadInfoCache();
+	}
 	return(0);
 }
 
@@ -796,6 +1099,8 @@ vector <string> DataMgr::GetDataVarNames() const {
 vector <string> DataMgr::GetDataVarNames(int ndim) const {
 	VAssert(_dc);
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
 	if (_dataVarNamesCache[ndim].size()) {
 		return(_dataVarNamesCache[ndim]);
 	}
@@ -1020,6 +1325,9 @@ Grid *DataMgr::GetVariable (
 		ts,varname.c_str(), level, lod, lock
 	);
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+	_prefetchNotify(ts, varname);
+
 	int rc = _level_correction(varname, level);
 	if (rc<0) return(NULL);
 
@@ -1049,6 +1357,9 @@ Grid *DataMgr::GetVariable (
 		vector_to_string(max).c_str(), lock
 	);
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+	_prefetchNotify(ts, varname);
+
 	int rc = _level_correction(varname, level);
 	if (rc<0) return(NULL);
 
@@ -1073,7 +1384,9 @@ Grid *DataMgr::GetVariable (
 		return (new RegularGrid());
 	}
 
-	return(DataMgr::GetVariable(ts, varname, level, lod, min_ui, max_ui));
+	return(DataMgr::GetVariable(
+		ts, varname, level, lod, min_ui, max_ui, lock
+	));
 
 }
 
@@ -1555,6 +1868,9 @@ Grid *DataMgr::GetVariable(
 		vector_to_string(max).c_str(), lock
 	);
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+	_prefetchNotify(ts, varname);
+
 	int rc = _level_correction(varname, level);
 	if (rc<0) return(NULL);
 
@@ -1594,6 +1910,8 @@ int DataMgr::GetVariableExtents(
 		ts,varname.c_str(), level, lod
 	);
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
 	min.clear();
 	max.clear();
 
@@ -1644,8 +1962,41 @@ int DataMgr::GetDataRange(
 ) {
 	SetDiagMsg("DataMgr::GetDataRange(%d,%s)", ts, varname.c_str());
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
+	int rc = _level_correction(varname, level);
+	if (rc<0) return(-1);
+
+	rc = _lod_correction(varname, lod);
+	if (rc<0) return(-1);
+
+	// If the range of every block is known the range of the variable
+	// can be found without reading it. Summaries describe the native
+	// data, so they can't be used for coarsened or approximated data
+	//
+	vector <size_t> bdims;
+	vector <double> bmins, bmaxs;
+	vector <unsigned char> missing;
+	if (level == -1 && lod == -1) {
+		rc = GetBlockSummaries(ts, varname, bdims, bmins, bmaxs, missing);
+		if (rc<0) return(-1);
+	}
+
+	bool found = false;
+	for (size_t i=0; i<missing.size(); i++) {
+		if (missing[i] == 2) continue;
+
+		if (! found) {
+			range = {bmins[i], bmaxs[i]};
+			found = true;
+		}
+		if (bmins[i] < range[0]) range[0] = bmins[i];
+		if (bmaxs[i] > range[1]) range[1] = bmaxs[i];
+	}
+	if (found) return(0);
+
     vector <double> min, max;
-	int rc = GetVariableExtents(ts, varname, level, lod, min, max);
+	rc = GetVariableExtents(ts, varname, level, lod, min, max);
 	if (rc<0) return(-1);
 
 	return(GetDataRange(ts, varname, level, lod, min, max, range));
@@ -1662,6 +2013,8 @@ int DataMgr::GetDataRange(
 ) {
 	SetDiagMsg("DataMgr::GetDataRange(%d,%s)", ts, varname.c_str());
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
 	range = {0.0, 0.0};
 
 	int rc = _level_correction(varname, level);
@@ -1683,13 +2036,11 @@ int DataMgr::GetDataRange(
 
 	// See if we've already cache'd it.
 	//
-	ostringstream oss;
-	oss << "VariableRange";
-	oss << vector_to_string(min_ui);
-	oss << vector_to_string(max_ui);
-	string key = oss.str();
+	vector <size_t> ext = min_ui;
+	ext.insert(ext.end(), max_ui.begin(), max_ui.end());
+	VarInfoKey key("VariableRange", ts, varname, level, lod, ext);
 
-	if (_varInfoCacheDouble.Get(ts, varname, level, lod, key, range)) {
+	if (_varInfoCacheDouble.Get(key, range)) {
 		VAssert(range.size() == 2);
 		return(0);
 	}
@@ -1705,7 +2056,67 @@ int DataMgr::GetDataRange(
 
 	delete sg;
 
-	_varInfoCacheDouble.Set(ts, varname, level, lod, key, range);
+	_varInfoCacheDouble.Set(key, range);
+
+	return(0);
+}
+
+int DataMgr::GetBlockSummaries(
+	size_t ts, string varname, vector <size_t> &bdims,
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+) {
+	SetDiagMsg("DataMgr::GetBlockSummaries(%d,%s)", ts, varname.c_str());
+
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
+	bdims.clear();
+	mins.clear();
+	maxs.clear();
+	missing.clear();
+
+	// Derived variables are never stored
+	//
+	if (_getDerivedVar(varname)) return(0);
+
+	// Summaries are independent of refinement level and lod. Cache them
+	// as a single vector of mins, followed by maxs, followed by missing 
+	// value states
+	//
+	string key = "BlockSummaries";
+	vector <double> values;
+	if (
+		_varInfoCacheSize_T.Get(ts, varname, 0, 0, key, bdims) &&
+		_varInfoCacheDouble.Get(ts, varname, 0, 0, key, values)
+	) {
+		size_t n = values.size() / 3;
+		mins.assign(values.begin(), values.begin() + n);
+		maxs.assign(values.begin() + n, values.begin() + 2*n);
+		for (size_t i=2*n; i<values.size(); i++) {
+			missing.push_back((unsigned char) values[i]);
+		}
+		return(0);
+	}
+
+	// Acquire the DC without holding _mutex (see _get_region_from_fs())
+	//
+	size_t depth = _mutex.Release();
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	_mutex.Reacquire(depth);
+
+	int fd = _dc->OpenVariableRead(ts, varname, -1, -1);
+	if (fd < 0) return(-1);
+
+	int rc = _dc->ReadBlockSummaries(fd, bdims, mins, maxs, missing);
+	(void) _dc->CloseVariable(fd);
+	if (rc<0) return(-1);
+
+	values = mins;
+	values.insert(values.end(), maxs.begin(), maxs.end());
+	values.insert(values.end(), missing.begin(), missing.end());
+
+	_varInfoCacheSize_T.Set(ts, varname, 0, 0, key, bdims);
+	_varInfoCacheDouble.Set(ts, varname, 0, 0, key, values);
 
 	return(0);
 }
@@ -1829,6 +2240,8 @@ bool DataMgr::VariableExists(
 
 	if (varname.empty()) return (false);
 
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
     // disable error reporting
     //
     bool enabled = EnableErrMsg(false);
@@ -1910,6 +2323,9 @@ bool DataMgr::IsVariableDerived(string name) const {
 }
 
 int DataMgr::AddDerivedVar(DerivedDataVar *derivedVar) {
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
 	string varname = derivedVar->GetName();
 
 	if (_dvm.HasVar(varname)) {
@@ -1932,6 +2348,8 @@ int DataMgr::AddDerivedVar(DerivedDataVar *derivedVar) {
 }
 
 void DataMgr::RemoveDerivedVar(string varname) {
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	std::lock_guard <ReleasableMutex> guard(_mutex);
 
 	if (! _dvm.HasVar(varname)) return;
 
@@ -1951,17 +2369,19 @@ void DataMgr::RemoveDerivedVar(string varname) {
 }
 
 void	DataMgr::Clear() {
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	std::lock_guard <ReleasableMutex> guard(_mutex);
 
 	_PipeLines.clear();
 
-	list <region_t>::iterator itr;
+	RegionCache::iterator itr;
 	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
 		const region_t &region = *itr;
 
 		if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
 			
 	}
-	_regionsList.clear();
+	_regionsList.Clear();
 
 }
 
@@ -1972,6 +2392,8 @@ void	DataMgr::UnlockGrid(
 	const Grid *rg
 ) {
 	SetDiagMsg("DataMgr::UnlockGrid()");
+
+	std::lock_guard <ReleasableMutex> guard(_mutex);
 	const vector <float *> &blks = rg->GetBlks();
 	if (blks.size()) _unlock_blocks(blks[0]);
 
@@ -1982,100 +2404,529 @@ void	DataMgr::UnlockGrid(
 	}
 }
 
-size_t DataMgr::GetNumDimensions(string varname) const {
-	VAssert(_dc);
-
-	DC::DataVar dvar;
-	bool status = GetDataVarInfo(varname, dvar);
+void DataMgr::Prefetch(
+	size_t ts, string varname, int level, int lod,
+	std::vector <double> min, std::vector <double> max
+) {
+	VAssert(min.size() == max.size());
 
-	if (status) {
+	SetDiagMsg(
+		"DataMgr::Prefetch(%d, %s, %d, %d)", ts, varname.c_str(), level, lod
+	);
 
-		DC::Mesh m;
-		status = GetMesh(dvar.GetMeshName(), m);
-		if (! status) return(0);
+	std::unique_lock <std::mutex> lock(_prefetchMutex);
 
-		return(m.GetDimNames().size());
+	// The first request following a foreground read starts a new 
+	// frame. Regions used during the previous frame are protected from
+	// eviction by the prefetch thread
+	//
+	if (_prefetchNewFrame) {
+		_prefetchEpochPrev = _prefetchEpoch;
+		_prefetchEpoch = _regionsList.Clock();
+		_prefetchNewFrame = false;
 	}
 
-	DC::CoordVar cvar;
-	status = GetCoordVarInfo(varname, cvar);
-	if (status) return (cvar.GetDimNames().size());
-
-	return(0);
-}
-
-size_t DataMgr::GetVarTopologyDim(string varname) const {
-	VAssert(_dc);
+	// Discard queued requests that are no longer useful: a different
+	// region of interest, or a time step on the wrong side of the 
+	// play head.
+	//
+	auto sign = [](long d) { return((d > 0) - (d < 0)); };
+	auto pitr = _prefetchPlayhead.find(varname);
+	bool havePlayhead = pitr != _prefetchPlayhead.end();
+	long playhead = havePlayhead ? (long) pitr->second : 0;
+
+	for (auto itr = _prefetchQueue.begin(); itr != _prefetchQueue.end(); ) {
+		const prefetch_t &q = *itr;
+		if (q.varname != varname) { ++itr; continue; }
+
+		if (
+			q.level != level || q.lod != lod || q.min != min || q.max != max ||
+			(havePlayhead && 
+			sign((long) q.ts - playhead) != sign((long) ts - playhead))
+		) {
+			itr = _prefetchQueue.erase(itr);
+		}
+		else if (q.ts == ts) {
+			return;	// already queued
+		}
+		else {
+			++itr;
+		}
+	}
 
-	DC::DataVar var;
-	bool status = GetDataVarInfo(varname, var);
-	if (! status) return(0);
+	const size_t maxQueue = 32;
+	while (_prefetchQueue.size() >= maxQueue) _prefetchQueue.pop_front();
 
-	string mname = var.GetMeshName();
+	prefetch_t request = {ts, varname, level, lod, min, max};
+	_prefetchQueue.push_back(request);
 
-	DC::Mesh mesh;
-	status = GetMesh(mname, mesh);
-	if (! status) return(0);
+	if (! _prefetchThread.joinable()) {
+		_prefetchShutdown = false;
+		_prefetchThread = std::thread(&DataMgr::_prefetchWorker, this);
+	}
 
-	return(mesh.GetTopologyDim());
+	lock.unlock();
+	_prefetchCond.notify_one();
 }
 
+void DataMgr::CancelPrefetch() {
+	std::lock_guard <std::mutex> lock(_prefetchMutex);
+	_prefetchQueue.clear();
+}
 
-template <typename T>
-T	*DataMgr::_get_region_from_cache(
-	size_t ts,
-	string varname,
-	int level,
-	int lod,
-	const vector <size_t> &bmin,
-	const vector <size_t> &bmax,
-	bool	lock
+Grid *DataMgr::GetVariableProgressive(
+	size_t ts, string varname, int level, int lod,
+	vector <double> min, vector <double> max,
+	RefineCallback callback, bool lock
 ) {
+	VAssert(min.size() == max.size());
 
-	list <region_t>::iterator itr;
-	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
-		region_t &region = *itr;
-
-		if (region.ts == ts &&
-			region.varname.compare(varname) == 0 &&
-			region.level == level &&
-			region.lod == lod &&
-			region.bmin == bmin &&
-			region.bmax == bmax) {
-
-			// Increment the lock counter
-			region.lock_counter += lock ? 1 : 0;
-
-			// Move region to front of list
-			region_t tmp_region = region;
-			_regionsList.erase(itr);
-			_regionsList.push_back(tmp_region);
-
-			SetDiagMsg(
-				"DataMgr::_get_region_from_cache() - data in cache %xll\n",
-				 tmp_region.blks
-			);
-			return((T *) tmp_region.blks);
+	SetDiagMsg(
+		"DataMgr::GetVariableProgressive(%d, %s, %d, %d, %s, %s, %d)",
+		ts,varname.c_str(), level, lod, vector_to_string(min).c_str(),
+		vector_to_string(max).c_str(), lock
+	);
+
+	// Start from the coarsest approximation
+	//
+	int level0 = 0;
+	int lod0 = 0;
+	{
+		std::lock_guard <ReleasableMutex> guard(_mutex);
+		if (_level_correction(varname, level) < 0) return(NULL);
+		if (_lod_correction(varname, lod) < 0) return(NULL);
+		if (_level_correction(varname, level0) < 0) return(NULL);
+		if (_lod_correction(varname, lod0) < 0) return(NULL);
+	}
+
+	// Supersede earlier requests, including any refinement in progress
+	//
+	size_t generation;
+	{
+		std::lock_guard <std::mutex> plock(_prefetchMutex);
+		generation = ++_refineGeneration[varname];
+		for (auto itr = _refineQueue.begin(); itr != _refineQueue.end(); ) {
+			if (itr->varname == varname) itr = _refineQueue.erase(itr);
+			else ++itr;
 		}
 	}
 
-	return(NULL);
-}
+	Grid *rg;
+	if (min.empty()) {
+		rg = GetVariable(ts, varname, level0, lod0, lock);
+	}
+	else {
+		rg = GetVariable(ts, varname, level0, lod0, min, max, lock);
+	}
+	if (! rg) return(NULL);
 
-template <typename T>
-int DataMgr::_get_unblocked_region_from_fs(
-	size_t ts, string varname, int level, int lod,
-	const vector <size_t> &grid_dims, 
-	const vector <size_t> &grid_bs, 
-	const vector <size_t> &grid_min, 
-	const vector <size_t> &grid_max, 
-	T *blks
-) {
+	// Queue one refinement per step in level and lod, advancing both 
+	// until the requested resolution is reached
+	//
+	std::unique_lock <std::mutex> plock(_prefetchMutex);
+	if (_refineGeneration[varname] != generation) return(rg);
 
-	int fd = _openVariableRead(ts, varname, level, lod);
-    if (fd < 0) return(fd);
+	while (level0 < level || lod0 < lod) {
+		if (level0 < level) level0++;
+		if (lod0 < lod) lod0++;
 
-	T *region = new T[VProduct(Dims(grid_min, grid_max))];
+		prefetch_t request = {
+			ts, varname, level0, lod0, min, max, callback, lock, generation
+		};
+		_refineQueue.push_back(request);
+	}
+
+	if (! _prefetchThread.joinable()) {
+		_prefetchShutdown = false;
+		_prefetchThread = std::thread(&DataMgr::_prefetchWorker, this);
+	}
+
+	plock.unlock();
+	_prefetchCond.notify_one();
+
+	return(rg);
+}
+
+void DataMgr::CancelRefinement() {
+	std::lock_guard <std::mutex> lock(_prefetchMutex);
+	_refineQueue.clear();
+	for (auto itr = _refineGeneration.begin(); itr!=_refineGeneration.end(); ++itr) {
+		itr->second++;
+	}
+}
+
+// Caller must hold _prefetchMutex
+//
+bool DataMgr::_refineCurrent(const prefetch_t &request) {
+	auto itr = _refineGeneration.find(request.varname);
+	return(
+		itr != _refineGeneration.end() && itr->second == request.generation
+	);
+}
+
+namespace {
+
+// The DataMgr whose refinement request the calling thread is servicing, 
+// if any
+//
+thread_local const DataMgr *refineOwner = NULL;
+
+};
+
+bool DataMgr::_refining() const {
+	return(refineOwner == this);
+}
+
+void DataMgr::_refine(const prefetch_t &request) {
+
+	// Refinements don't move the prefetch playhead; the application
+	// asked for the time step when it requested the coarse approximation
+	//
+	refineOwner = this;
+
+	Grid *rg;
+	if (request.min.empty()) {
+		rg = GetVariable(
+			request.ts, request.varname, request.level, request.lod, 
+			request.lock
+		);
+	}
+	else {
+		rg = GetVariable(
+			request.ts, request.varname, request.level, request.lod,
+			request.min, request.max, request.lock
+		);
+	}
+
+	refineOwner = NULL;
+
+	std::unique_lock <std::mutex> lock(_prefetchMutex);
+
+	// Give up on the rest of the request if the read failed
+	//
+	if (! rg) {
+		for (auto itr = _refineQueue.begin(); itr != _refineQueue.end(); ) {
+			if (
+				itr->varname == request.varname && 
+				itr->generation == request.generation
+			) {
+				itr = _refineQueue.erase(itr);
+			}
+			else ++itr;
+		}
+		return;
+	}
+
+	// Superseded while we were reading
+	//
+	if (! _refineCurrent(request) || ! request.callback) {
+		lock.unlock();
+		if (request.lock) UnlockGrid(rg);
+		delete rg;
+		return;
+	}
+
+	lock.unlock();
+	request.callback(rg, request.level, request.lod);
+}
+
+namespace {
+
+// The DataMgr whose prefetch request the calling thread is servicing, 
+// if any
+//
+thread_local const DataMgr *prefetchOwner = NULL;
+
+};
+
+bool DataMgr::_prefetching() const {
+	return(prefetchOwner == this);
+}
+
+void DataMgr::_prefetchNotify(size_t ts, string varname) {
+	if (_prefetching() || _refining()) return;
+
+	std::lock_guard <std::mutex> lock(_prefetchMutex);
+	_prefetchPlayhead[varname] = ts;
+	_prefetchNewFrame = true;
+}
+
+void DataMgr::_stopPrefetch() {
+	{
+		std::lock_guard <std::mutex> lock(_prefetchMutex);
+		_prefetchQueue.clear();
+		_refineQueue.clear();
+		_prefetchShutdown = true;
+	}
+	_prefetchCond.notify_all();
+
+	if (_prefetchThread.joinable()) _prefetchThread.join();
+}
+
+// Service refinement and prefetch requests one at a time. Reads are 
+// serialized with the application's reads by _dcMutex; the data 
+// collection readers are not reentrant, so there is nothing to gain from 
+// more threads.
+//
+void DataMgr::_prefetchWorker() {
+
+	// Failed prefetches are not errors
+	//
+	EnableErrMsgThread(false);
+
+	for (;;) {
+		prefetch_t request;
+		{
+			std::unique_lock <std::mutex> lock(_prefetchMutex);
+			_prefetchCond.wait(lock, [this] {
+				return(
+					_prefetchShutdown || ! _prefetchQueue.empty() ||
+					! _refineQueue.empty()
+				);
+			});
+			if (_prefetchShutdown) return;
+
+			// Refinements are for data the application is displaying,
+			// and are read like any other request
+			//
+			if (! _refineQueue.empty()) {
+				request = _refineQueue.front();
+				_refineQueue.pop_front();
+				if (! _refineCurrent(request)) continue;
+
+				lock.unlock();
+				_refine(request);
+				continue;
+			}
+
+			request = _prefetchQueue.front();
+			_prefetchQueue.pop_front();
+
+			// The application is already reading this time step
+			//
+			auto pitr = _prefetchPlayhead.find(request.varname);
+			if (
+				pitr != _prefetchPlayhead.end() && pitr->second == request.ts
+			) {
+				continue;
+			}
+		}
+
+		{
+			std::lock_guard <ReleasableMutex> guard(_mutex);
+			if (! _dc) continue;
+		}
+
+		prefetchOwner = this;
+
+		Grid *rg;
+		if (request.min.empty()) {
+			rg = GetVariable(
+				request.ts, request.varname, request.level, request.lod, false
+			);
+		}
+		else {
+			rg = GetVariable(
+				request.ts, request.varname, request.level, request.lod,
+				request.min, request.max, false
+			);
+		}
+		if (rg) delete rg;
+
+		prefetchOwner = NULL;
+	}
+}
+
+size_t DataMgr::GetNumDimensions(string varname) const {
+	VAssert(_dc);
+
+	DC::DataVar dvar;
+	bool status = GetDataVarInfo(varname, dvar);
+
+	if (status) {
+
+		DC::Mesh m;
+		status = GetMesh(dvar.GetMeshName(), m);
+		if (! status) return(0);
+
+		return(m.GetDimNames().size());
+	}
+
+	DC::CoordVar cvar;
+	status = GetCoordVarInfo(varname, cvar);
+	if (status) return (cvar.GetDimNames().size());
+
+	return(0);
+}
+
+size_t DataMgr::GetVarTopologyDim(string varname) const {
+	VAssert(_dc);
+
+	DC::DataVar var;
+	bool status = GetDataVarInfo(varname, var);
+	if (! status) return(0);
+
+	string mname = var.GetMeshName();
+
+	DC::Mesh mesh;
+	status = GetMesh(mname, mesh);
+	if (! status) return(0);
+
+	return(mesh.GetTopologyDim());
+}
+
+
+template <typename T>
+T	*DataMgr::_get_region_from_cache(
+	size_t ts,
+	string varname,
+	int level,
+	int lod,
+	const vector <size_t> &bmin,
+	const vector <size_t> &bmax,
+	bool	lock
+) {
+
+	// If another thread is reading the region wait for it to finish,
+	// then look again: the read may have failed
+	//
+	RegionCache::iterator itr;
+	for (;;) {
+		itr = _regionsList.Find(ts, varname, level, lod, bmin, bmax);
+		if (itr == _regionsList.end()) return(NULL);
+
+		if (! _is_pending(itr->blks)) break;
+
+		double t0 = Wasp::GetTime();
+		_wait_pending(itr->blks);
+		double t1 = Wasp::GetTime();
+		_countStats(ts, varname, [t0, t1](CacheCounters &c) {
+			c.pending_waits++;
+			c.lock_wait_time += t1 - t0;
+		});
+	}
+
+	region_t &region = *itr;
+	_countStats(ts, varname, [](CacheCounters &c) {c.hits++;});
+
+	// Increment the lock counter
+	region.lock_counter += lock ? 1 : 0;
+
+	// A prefetched region is no longer speculative once the application
+	// has asked for it
+	//
+	if (! _prefetching()) region.prefetched = false;
+
+	// Move region to most recently used position
+	_regionsList.Touch(itr);
+
+	SetDiagMsg(
+		"DataMgr::_get_region_from_cache() - data in cache %xll\n",
+		 region.blks
+	);
+	return((T *) region.blks);
+}
+
+// Copy a region out of a larger cached region that contains it, 
+// avoiding a read when the region of interest shrinks or a slice is
+// taken from a cached volume
+//
+template <typename T>
+T	*DataMgr::_get_region_from_superset(
+	size_t ts,
+	string varname,
+	int level,
+	int lod,
+	const vector <size_t> &bs,
+	const vector <size_t> &bmin,
+	const vector <size_t> &bmax,
+	bool	lock
+) {
+	RegionCache::iterator itr = _regionsList.FindContaining(
+		ts, varname, level, lod, bmin, bmax
+	);
+	if (itr == _regionsList.end()) return(NULL);
+
+	// Not worth waiting for
+	//
+	if (_is_pending(itr->blks)) return(NULL);
+
+	double t0 = Wasp::GetTime();
+
+	// Lock the source region so that making room for the copy can't 
+	// evict it
+	//
+	itr->lock_counter++;
+	T *blks = (T *) _alloc_region(
+		ts, varname, level, lod, bmin, bmax, bs, sizeof(T), lock, false
+	);
+	itr->lock_counter--;
+	if (! blks) return(NULL);
+
+	const region_t &src = *itr;
+	const T *src_blks = (const T *) src.blks;
+
+	// Pad to 3D. Blocks are stored with the X block index varying 
+	// fastest, so each row of blocks along X is contiguous in both
+	// regions
+	//
+	size_t block_size = 1;
+	vector <size_t> min(3,0), max(3,0), src_min(3,0), src_bdims(3,1);
+	for (int i=0; i<bmin.size(); i++) {
+		block_size *= bs[i];
+		min[i] = bmin[i];
+		max[i] = bmax[i];
+		src_min[i] = src.bmin[i];
+		src_bdims[i] = src.bmax[i] - src.bmin[i] + 1;
+	}
+	size_t row_size = (max[0] - min[0] + 1) * block_size;
+
+	T *dst = blks;
+	for (size_t z = min[2]; z <= max[2]; z++) {
+	for (size_t y = min[1]; y <= max[1]; y++) {
+		size_t offset = 
+			((z - src_min[2]) * src_bdims[1] + (y - src_min[1])) * 
+			src_bdims[0] + (min[0] - src_min[0]);
+
+		std::copy(
+			src_blks + offset * block_size, 
+			src_blks + offset * block_size + row_size, dst
+		);
+		dst += row_size;
+	}
+	}
+
+	if (! _prefetching()) itr->prefetched = false;
+	_regionsList.Touch(itr);
+
+	_countStats(ts, varname, [](CacheCounters &c) {c.superset_hits++;});
+
+	RegionCache::iterator ditr = _regionsList.Find(blks);
+	if (ditr != _regionsList.end()) {
+		_regionsList.SetCost(ditr, Wasp::GetTime() - t0);
+	}
+
+	SetDiagMsg(
+		"DataMgr::_get_region_from_superset() - data copied from %xll\n",
+		 src.blks
+	);
+	return(blks);
+}
+
+template <typename T>
+int DataMgr::_get_unblocked_region_from_fs(
+	size_t ts, string varname, int level, int lod,
+	const vector <size_t> &grid_dims, 
+	const vector <size_t> &grid_bs, 
+	const vector <size_t> &grid_min, 
+	const vector <size_t> &grid_max, 
+	T *blks
+) {
+
+	int fd = _openVariableRead(ts, varname, level, lod);
+    if (fd < 0) return(fd);
+
+	T *region = new T[VProduct(Dims(grid_min, grid_max))];
 
 	int nlevels = DataMgr::GetNumRefLevels(varname);
 
@@ -2102,19 +2953,31 @@ int DataMgr::_get_unblocked_region_from_fs(
 			file_max.push_back((int) weights[grid_max[i]] + 1 + roffset);
 		}
 
-		T *buf = new T[VProduct(Dims(file_min, file_max))];
-
-		rc = _readRegion(fd, file_min, file_max, buf);
-		if (rc<0) {
-			delete [] buf;
-			return(-1);
+		if (dims.size() > 1) {
+			rc = _get_downsampled_region_from_fs(
+				fd, file_min, file_max, grid_min, grid_max, region
+			);
+			if (rc<0) {
+				delete [] region;
+				return(-1);
+			}
 		}
+		else {
+			T *buf = new T[VProduct(Dims(file_min, file_max))];
 
-		downsample(
-			buf, Dims(file_min, file_max), region, Dims(grid_min, grid_max)
-		);
+			rc = _readRegion(fd, file_min, file_max, buf);
+			if (rc<0) {
+				delete [] buf;
+				delete [] region;
+				return(-1);
+			}
 
-		if (buf) delete [] buf;
+			downsample(
+				buf, Dims(file_min, file_max), region, Dims(grid_min, grid_max)
+			);
+
+			if (buf) delete [] buf;
+		}
 	}
 	else {
 		
@@ -2134,6 +2997,133 @@ int DataMgr::_get_unblocked_region_from_fs(
 	return(0);
 }
 
+namespace {
+
+// Upper bound on the size of the native resolution slabs read by 
+// _get_downsampled_region_from_fs()
+//
+const size_t downsampleSlabBytes = 64 * 1024 * 1024;
+
+};
+
+// Read the native resolution region (file_min, file_max) and 
+// downsample it to (grid_min, grid_max). Produces the same result as 
+// downsample(), but the native region is never held in memory in its 
+// entirety: it is read in slabs of planes along the slowest varying 
+// axis, each needed plane is downsampled as soon as it is read (in 
+// parallel), and output planes are interpolated from pairs of 
+// downsampled planes. Native planes that contribute to no output 
+// plane aren't read at all.
+//
+template <typename T>
+int DataMgr::_get_downsampled_region_from_fs(
+	int fd,
+	const vector <size_t> &file_min,
+	const vector <size_t> &file_max,
+	const vector <size_t> &grid_min,
+	const vector <size_t> &grid_max,
+	T *region
+) {
+	vector <size_t> inDims = Dims(file_min, file_max);
+	vector <size_t> outDims = Dims(grid_min, grid_max);
+	VAssert(inDims.size() >= 2);
+
+	int s = inDims.size() - 1;	// slowest varying axis
+	size_t nIn = inDims[s];
+	size_t nOut = outDims[s];
+	size_t inPlaneSize = VProduct(inDims) / nIn;
+	size_t outPlaneSize = VProduct(outDims) / nOut;
+
+	vector <float> wgts;
+	downsample_compute_weights(nIn, nOut, wgts);
+
+	// Native planes each output plane is interpolated from
+	//
+	vector <size_t> i0s(nOut), i1s(nOut);
+	vector <size_t> needed;
+	for (size_t k=0; k<nOut; k++) {
+		i0s[k] = (size_t) wgts[k];
+		i1s[k] = i0s[k] + 1 < nIn ? i0s[k] + 1 : i0s[k];
+		if (needed.empty() || needed.back() < i0s[k]) needed.push_back(i0s[k]);
+		if (needed.back() < i1s[k]) needed.push_back(i1s[k]);
+	}
+
+	size_t maxPlanes = downsampleSlabBytes / (inPlaneSize * sizeof(T));
+	if (maxPlanes < 1) maxPlanes = 1;
+
+	int nthreads = _nthreads > 0 ? _nthreads : EasyThreads::NProc();
+
+	T *slab = new T[std::min(maxPlanes, needed.size()) * inPlaneSize];
+
+	// Downsampled planes, indexed by native plane. Only planes still
+	// referenced by output planes that haven't been produced are kept
+	//
+	std::map <size_t, vector <T> > planes;
+
+	size_t k = 0;	// next output plane
+	size_t n = 0;	// next needed native plane
+	while (n < needed.size()) {
+
+		// Read a run of consecutive needed planes
+		//
+		size_t count = 1;
+		while (
+			n + count < needed.size() && count < maxPlanes &&
+			needed[n + count] == needed[n] + count
+		) {
+			count++;
+		}
+
+		vector <size_t> min = file_min;
+		vector <size_t> max = file_max;
+		min[s] = file_min[s] + needed[n];
+		max[s] = min[s] + count - 1;
+
+		int rc = _readRegion(fd, min, max, slab);
+		if (rc<0) {
+			delete [] slab;
+			return(-1);
+		}
+
+		vector <T> reduced(count * outPlaneSize);
+		vector <size_t> slabDims = inDims;
+		slabDims[s] = count;
+		vector <size_t> reducedDims = outDims;
+		reducedDims[s] = count;
+		downsample_planes_par(
+			nthreads, slab, slabDims, reduced.data(), reducedDims, count
+		);
+		for (size_t i=0; i<count; i++) {
+			planes[needed[n+i]].assign(
+				reduced.begin() + i*outPlaneSize, 
+				reduced.begin() + (i+1)*outPlaneSize
+			);
+		}
+		n += count;
+
+		// Emit every output plane whose native planes are now available
+		//
+		size_t last = needed[n-1];
+		for (; k<nOut && i1s[k] <= last; k++) {
+			const T *r0 = planes[i0s[k]].data();
+			const T *r1 = planes[i1s[k]].data();
+			float w = wgts[k] - i0s[k];
+			T *out = region + k*outPlaneSize;
+			for (size_t j=0; j<outPlaneSize; j++) {
+				out[j] = (r0[j] * (1.0 - w)) + (r1[j] * w);
+			}
+		}
+
+		if (k < nOut) {
+			planes.erase(planes.begin(), planes.lower_bound(i0s[k]));
+		}
+	}
+	VAssert(k == nOut);
+
+	delete [] slab;
+	return(0);
+}
+
 template <typename T>
 int DataMgr::_get_blocked_region_from_fs(
 	size_t ts, string varname, int level, int lod,
@@ -2155,6 +3145,26 @@ int DataMgr::_get_blocked_region_from_fs(
 	int fd = _openVariableRead(ts, varname, level, lod);
     if (fd < 0) return(fd);
 
+	// Uncompressed data can be copied straight from a memory mapped 
+	// view of the file into the region, bypassing the read buffers
+	//
+	const float *mapped = NULL;
+	bool swap = false;
+	std::vector <size_t> mapped_bs;
+	if (
+		std::is_same<T,float>::value && ! _getDerivedVar(varname) &&
+		file_dims == grid_dims && 
+		_dc->MapVariable(fd, mapped, swap, mapped_bs) &&
+		mapped_bs.size() == file_dims.size()
+	) {
+		copy_mapped_block(
+			mapped, swap, (float *) blks, file_dims, mapped_bs, grid_bs, 
+			grid_min, grid_max
+		);
+		(void) _closeVariable(fd); 
+		return(0);
+	}
+
 
 	std::vector <size_t> bmin = file_bmin;
 	std::vector <size_t> bmax = file_bmax;
@@ -2168,23 +3178,46 @@ int DataMgr::_get_blocked_region_from_fs(
 		bmax[2] = bmin[2];
 	}
 
+	// Slabs are double buffered: slab i+1 is read (and decompressed)
+	// while slab i is copied into the region by a team of threads.
+	// The DC can only read one slab at a time.
+	//
 	vector <size_t> file_min, file_max;
 	map_blk_to_vox(file_bs, bmin, bmax, file_min, file_max);
-	T *file_block = new T[VProduct(Dims(file_min,file_max))];
+	size_t slab_size = VProduct(Dims(file_min,file_max));
 
+	T *file_blocks[2] = {new T[slab_size], NULL};
+	if (nreads > 1) file_blocks[1] = new T[slab_size];
+
+	int nthreads = _nthreads > 0 ? _nthreads : EasyThreads::NProc();
+
+	std::thread copier;
+	int rc = 0;
 	for (size_t i=0; i<nreads; i++) {
 
+		T *file_block = file_blocks[i % 2];
+
 		map_blk_to_vox(file_bs, file_dims, bmin, bmax, file_min, file_max);
 
-		int rc = _readRegion(fd, file_min, file_max, file_block);
-		if (rc<0) {
-			delete [] file_block;
-			return(-1);
-		}
+		rc = _readRegion(fd, file_min, file_max, file_block);
 
-		copy_block(
-			file_block, blks, file_min, file_max, grid_bs, grid_min, grid_max
-		);
+		// Wait for the previous slab before reusing the copy thread.
+		//
+		if (copier.joinable()) copier.join();
+		if (rc<0) break;
+
+		if (nreads > 1) {
+			copier = std::thread(
+				copy_block_par<T>, nthreads, file_block, blks, file_min, 
+				file_max, grid_bs, grid_min, grid_max
+			);
+		}
+		else {
+			copy_block(
+				file_block, blks, file_min, file_max, grid_bs, grid_min, 
+				grid_max
+			);
+		}
 
 		// Increment along slowest axis (2)
 		// This is a no-op if less than 3 dimensions
@@ -2192,10 +3225,14 @@ int DataMgr::_get_blocked_region_from_fs(
 		bmin = IncrementCoords(file_bmin, file_bmax, bmin, 2);
 		bmax = IncrementCoords(file_bmin, file_bmax, bmax, 2);
 	}
+	if (copier.joinable()) copier.join();
 
-	(void) _closeVariable(fd); 
+	if (file_blocks[0]) delete [] file_blocks[0];
+	if (file_blocks[1]) delete [] file_blocks[1];
 
-	if (file_block) delete [] file_block;
+	if (rc<0) return(-1);
+
+	(void) _closeVariable(fd); 
 
 	return(0);
 }
@@ -2208,12 +3245,43 @@ T *DataMgr::_get_region_from_fs(
 	const vector <size_t> &grid_bmax, bool lock
 ) {
 
-	T *blks = (T *) _alloc_region(
+	// Reads are serialized. Give up _mutex while waiting for our turn 
+	// so that other threads may use the cache, and then check whether 
+	// the region was read while we waited.
+	//
+	double t0 = Wasp::GetTime();
+	size_t depth = _mutex.Release();
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	_mutex.Reacquire(depth);
+	double t1 = Wasp::GetTime();
+	_countStats(ts, varname, [t0, t1](CacheCounters &c) {
+		c.lock_wait_time += t1 - t0;
+	});
+
+	T *blks = _get_region_from_cache<T>(
+		ts, varname, level, lod, grid_bmin, grid_bmax, lock
+	);
+	if (blks) return(blks);
+
+	blks = _get_region_from_superset<T>(
+		ts, varname, level, lod, grid_bs, grid_bmin, grid_bmax, lock
+	);
+	if (blks) return(blks);
+
+	t0 = Wasp::GetTime();
+
+	// The region stays locked, so that it can't be evicted, and pending,
+	// so that other threads don't use it, until it has been read
+	//
+	blks = (T *) _alloc_region(
 		ts, varname, level, lod, grid_bmin, grid_bmax, grid_bs, 
-		sizeof(T), lock, false
+		sizeof(T), true, false
 	);
 	if (! blks) return(NULL);
 
+	_set_pending(blks, true);
+	depth = _mutex.Release();
+
 	vector <size_t> file_dims, file_bs;
 	int rc = GetDimLensAtLevel( varname, level, file_dims, file_bs);
 	VAssert(rc>=0);
@@ -2243,11 +3311,36 @@ T *DataMgr::_get_region_from_fs(
 		);
 				
 	}
+
+	_mutex.Reacquire(depth);
+	_set_pending(blks, false);
+
 	if (rc < 0) {
 		_free_region(ts,varname ,level,lod,grid_bmin,grid_bmax, true);
 		return(NULL);
 	}
 
+	if (! lock) _unlock_blocks(blks);
+
+	// Record how long the region took to produce for cost-aware eviction
+	//
+	t1 = Wasp::GetTime();
+	RegionCache::iterator itr = _regionsList.Find(blks);
+	if (itr != _regionsList.end()) {
+		_regionsList.SetCost(itr, t1 - t0);
+	}
+
+	size_t nbytes = sizeof(T);
+	for (int i=0; i<grid_bmin.size(); i++) {
+		nbytes *= (grid_bmax[i] - grid_bmin[i] + 1) * grid_bs[i];
+	}
+	_countStats(ts, varname, [t0, t1, nbytes](CacheCounters &c) {
+		c.misses++;
+		c.bytes_read += nbytes;
+		c.read_time += t1 - t0;
+	});
+	_trace("read_region", t0, t1, ts, varname, level, lod);
+
 	SetDiagMsg("DataMgr::GetGrid() - data read from fs\n");
 	return(blks);
 }
@@ -2274,6 +3367,11 @@ T *DataMgr::_get_region(
 	T *blks = _get_region_from_cache<T>(
 		ts, varname, level, lod, bmin, bmax, lock
 	);
+	if (! blks) {
+		blks = _get_region_from_superset<T>(
+			ts, varname, level, lod, bs, bmin, bmax, lock
+		);
+	}
 	if (! blks ) {
 
 		blks = (T *) _get_region_from_fs<T>(
@@ -2368,11 +3466,16 @@ void	*DataMgr::_alloc_region(
 	size_t mem_block_size;
 	if (! _blk_mem_mgr) {
 
-		mem_block_size = 1024 * 1024;
+		// Use a small allocation granularity. Regions vary from a few
+		// KB (coordinate arrays, 2D slices) to GBs, and a large block 
+		// size wastes most of the last block of each small region.
+		//
+		mem_block_size = 4 * 1024;
 
 		size_t num_blks = (_mem_size * 1024 * 1024) / mem_block_size;
 
 		BlkMemMgr::RequestMemSize(mem_block_size, num_blks);
+		BlkMemMgr::SetPoolPolicy(_pagePolicy, _numaPolicy);
 		_blk_mem_mgr = new BlkMemMgr();
 	}
 	mem_block_size = BlkMemMgr::GetBlkSize();
@@ -2392,7 +3495,14 @@ void	*DataMgr::_alloc_region(
 	void *blks;
 	while (! (blks = (void *) _blk_mem_mgr->Alloc(nblocks, fill))) {
 		if (! _free_lru()) {
-			SetErrMsg("Failed to allocate requested memory");
+			BlkMemMgr::Stats stats;
+			BlkMemMgr::GetStats(stats);
+			SetErrMsg(
+				"Failed to allocate requested memory (%lu blocks requested, "
+				"%lu of %lu blocks in use, largest free run %lu blocks)",
+				nblocks, stats.used_blks, stats.max_blks,
+				stats.largest_free_run
+			);
 			return(NULL);
 		}
 	}
@@ -2407,8 +3517,14 @@ void	*DataMgr::_alloc_region(
 	region.bmax = bmax;
 	region.lock_counter = lock ? 1 : 0;
 	region.blks = blks;
+	region.size = nblocks * mem_block_size;
+	region.cost = 0.0;
+	region.hits = 1;
+	region.priority = 0.0;
+	region.last_use = 0;
+	region.prefetched = _prefetching();
 
-	_regionsList.push_back(region);
+	_regionsList.Insert(region);
 
 	return(region.blks);
 }
@@ -2423,24 +3539,17 @@ void	DataMgr::_free_region(
 	bool forceFlag
 ) {
 
-	list <region_t>::iterator itr;
-	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
-		const region_t &region = *itr;
+	RegionCache::iterator itr = _regionsList.Find(
+		ts, varname, level, lod, bmin, bmax
+	);
+	if (itr == _regionsList.end()) return;
 
-		if (region.ts == ts &&
-			region.varname.compare(varname) == 0 &&
-			region.level == level &&
-			region.lod == lod &&
-			region.bmin == bmin &&
-			region.bmax == bmax)  {
+	const region_t &region = *itr;
 
-			if (region.lock_counter == 0 || forceFlag) {
-				if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
-				
-				_regionsList.erase(itr);
-				return;
-			}
-		}
+	if (region.lock_counter == 0 || forceFlag) {
+		if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
+		
+		_regionsList.Erase(itr);
 	}
 
 	return;
@@ -2449,7 +3558,7 @@ void	DataMgr::_free_region(
 
 void	DataMgr::_free_var(string varname) {
 
-	list <region_t>::iterator itr;
+	RegionCache::iterator itr;
 	for(itr = _regionsList.begin(); itr!=_regionsList.end(); ) {
 		const region_t &region = *itr;
 
@@ -2457,8 +3566,7 @@ void	DataMgr::_free_var(string varname) {
 
 			if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
 				
-			_regionsList.erase(itr);
-			itr = _regionsList.begin();
+			itr = _regionsList.Erase(itr);
 		}
 		else itr++;
 	}
@@ -2473,21 +3581,45 @@ void	DataMgr::_free_var(string varname) {
 bool	DataMgr::_free_lru(
 ) {
 
-	// The least recently used region is at the front of the list
+	// The eviction policy determines which unlocked region goes first.
+	// The prefetch thread may not evict the application's working set,
+	// nor other prefetched regions that haven't been used yet.
 	//
-	list <region_t>::iterator itr;
-	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
-		const region_t &region = *itr;
-
-		if (region.lock_counter == 0) {
-			if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
-			_regionsList.erase(itr);
-			return(true);
+	RegionCache::iterator itr;
+	if (_prefetching()) {
+		size_t epoch;
+		{
+			std::lock_guard <std::mutex> lock(_prefetchMutex);
+			epoch = _prefetchEpochPrev;
 		}
+		itr = _regionsList.Victim(epoch, true);
+	}
+	else {
+		itr = _regionsList.Victim();
 	}
 
 	// nothing to free
-	return(false);
+	if (itr == _regionsList.end()) return(false);
+
+	double t0 = Wasp::GetTime();
+
+	const region_t &region = *itr;
+	size_t ts = region.ts;
+	string varname = region.varname;
+	int level = region.level;
+	int lod = region.lod;
+	size_t size = region.size;
+
+	if (region.blks) _blk_mem_mgr->FreeMem(region.blks);
+	_regionsList.Evict(itr);
+
+	_countStats(ts, varname, [size](CacheCounters &c) {
+		c.evictions++;
+		c.bytes_evicted += size;
+	});
+	_trace("evict", t0, Wasp::GetTime(), ts, varname, level, lod);
+
+	return(true);
 }
 	
 
@@ -2624,114 +3756,71 @@ bool DataMgr::_hasVerticalXForm(
 }
 
 
-template <typename C>
-string DataMgr::VarInfoCache<C>::_make_hash(
-	string key, size_t ts, vector <string> varnames, int level, int lod
-) {
+// Tab separated fields: key, ts, number of varnames, varnames, level, 
+// lod, and ext. Tabs are not permitted in variable names.
+//
+string DataMgr::VarInfoKey::Encode() const {
 	ostringstream oss;
 
-	oss << key << ":"; 
-	oss << ts << ":"; 
+	oss << key << "\t" << ts << "\t" << varnames.size();
 	for (int i=0; i<varnames.size(); i++) {
-		oss << varnames[i] << ":";
+		oss << "\t" << varnames[i];
+	}
+	oss << "\t" << level << "\t" << lod;
+	for (int i=0; i<ext.size(); i++) {
+		oss << "\t" << ext[i];
 	}
-	oss << level << ":";
-	oss << lod;
-
 	return(oss.str());
 }
 
-template <typename C>
-void DataMgr::VarInfoCache<C>::_decode_hash(
-	const string &hash,
-	string &key, size_t &ts, vector <string> &varnames, int &level, int &lod
-) {
-	varnames.clear();
-
-	stringstream ss(hash);
-	vector<string> result;
-
-	// parse hash into vector of strings
-	//
-	while( ss.good() ) {
-		string substr;
-		getline( ss, substr, ':' );
-		result.push_back( substr );
-	}
-	VAssert(result.size() >= 5);
-
-	int i = 0;
-	key = result[i++];
-	ts = (size_t) stoi(result[i++]);
-	while (! is_int(result[i])) {
-		varnames.push_back(result[i++]);
-	}
-	level = stoi(result[i++]);
-	lod = stoi(result[i++]);
-}
+bool DataMgr::VarInfoKey::Decode(const string &s) {
+	vector <string> fields;
+	stringstream ss(s);
+	string field;
+	while (getline(ss, field, '\t')) fields.push_back(field);
 
-template <typename C>
-void DataMgr::VarInfoCache<C>::Set(
-	size_t ts, vector <string> varnames, int level, int lod, string key,
-	const vector <C> &values
-) {
-	string hash = _make_hash(key, ts, varnames, level, lod);
-	_cache[hash] = values;
-}
+	if (fields.size() < 5) return(false);
 
-template <typename C>
-bool DataMgr::VarInfoCache<C>::Get(
-	size_t ts, vector <string> varnames, int level, int lod, string key,
-	vector <C> &values
-) const {
-	values.clear();
+	size_t i = 0;
+	key = fields[i++];
+	ts = strtoul(fields[i++].c_str(), NULL, 10);
+	size_t n = strtoul(fields[i++].c_str(), NULL, 10);
+	if (fields.size() < i + n + 2) return(false);
 
-	string hash = _make_hash(key, ts, varnames, level, lod);
-	typename map <string, vector <C>>::const_iterator itr = _cache.find(hash);
+	varnames.assign(fields.begin() + i, fields.begin() + i + n);
+	i += n;
 
-	if (itr == _cache.end()) return(false);
+	level = atoi(fields[i++].c_str());
+	lod = atoi(fields[i++].c_str());
 
-	values = itr->second;
+	ext.clear();
+	for (; i<fields.size(); i++) {
+		ext.push_back(strtoul(fields[i].c_str(), NULL, 10));
+	}
 	return(true);
 }
-	
-template <typename C>
-void DataMgr::VarInfoCache<C>::Purge(
-	size_t ts, vector <string> varnames, int level, int lod, string key
-) {
-	string hash = _make_hash(key, ts, varnames, level, lod);
-	typename map <string, vector <C> >::iterator itr = _cache.find(hash);
 
-	if (itr == _cache.end()) return;
-
-	_cache.erase(itr);
-}
-
-template <typename C>
-void DataMgr::VarInfoCache<C>::Purge(
-	vector <string> varnames
-) {
-
-	vector <string> hashes;
-	typename map <string, std::vector <C> >::iterator itr;
-	for (itr=_cache.begin(); itr!= _cache.end(); ++itr) {
-		hashes.push_back(itr->first);
-	}
-
-	for (int i=0; i<hashes.size(); i++) {
-		string hash = hashes[i];
-		string key;
-		size_t ts;
-		vector <string> cvarnames;
-		int level;
-		int lod;
-
-		_decode_hash(hash, key, ts, cvarnames, level, lod);
-
-		if (varnames == cvarnames) {
-			Purge(ts, varnames, level, lod, key);
-		}
-	}
+size_t DataMgr::VarInfoKeyHash::operator()(const VarInfoKey &key) const {
+
+	// Combine hashes of the individual fields (boost::hash_combine)
+	//
+	size_t seed = 0;
+	auto combine = [&seed] (size_t v) {
+		seed ^= v + 0x9e3779b9 + (seed<<6) + (seed>>2);
+	};
+
+	std::hash <string> shash;
+	combine(shash(key.key));
+	combine(key.ts);
+	for (int i=0; i<key.varnames.size(); i++) {
+		combine(shash(key.varnames[i]));
+	}
+	combine((size_t) key.level);
+	combine((size_t) key.lod);
+	for (int i=0; i<key.ext.size(); i++) {
+		combine(key.ext[i]);
+	}
+	return(seed);
 }
 
 DataMgr::BlkExts::BlkExts() {
@@ -2816,6 +3905,502 @@ bool DataMgr::BlkExts::Intersect(
 	return(intersection);
 }
 
+// Layout: ndim, bmin[ndim], bmax[ndim], ncoords, followed by the 
+// ncoords min and ncoords max coordinates of each block
+//
+bool DataMgr::BlkExts::Encode(std::vector <double> &v) const {
+	v.clear();
+
+	if (_bmin.empty() || _mins.empty()) return(false);
+
+	size_t ncoords = _mins[0].size();
+	for (size_t i=0; i<_mins.size(); i++) {
+		if (_mins[i].size() != ncoords || _maxs[i].size() != ncoords) {
+			return(false);
+		}
+	}
+
+	v.push_back(_bmin.size());
+	for (int i=0; i<_bmin.size(); i++) v.push_back(_bmin[i]);
+	for (int i=0; i<_bmax.size(); i++) v.push_back(_bmax[i]);
+	v.push_back(ncoords);
+
+	for (size_t i=0; i<_mins.size(); i++) {
+		v.insert(v.end(), _mins[i].begin(), _mins[i].end());
+		v.insert(v.end(), _maxs[i].begin(), _maxs[i].end());
+	}
+	return(true);
+}
+
+bool DataMgr::BlkExts::Decode(const std::vector <double> &v) {
+	if (v.empty()) return(false);
+
+	size_t ndim = (size_t) v[0];
+	if (ndim < 1 || ndim > 3 || v.size() < 2*ndim + 2) return(false);
+
+	vector <size_t> bmin, bmax;
+	for (int i=0; i<ndim; i++) bmin.push_back((size_t) v[1+i]);
+	for (int i=0; i<ndim; i++) bmax.push_back((size_t) v[1+ndim+i]);
+	for (int i=0; i<ndim; i++) {
+		if (bmin[i] > bmax[i]) return(false);
+	}
+
+	size_t ncoords = (size_t) v[1+2*ndim];
+	size_t nblocks = Wasp::LinearizeCoords(bmax, bmin, bmax) + 1;
+	if (v.size() != 2*ndim + 2 + nblocks * 2 * ncoords) return(false);
+
+	*this = BlkExts(bmin, bmax);
+
+	vector <double>::const_iterator itr = v.begin() + 2*ndim + 2;
+	for (size_t i=0; i<nblocks; i++) {
+		_mins[i].assign(itr, itr + ncoords);
+		itr += ncoords;
+		_maxs[i].assign(itr, itr + ncoords);
+		itr += ncoords;
+	}
+	return(true);
+}
+
+bool DataMgr::RegionCache::region_key_t::operator==(
+	const region_key_t &rhs
+) const {
+	if (ts != rhs.ts || varid != rhs.varid || level != rhs.level ||
+		lod != rhs.lod || ndim != rhs.ndim) {
+
+		return(false);
+	}
+
+	for (int i=0; i<ndim; i++) {
+		if (bmin[i] != rhs.bmin[i] || bmax[i] != rhs.bmax[i]) return(false);
+	}
+	return(true);
+}
+
+size_t DataMgr::RegionCache::region_key_hash::operator()(
+	const region_key_t &key
+) const {
+
+	// Combine hashes of the individual fields (boost::hash_combine)
+	//
+	size_t seed = 0;
+	auto combine = [&seed] (size_t v) {
+		seed ^= std::hash<size_t>()(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+	};
+
+	combine(key.ts);
+	combine((size_t) key.varid);
+	combine((size_t) key.level);
+	combine((size_t) key.lod);
+	for (int i=0; i<key.ndim; i++) {
+		combine(key.bmin[i]);
+		combine(key.bmax[i]);
+	}
+	return(seed);
+}
+
+bool DataMgr::RegionCache::_make_key(
+	size_t ts, const string &varname, int level, int lod,
+	const vector <size_t> &bmin, const vector <size_t> &bmax,
+	bool intern, region_key_t &key
+) {
+	VAssert(bmin.size() == bmax.size());
+	VAssert(bmin.size() <= 3);
+
+	auto itr = _varIds.find(varname);
+	if (itr == _varIds.end()) {
+		if (! intern) return(false);
+
+		int varid = _varIds.size();
+		itr = _varIds.insert(std::make_pair(varname, varid)).first;
+	}
+
+	key.ts = ts;
+	key.varid = itr->second;
+	key.level = level;
+	key.lod = lod;
+	key.ndim = bmin.size();
+	for (int i=0; i<3; i++) {
+		key.bmin[i] = i < bmin.size() ? bmin[i] : 0;
+		key.bmax[i] = i < bmax.size() ? bmax[i] : 0;
+	}
+	return(true);
+}
+
+DataMgr::RegionCache::iterator DataMgr::RegionCache::Find(
+	size_t ts, const string &varname, int level, int lod,
+	const vector <size_t> &bmin, const vector <size_t> &bmax
+) {
+	region_key_t key;
+	if (! _make_key(ts, varname, level, lod, bmin, bmax, false, key)) {
+		return(_regions.end());
+	}
+
+	auto itr = _keyIndex.find(key);
+	if (itr == _keyIndex.end()) return(_regions.end());
+
+	return(itr->second);
+}
+
+DataMgr::RegionCache::region_key_t DataMgr::RegionCache::_var_key(
+	region_key_t key
+) {
+	for (int i=0; i<3; i++) {
+		key.bmin[i] = key.bmax[i] = 0;
+	}
+	return(key);
+}
+
+DataMgr::RegionCache::iterator DataMgr::RegionCache::FindContaining(
+	size_t ts, const string &varname, int level, int lod,
+	const vector <size_t> &bmin, const vector <size_t> &bmax
+) {
+	region_key_t key;
+	if (! _make_key(ts, varname, level, lod, bmin, bmax, false, key)) {
+		return(_regions.end());
+	}
+
+	iterator best = _regions.end();
+	size_t best_nblocks = 0;
+
+	auto range = _varIndex.equal_range(_var_key(key));
+	for (auto vitr = range.first; vitr != range.second; ++vitr) {
+		const region_t &region = *(vitr->second);
+		if (region.bmin.size() != bmin.size()) continue;
+
+		bool contains = true;
+		size_t nblocks = 1;
+		for (int i=0; i<bmin.size() && contains; i++) {
+			contains = region.bmin[i] <= bmin[i] && region.bmax[i] >= bmax[i];
+			nblocks *= region.bmax[i] - region.bmin[i] + 1;
+		}
+		if (! contains) continue;
+
+		if (best == _regions.end() || nblocks < best_nblocks) {
+			best = vitr->second;
+			best_nblocks = nblocks;
+		}
+	}
+	return(best);
+}
+
+DataMgr::RegionCache::iterator DataMgr::RegionCache::Find(
+	const void *blks
+) {
+	auto itr = _blksIndex.find(blks);
+	if (itr == _blksIndex.end()) return(_regions.end());
+
+	return(itr->second);
+}
+
+DataMgr::RegionCache::iterator DataMgr::RegionCache::Insert(
+	const region_t &region
+) {
+	region_key_t key;
+	(void) _make_key(
+		region.ts, region.varname, region.level, region.lod,
+		region.bmin, region.bmax, true, key
+	);
+
+	iterator itr = _regions.insert(_regions.end(), region);
+	itr->last_use = ++_clock;
+
+	_keyIndex[key] = itr;
+	_varIndex.insert(std::make_pair(_var_key(key), itr));
+	if (region.blks) _blksIndex[region.blks] = itr;
+
+	_index_priority(itr);
+
+	return(itr);
+}
+
+bool DataMgr::RegionCache::ParseEvictionPolicy(
+	string name, EvictionPolicy &policy
+) {
+	if (name == "lru") policy = LRU;
+	else if (name == "gdsf") policy = GDSF;
+	else if (name == "cost") policy = COST;
+	else return(false);
+
+	return(true);
+}
+
+void DataMgr::RegionCache::SetEvictionPolicy(EvictionPolicy policy) {
+	_policy = policy;
+	_inflation = 0.0;
+
+	_priorityIndex.clear();
+	for (iterator itr = _regions.begin(); itr != _regions.end(); ++itr) {
+		_index_priority(itr);
+	}
+}
+
+double DataMgr::RegionCache::_priority(const region_t &region) const {
+
+	// Guard against zero sizes and costs (e.g. timer resolution)
+	//
+	double size = region.size ? (double) region.size : 1.0;
+	double cost = _policy == COST ? std::max(region.cost, 1e-6) : 1.0;
+
+	return(_inflation + (region.hits * cost / size));
+}
+
+void DataMgr::RegionCache::_index_priority(iterator itr) {
+	if (_policy == LRU) return;
+
+	itr->priority = _priority(*itr);
+	_priorityIndex.insert(std::make_pair(itr->priority, itr));
+}
+
+void DataMgr::RegionCache::_unindex_priority(iterator itr) {
+	if (_policy == LRU) return;
+
+	auto range = _priorityIndex.equal_range(itr->priority);
+	for (auto pitr = range.first; pitr != range.second; ++pitr) {
+		if (pitr->second == itr) {
+			_priorityIndex.erase(pitr);
+			return;
+		}
+	}
+}
+
+void DataMgr::RegionCache::Touch(iterator itr) {
+	_regions.splice(_regions.end(), _regions, itr);
+
+	_unindex_priority(itr);
+	itr->hits++;
+	itr->last_use = ++_clock;
+	_index_priority(itr);
+}
+
+void DataMgr::RegionCache::SetCost(iterator itr, double cost) {
+	_unindex_priority(itr);
+	itr->cost = cost;
+	_index_priority(itr);
+}
+
+DataMgr::RegionCache::iterator DataMgr::RegionCache::Victim(
+	size_t max_last_use, bool skip_prefetched
+) {
+	auto candidate = [=](const region_t &r) {
+		return(
+			r.lock_counter == 0 && r.last_use < max_last_use &&
+			! (skip_prefetched && r.prefetched)
+		);
+	};
+
+	if (_policy == LRU) {
+
+		// The least recently used region is at the front of the list
+		//
+		for (iterator itr = _regions.begin(); itr != _regions.end(); ++itr) {
+			if (candidate(*itr)) return(itr);
+		}
+		return(_regions.end());
+	}
+
+	for (auto pitr = _priorityIndex.begin(); pitr != _priorityIndex.end(); ++pitr) {
+		if (candidate(*pitr->second)) return(pitr->second);
+	}
+	return(_regions.end());
+}
+
+DataMgr::RegionCache::iterator DataMgr::RegionCache::Erase(iterator itr) {
+	const region_t &region = *itr;
+
+	region_key_t key;
+	if (_make_key(
+		region.ts, region.varname, region.level, region.lod,
+		region.bmin, region.bmax, false, key
+	)) {
+		auto kitr = _keyIndex.find(key);
+		if (kitr != _keyIndex.end() && kitr->second == itr) {
+			_keyIndex.erase(kitr);
+		}
+
+		auto range = _varIndex.equal_range(_var_key(key));
+		for (auto vitr = range.first; vitr != range.second; ++vitr) {
+			if (vitr->second == itr) {
+				_varIndex.erase(vitr);
+				break;
+			}
+		}
+	}
+
+	auto bitr = _blksIndex.find(region.blks);
+	if (bitr != _blksIndex.end() && bitr->second == itr) {
+		_blksIndex.erase(bitr);
+	}
+
+	_unindex_priority(itr);
+
+	return(_regions.erase(itr));
+}
+
+void DataMgr::RegionCache::Clear() {
+	_regions.clear();
+	_keyIndex.clear();
+	_varIndex.clear();
+	_blksIndex.clear();
+	_varIds.clear();
+	_priorityIndex.clear();
+	_inflation = 0.0;
+}
+
+
+namespace {
+const string infoCacheMagic = "VAPOR_DATAMGR_INFO_CACHE 2";
+};
+
+// The fingerprint identifies the data files, by name, size, and 
+// modification time, and the options that affect coordinates.
+//
+string DataMgr::_getInfoCacheFingerprint(const vector <string> &files) const {
+
+	vector <string> paths = files;
+
+	// VDC variable data are stored in a directory next to the master file
+	//
+	if (_format.compare("vdc") == 0) {
+		std::function<void(const string &)> walk = [&](const string &dir) {
+			vector <string> names = FileUtils::ListFiles(dir);
+			for (int i=0; i<names.size(); i++) {
+				string path = FileUtils::JoinPaths({dir, names[i]});
+				if (FileUtils::IsDirectory(path)) walk(path);
+				else paths.push_back(path);
+			}
+		};
+		for (int i=0; i<files.size(); i++) {
+			walk(VDCNetCDF::GetDataDir(files[i]));
+		}
+	}
+	sort(paths.begin(), paths.end());
+
+	ostringstream oss;
+	oss << _format << ";" << _proj4String << ";";
+	oss << _doTransformHorizontal << ";" << _doTransformVertical << ";";
+	for (int i=0; i<paths.size(); i++) {
+		oss << paths[i] << ":" << FileUtils::GetFileSize(paths[i]) << ":" 
+			<< FileUtils::GetFileModifiedTime(paths[i]) << ";";
+	}
+
+	// 64-bit FNV-1a
+	//
+	uint64_t hash = 14695981039346656037ULL;
+	string str = oss.str();
+	for (size_t i=0; i<str.size(); i++) {
+		hash ^= (unsigned char) str[i];
+		hash *= 1099511628211ULL;
+	}
+
+	ostringstream hex;
+	hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return(hex.str());
+}
+
+// File format, one item per line: a magic string, the fingerprint, and 
+// then triples of lines giving the cache ("info" or "blkexts"), the 
+// cache key, and the number of values followed by the values
+//
+void DataMgr::_loadInfoCache() {
+	if (_infoCachePath.empty() || _infoCacheFingerprint.empty()) return;
+
+	ifstream in(_infoCachePath.c_str());
+	if (! in) return;
+
+	string line;
+	if (! getline(in, line) || line != infoCacheMagic) return;
+
+	// Stale cache is silently ignored, and replaced on the next save
+	//
+	if (! getline(in, line) || line != _infoCacheFingerprint) return;
+
+	string tag, keystr, values;
+	while (getline(in, tag) && getline(in, keystr) && getline(in, values)) {
+
+		// Use strtod() so that infinities round trip
+		//
+		const char *p = values.c_str();
+		char *end;
+		size_t n = strtoul(p, &end, 10);
+		if (end == p) break;
+
+		vector <double> v;
+		for (size_t i=0; i<n; i++) {
+			p = end;
+			v.push_back(strtod(p, &end));
+			if (end == p) break;
+		}
+		if (v.size() != n) break;
+
+		VarInfoKey key;
+		if (! key.Decode(keystr)) break;
+
+		if (tag == "info") {
+			_varInfoCacheDouble.Set(key, v);
+		}
+		else if (tag == "blkexts") {
+			BlkExts blkexts;
+			if (blkexts.Decode(v)) _blkExtsCache[key] = blkexts;
+		}
+	}
+	SetDiagMsg(
+		"DataMgr::_loadInfoCache() - loaded %s", _infoCachePath.c_str()
+	);
+}
+
+void DataMgr::_saveInfoCache() {
+	if (_infoCachePath.empty() || _infoCacheFingerprint.empty()) return;
+
+	// Variables defined by the application may not exist, or may have
+	// a different definition, in the next session
+	//
+	vector <string> derivedVars = _dvm.GetDataVarNames();
+	auto persistent = [&derivedVars](const VarInfoKey &key) {
+		for (int i=0; i<key.varnames.size(); i++) {
+			if (contains(derivedVars, key.varnames[i])) return(false);
+		}
+		return(true);
+	};
+
+	string tmpPath = _infoCachePath + ".tmp";
+	ofstream out(tmpPath.c_str());
+	if (! out) return;
+
+	out << infoCacheMagic << endl;
+	out << _infoCacheFingerprint << endl;
+	out << std::setprecision(17);
+
+	const VarInfoCache <double>::cache_t &entries = 
+		_varInfoCacheDouble.GetEntries();
+	for (auto itr = entries.begin(); itr != entries.end(); ++itr) {
+		if (! persistent(itr->first)) continue;
+
+		const vector <double> &v = itr->second;
+		out << "info" << endl << itr->first.Encode() << endl << v.size();
+		for (int i=0; i<v.size(); i++) out << " " << v[i];
+		out << endl;
+	}
+
+	for (auto itr = _blkExtsCache.begin(); itr != _blkExtsCache.end(); ++itr) {
+		if (! persistent(itr->first)) continue;
+
+		vector <double> v;
+		if (! itr->second.Encode(v)) continue;
+
+		out << "blkexts" << endl << itr->first.Encode() << endl << v.size();
+		for (int i=0; i<v.size(); i++) out << " " << v[i];
+		out << endl;
+	}
+
+	out.close();
+	if (! out) {
+		(void) remove(tmpPath.c_str());
+		return;
+	}
+
+	(void) remove(_infoCachePath.c_str());
+	(void) rename(tmpPath.c_str(), _infoCachePath.c_str());
+}
 
 int DataMgr::_level_correction(string varname, int &level) const {
 	int nlevels = DataMgr::GetNumRefLevels(varname);
@@ -3135,16 +4720,14 @@ int DataMgr::_find_bounding_grid(
 		bs.push_back(_bs[i]);
 	}
 
-	// hash tag for block coordinate cache
+	// key for block coordinate cache
 	//
-	string hash = VarInfoCache<int>::_make_hash(
-		"BlkExts", hash_ts, scvars, level, lod
-	);
+	VarInfoKey key("BlkExts", hash_ts, scvars, level, lod);
 
 	// See if bounding volumes for individual blocks are already 
 	// cached for this grid
 	//
-	map <string, BlkExts >::iterator itr = _blkExtsCache.find(hash);
+	auto itr = _blkExtsCache.find(key);
 
 	if (itr == _blkExtsCache.end()) {
 		SetDiagMsg(
@@ -3208,8 +4791,8 @@ int DataMgr::_find_bounding_grid(
 
 		// Add to the hash table
 		//
-		_blkExtsCache[hash] = blkexts;
-		itr = _blkExtsCache.find(hash);
+		_blkExtsCache[key] = blkexts;
+		itr = _blkExtsCache.find(key);
 		VAssert (itr != _blkExtsCache.end());
 
 	}
@@ -3247,19 +4830,44 @@ int DataMgr::_find_bounding_grid(
 	return(0);
 }
 
+bool DataMgr::_is_pending(const void *blks) {
+	std::lock_guard <std::mutex> lock(_pendingMutex);
+	return(_pendingRegions.count(blks) != 0);
+}
+
+void DataMgr::_set_pending(const void *blks, bool pending) {
+	{
+		std::lock_guard <std::mutex> lock(_pendingMutex);
+		if (pending) _pendingRegions.insert(blks);
+		else _pendingRegions.erase(blks);
+	}
+	if (! pending) _pendingCond.notify_all();
+}
+
+// Wait for a pending region to be read, giving up _mutex so that the 
+// reading thread can finish
+//
+void DataMgr::_wait_pending(const void *blks) {
+	size_t depth = _mutex.Release();
+	{
+		std::unique_lock <std::mutex> lock(_pendingMutex);
+		_pendingCond.wait(lock, [this, blks] {
+			return(_pendingRegions.count(blks) == 0);
+		});
+	}
+	_mutex.Reacquire(depth);
+}
+
 void	DataMgr::_unlock_blocks(
 	const void *blks
 ) {
 
-	list <region_t>::iterator itr;
-	for(itr = _regionsList.begin(); itr!=_regionsList.end(); itr++) {
-		region_t &region = *itr;
+	RegionCache::iterator itr = _regionsList.Find(blks);
+	if (itr == _regionsList.end()) return;
+
+	region_t &region = *itr;
+	if (region.lock_counter>0) region.lock_counter--;
 
-		if (region.blks == blks && region.lock_counter>0) {
-			region.lock_counter--;
-			return;
-		}
-	}
 	return;
 }
 
@@ -3526,13 +5134,29 @@ DerivedCoordVar *DataMgr::_getDerivedCoordVar(string varname) const {
 int DataMgr::_openVariableRead(size_t ts, string varname, int level, int lod) {
 
 	_openVarName = varname;
+	_openTs = ts;
+	_openLevel = level;
+	_openLod = lod;
 
+	double t0 = Wasp::GetTime();
+
+	int fd;
 	DerivedVar *derivedVar = _getDerivedVar(_openVarName);
 	if (derivedVar) {
-		return (derivedVar->OpenVariableRead(ts, level, lod));
+		fd = derivedVar->OpenVariableRead(ts, level, lod);
+	}
+	else {
+		fd = _dc->OpenVariableRead(ts, varname, level, lod);
 	}
 
-	return (_dc->OpenVariableRead(ts, _openVarName, level, lod));
+	double t1 = Wasp::GetTime();
+	_countStats(ts, varname, [t0, t1](CacheCounters &c) {
+		c.opens++;
+		c.open_time += t1 - t0;
+	});
+	_trace("open", t0, t1, ts, varname, level, lod);
+
+	return(fd);
 }
 
 
@@ -3546,7 +5170,23 @@ int DataMgr::_readRegionBlock(
 	DerivedVar *derivedVar = _getDerivedVar(_openVarName);
 	if (derivedVar) {
 		VAssert ((std::is_same<T,float>::value) == true);
+
+		// Evaluating the variable may read others, changing _openVarName
+		//
+		size_t ts = _openTs;
+		string varname = _openVarName;
+		int level = _openLevel;
+		int lod = _openLod;
+
+		double t0 = Wasp::GetTime();
 		rc = derivedVar->ReadRegionBlock(fd, min, max, (float *) region);
+		double t1 = Wasp::GetTime();
+
+		_countStats(ts, varname, [t0, t1](CacheCounters &c) {
+			c.derived_reads++;
+			c.derived_time += t1 - t0;
+		});
+		_trace("derive", t0, t1, ts, varname, level, lod);
 	}
 	else {
 		rc = _dc->ReadRegionBlock(fd, min, max, region);
@@ -3566,7 +5206,23 @@ int DataMgr::_readRegion(
 	DerivedVar *derivedVar = _getDerivedVar(_openVarName);
 	if (derivedVar) {
 		VAssert ((std::is_same<T,float>::value) == true);
+
+		// Evaluating the variable may read others, changing _openVarName
+		//
+		size_t ts = _openTs;
+		string varname = _openVarName;
+		int level = _openLevel;
+		int lod = _openLod;
+
+		double t0 = Wasp::GetTime();
 		rc = derivedVar->ReadRegion(fd, min, max, (float *) region);
+		double t1 = Wasp::GetTime();
+
+		_countStats(ts, varname, [t0, t1](CacheCounters &c) {
+			c.derived_reads++;
+			c.derived_time += t1 - t0;
+		});
+		_trace("derive", t0, t1, ts, varname, level, lod);
 	}
 	else {
 		rc = _dc->ReadRegion(fd, min, max, region);
@@ -3576,6 +5232,116 @@ int DataMgr::_readRegion(
 	return(rc);
 }
 
+void DataMgr::GetCacheStats(CacheStats &stats) const {
+	{
+		std::lock_guard <std::mutex> lock(_statsMutex);
+		stats = _stats;
+	}
+
+	std::lock_guard <ReleasableMutex> guard(_mutex);
+
+	stats.num_regions = 0;
+	stats.bytes_cached = 0;
+	RegionCache &regions = const_cast <RegionCache &> (_regionsList);
+	for (auto itr = regions.begin(); itr != regions.end(); ++itr) {
+		stats.num_regions++;
+		stats.bytes_cached += itr->size;
+	}
+
+	stats.pool = BlkMemMgr::Stats();
+	if (_blk_mem_mgr) BlkMemMgr::GetStats(stats.pool);
+}
+
+void DataMgr::ResetCacheStats() {
+	std::lock_guard <std::mutex> lock(_statsMutex);
+	_stats.total = CacheCounters();
+	_stats.variables.clear();
+	_stats.timesteps.clear();
+	_stats.num_regions = 0;
+	_stats.bytes_cached = 0;
+	_stats.pool = BlkMemMgr::Stats();
+}
+
+void DataMgr::_countStats(
+	size_t ts, const string &varname, 
+	const std::function <void (CacheCounters &)> &count
+) {
+	std::lock_guard <std::mutex> lock(_statsMutex);
+
+	count(_stats.total);
+
+	auto vitr = _stats.variables.find(varname);
+	if (vitr == _stats.variables.end()) {
+		vitr = _stats.variables.insert(
+			std::make_pair(varname, CacheCounters())
+		).first;
+	}
+	count(vitr->second);
+
+	auto titr = _stats.timesteps.find(ts);
+	if (titr == _stats.timesteps.end()) {
+		titr = _stats.timesteps.insert(
+			std::make_pair(ts, CacheCounters())
+		).first;
+	}
+	count(titr->second);
+}
+
+// Events are written as they occur in the JSON array format, which 
+// doesn't require the closing bracket, so the log is usable even if 
+// the application exits abnormally
+//
+void DataMgr::_openTrace() {
+	std::lock_guard <std::mutex> lock(_traceMutex);
+
+	_traceFP = fopen(_tracePath.c_str(), "w");
+	if (! _traceFP) {
+		SetDiagMsg(
+			"DataMgr::_openTrace() - fopen(%s) : %M", _tracePath.c_str()
+		);
+		return;
+	}
+	fprintf(_traceFP, "[");
+	_traceEvents = 0;
+}
+
+void DataMgr::_closeTrace() {
+	std::lock_guard <std::mutex> lock(_traceMutex);
+
+	if (! _traceFP) return;
+
+	fprintf(_traceFP, "\n]\n");
+	fclose(_traceFP);
+	_traceFP = NULL;
+}
+
+void DataMgr::_trace(
+	const char *name, double t0, double t1, 
+	size_t ts, const string &varname, int level, int lod
+) {
+	std::lock_guard <std::mutex> lock(_traceMutex);
+
+	if (! _traceFP) return;
+
+	string escaped;
+	for (size_t i=0; i<varname.size(); i++) {
+		if (varname[i] == '"' || varname[i] == '\\') escaped += '\\';
+		escaped += varname[i];
+	}
+
+	size_t tid = std::hash <std::thread::id>()(std::this_thread::get_id());
+
+	fprintf(_traceFP, _traceEvents++ ? ",\n" : "\n");
+	fprintf(
+		_traceFP, 
+		"{\"name\":\"%s\",\"cat\":\"DataMgr\",\"ph\":\"X\","
+		"\"ts\":%.0f,\"dur\":%.0f,\"pid\":1,\"tid\":%u,"
+		"\"args\":{\"var\":\"%s\",\"ts\":%lu,\"level\":%d,\"lod\":%d}}",
+		name, t0 * 1e6, (t1 - t0) * 1e6, (unsigned int) (tid & 0xffffffff),
+		escaped.c_str(), (unsigned long) ts, level, lod
+	);
+}
+
 int DataMgr::_closeVariable(int fd) {
 
 
@@ -3620,6 +5386,10 @@ int DataMgr::_getVar(
 	size_t ts, string varname, int level, int lod, float *data
 ) {
 
+	size_t depth = _mutex.Release();
+	std::lock_guard <std::recursive_mutex> dcguard(_dcMutex);
+	_mutex.Reacquire(depth);
+
 	vector <size_t> dims_at_level, dummy;
 	int rc = _dc->GetDimLensAtLevel(varname, level, dims_at_level, dummy);
 	if (rc<0) return(-1);
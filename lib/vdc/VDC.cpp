@@ -86,6 +86,12 @@ VDC::VDC() {
 	_cratios.push_back(10);
 	_cratios.push_back(1);
 
+	_deflate_level = 0;
+	_keepbits = 0;
+	_adaptive_wnames.clear();
+	_errbound = 0.0;
+	_errbound_relative = false;
+
 	_periodic.clear();
 	for (int i=0; i<3; i++) _periodic.push_back(false);
 
@@ -161,6 +167,61 @@ int VDC::SetCompressionBlock(
 	return(0);
 }
 
+int VDC::SetEntropyCode(int deflate_level, int keepbits) {
+	if (! _defineMode) {
+		SetErrMsg("Not in define mode");
+		return(-1);
+	}
+
+	if (deflate_level < 0 || deflate_level > 9 || keepbits < 0) {
+		SetErrMsg("Invalid entropy coding settings");
+		return(-1);
+	}
+
+	_deflate_level = deflate_level;
+	_keepbits = keepbits;
+
+	return(0);
+}
+
+int VDC::SetAdaptiveWavelets(vector <string> wnames) {
+	if (! _defineMode) {
+		SetErrMsg("Not in define mode");
+		return(-1);
+	}
+
+	for (int i=0; i<wnames.size(); i++) {
+		size_t nlevels, maxcratio;
+		if (wnames[i].empty() || 
+			! CompressionInfo(_bs, wnames[i], nlevels, maxcratio)) {
+
+			SetErrMsg("Invalid wavelet %s", wnames[i].c_str());
+			return(-1);
+		}
+	}
+
+	_adaptive_wnames = wnames;
+
+	return(0);
+}
+
+int VDC::SetErrorBound(double errbound, bool relative) {
+	if (! _defineMode) {
+		SetErrMsg("Not in define mode");
+		return(-1);
+	}
+
+	if (! (errbound >= 0.0)) {
+		SetErrMsg("Invalid error bound");
+		return(-1);
+	}
+
+	_errbound = errbound;
+	_errbound_relative = relative;
+
+	return(0);
+}
+
 void VDC::GetCompressionBlock(
     vector <size_t> &bs, string &wname,
     vector <size_t> &cratios
@@ -1360,6 +1421,15 @@ std::ostream &operator<<(std::ostream &o, const VDC &vdc) {
 		o << vdc._cratios[i] << " ";
 	}
 	o << endl;
+	o << " Entropy Code: " << vdc._deflate_level << endl;
+	o << " Keep Bits: " << vdc._keepbits << endl;
+	o << " Adaptive Wavelets: ";
+	for (int i=0; i<vdc._adaptive_wnames.size(); i++) {
+		o << vdc._adaptive_wnames[i] << " ";
+	}
+	o << endl;
+	o << " Error Bound: " << vdc._errbound << endl;
+	o << " Error Bound Relative: " << vdc._errbound_relative << endl;
 	o << " Periodic: ";
 	for (int i=0; i<vdc._periodic.size(); i++) {
 		o << vdc._periodic[i] << " ";
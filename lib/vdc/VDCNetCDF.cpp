@@ -561,7 +561,7 @@ int VDCNetCDF::OpenVariableWrite(size_t ts, string varname, int lod) {
 
 		size_t chsz = _chunksizehint;
 		rc = wasp->Create(
-			path, NC_WRITE | NC_64BIT_OFFSET, 0, chsz, 
+			path, _create_mode(*varptr), 0, chsz, 
 			varptr->GetCRatios().size()
 		);
 		if (rc<0) return(-1);
@@ -937,6 +937,111 @@ int VDCNetCDF::readRegionBlock(
 	return(_readRegionBlockTemplate(fd, min,max, region));
 }
 
+bool VDCNetCDF::mapVariable(
+	int fd, const float *&data, bool &swap, vector <size_t> &bs
+) {
+	data = NULL;
+	swap = false;
+	bs.clear();
+
+    VDCFileObject *o = (VDCFileObject *) _fileTable.GetEntry(fd);
+	if (! o) return(false);
+
+	// Missing values must be restored from the mask
+	//
+	if (o->GetWaspMask()) return(false);
+
+	string varname = o->GetVarname();
+	vector <size_t> dims;
+	bool ok = VDC::GetVarDimLens(varname, true, dims);
+	if (! ok || dims.empty()) return(false);
+
+	vector <size_t> min(dims.size(), 0);
+	vector <size_t> max;
+	for (int i=0; i<dims.size(); i++) max.push_back(dims[i]-1);
+
+	vector <size_t> start;
+	vector <size_t> count;
+	vdc_2_ncdfcoords(
+		o->GetFileTS(), o->GetFileTS(), VDC::IsTimeVarying(varname), 
+		min, max, start, count
+	);
+
+	// Uncompressed variables are usually blocked. The block dimensions 
+	// are in NetCDF order and include any time dimension
+	//
+	const void *addr;
+	vector <size_t> ncbs;
+	if (! o->GetWaspData()->MapVara(start, count, NC_FLOAT, addr, ncbs)) {
+		return(false);
+	}
+	VAssert(ncbs.size() >= dims.size());
+	for (int i=0; i<dims.size(); i++) {
+		bs.push_back(ncbs[ncbs.size()-i-1]);
+	}
+
+	// NetCDF external representation is big-endian
+	//
+	const int one = 1;
+	swap = *((const char *) &one) == 1;
+
+	data = (const float *) addr;
+	return(true);
+}
+
+int VDCNetCDF::readBlockSummaries(
+	int fd, vector <size_t> &bdims, 
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+) {
+	bdims.clear();
+	mins.clear();
+	maxs.clear();
+	missing.clear();
+
+    VDCFileObject *o = (VDCFileObject *) _fileTable.GetEntry(fd);
+	if (! o) {
+		SetErrMsg("Invalid file descriptor : %d", fd);
+		return(-1);
+	}
+
+	string varname = o->GetVarname();
+	vector <size_t> dims;
+	bool ok = VDC::GetVarDimLens(varname, true, dims);
+	if (! ok) {
+        SetErrMsg("Undefined variable name : %s", varname.c_str());
+		return(-1);
+	}
+	if (dims.empty()) return(0);
+
+	vector <size_t> min(dims.size(), 0);
+	vector <size_t> max;
+	for (int i=0; i<dims.size(); i++) max.push_back(dims[i]-1);
+
+	vector <size_t> start;
+	vector <size_t> count;
+	bool time_varying = VDC::IsTimeVarying(varname);
+	vdc_2_ncdfcoords(
+		o->GetFileTS(), o->GetFileTS(), time_varying, min, max, start, count
+	);
+
+	vector <size_t> ncdf_bdims;
+	int rc = o->GetWaspData()->GetBlockSummaries(
+		start, count, ncdf_bdims, mins, maxs, missing
+	);
+	if (rc<0) return(-1);
+	if (ncdf_bdims.empty()) return(0);
+
+	// Drop the time dimension and reverse to VDC (fastest varying first)
+	// ordering. The summary arrays themselves are already ordered 
+	// with the fastest varying dimension first.
+	//
+	if (time_varying) ncdf_bdims.erase(ncdf_bdims.begin());
+	bdims.assign(ncdf_bdims.rbegin(), ncdf_bdims.rend());
+
+	return(0);
+}
+
 template <class T>
 int VDCNetCDF::_putVarTemplate(string varname, int lod, const T *data) {
 
@@ -1281,6 +1386,23 @@ int VDCNetCDF::_WriteMasterMeta() {
 	rc = _master->PutAtt("", "VDC.CompressionRatios", _cratios);
 	if (rc<0) return(rc);
 
+	rc = _master->PutAtt("", "VDC.EntropyCode", _deflate_level);
+	if (rc<0) return(rc);
+
+	rc = _master->PutAtt("", "VDC.KeepBits", _keepbits);
+	if (rc<0) return(rc);
+
+	rc = _master->PutAtt("", "VDC.AdaptiveWavelets", _adaptive_wnames);
+	if (rc<0) return(rc);
+
+	rc = _master->PutAtt("", "VDC.ErrorBound", _errbound);
+	if (rc<0) return(rc);
+
+	rc = _master->PutAtt(
+		"", "VDC.ErrorBoundRelative", (int) _errbound_relative
+	);
+	if (rc<0) return(rc);
+
 	rc = _master->PutAtt("", "VDC.MasterThreshold", _master_threshold);
 	if (rc<0) return(rc);
 
@@ -1345,6 +1467,40 @@ int VDCNetCDF::_ReadMasterMeta() {
     sort(_cratios.begin(), _cratios.end());
     reverse(_cratios.begin(), _cratios.end());
 
+	// Entropy coding settings are absent from older VDCs
+	//
+	_deflate_level = 0;
+	_keepbits = 0;
+	if (_master->InqAttDefined("", "VDC.EntropyCode")) {
+		rc = _master->GetAtt("", "VDC.EntropyCode", _deflate_level);
+		if (rc<0) return(rc);
+
+		rc = _master->GetAtt("", "VDC.KeepBits", _keepbits);
+		if (rc<0) return(rc);
+	}
+
+	// As are per-block wavelet candidates
+	//
+	_adaptive_wnames.clear();
+	if (_master->InqAttDefined("", "VDC.AdaptiveWavelets")) {
+		rc = _master->GetAtt("", "VDC.AdaptiveWavelets", _adaptive_wnames);
+		if (rc<0) return(rc);
+	}
+
+	// And error bounds
+	//
+	_errbound = 0.0;
+	_errbound_relative = false;
+	if (_master->InqAttDefined("", "VDC.ErrorBound")) {
+		rc = _master->GetAtt("", "VDC.ErrorBound", _errbound);
+		if (rc<0) return(rc);
+
+		int relative;
+		rc = _master->GetAtt("", "VDC.ErrorBoundRelative", relative);
+		if (rc<0) return(rc);
+		_errbound_relative = relative;
+	}
+
 	rc = _master->GetAtt("", "VDC.MasterThreshold", _master_threshold);
 	if (rc<0) return(rc);
 
@@ -1931,6 +2087,50 @@ int VDCNetCDF::_DefBaseVar(
 	);
 	if (rc<0) return(-1);
 
+	// Entropy coding requires a NetCDF-4 file (see _create_mode()), 
+	// which the master file is not
+	//
+	if (var.IsCompressed() && _deflate_level > 0) {
+		int format;
+		rc = wasp->InqFormat(format);
+		if (rc<0) return(-1);
+
+		if (format == NC_FORMAT_NETCDF4) {
+			rc = wasp->DefVarEntropyCode(
+				var.GetName(), _deflate_level, _keepbits
+			);
+			if (rc<0) return(-1);
+		}
+	}
+
+	// Per-block wavelet selection. Integer and floating point wavelets
+	// can't be mixed
+	//
+	if (var.IsCompressed() && ! _adaptive_wnames.empty()) {
+		string wname = var.GetWName();
+		bool int_wavelet = wname.compare(0, 3, "int") == 0;
+
+		vector <string> wnames;
+		for (int i=0; i<_adaptive_wnames.size(); i++) {
+			const string &w = _adaptive_wnames[i];
+			if (w == wname) continue;
+			if ((w.compare(0, 3, "int") == 0) != int_wavelet) continue;
+			wnames.push_back(w);
+		}
+
+		if (! wnames.empty()) {
+			rc = wasp->DefVarAdaptiveWavelet(var.GetName(), wnames);
+			if (rc<0) return(-1);
+		}
+	}
+
+	if (var.IsCompressed() && _errbound > 0.0) {
+		rc = wasp->DefVarErrorBound(
+			var.GetName(), _errbound, _errbound_relative
+		);
+		if (rc<0) return(-1);
+	}
+
 	// 
 	// Attributes
 	//
@@ -2077,6 +2277,23 @@ int VDCNetCDF::_PutAtt(
 	return(0);
 }
 
+// NetCDF creation mode for a file that will hold only the variable 'var'. 
+// Variables transformed with an integer wavelet are stored losslessly,
+// and their coefficients are entropy coded by WASP, as are those
+// of any compressed variable if entropy coding is enabled. That requires
+// the NetCDF-4 format
+//
+int VDCNetCDF::_create_mode(const VDC::BaseVar &var) const {
+	string wname = var.GetWName();
+	if (wname.compare(0, 3, "int") == 0) {
+		return(NC_WRITE | NC_NETCDF4);
+	}
+	if (var.IsCompressed() && _deflate_level > 0) {
+		return(NC_WRITE | NC_NETCDF4);
+	}
+	return(NC_WRITE | NC_64BIT_OFFSET);
+}
+
 bool VDCNetCDF::_var_in_master(const VDC::BaseVar &var) const {
 
 	vector <DC::Dimension> dims;
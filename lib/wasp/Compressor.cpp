@@ -11,7 +11,7 @@ using namespace VAPoR;
 using namespace std;
 
 void Compressor::_Compressor(
-	vector <size_t> dims
+	vector <size_t> dims, int maxlevels
 ) {
 
 	if (dims.size() > 3) return;
@@ -33,6 +33,12 @@ void Compressor::_Compressor(
     _clamp_min = 0.0;
     _clamp_max = 1.0;
     _epsilon = 0.0;
+	_sigmap_version = SignificanceMap::GetLatestVersion();
+	_czero = false;
+	_errbound_flag = false;
+	_errbound_rel_flag = false;
+	_errbound = 0.0;
+	_error = 0.0;
 
 	for (int i=0; i<dims.size(); i++) {
 		_dims.push_back(dims[i]);
@@ -52,6 +58,7 @@ void Compressor::_Compressor(
 		_nlevels = min(
 			min(wmaxlev(_nx), wmaxlev(_ny)), wmaxlev(_nz)
 		);
+		if (maxlevels >= 0 && maxlevels < _nlevels) _nlevels = maxlevels;
 
 		size_t clen = coefflength3(_nx, _ny, _nz, _nlevels);
 		_C = new double[clen]; 
@@ -69,6 +76,7 @@ void Compressor::_Compressor(
 	}
 	else if (_dims.size() == 2) {
 		_nlevels = min(wmaxlev(_nx), wmaxlev(_ny));
+		if (maxlevels >= 0 && maxlevels < _nlevels) _nlevels = maxlevels;
 
 		size_t clen = coefflength2(_nx, _ny, _nlevels);
 		_C = new double[clen]; 
@@ -80,6 +88,7 @@ void Compressor::_Compressor(
 	}
 	else {
 		_nlevels = wmaxlev(_nx);
+		if (maxlevels >= 0 && maxlevels < _nlevels) _nlevels = maxlevels;
 
 		size_t clen = coefflength(_nx, _nlevels);
 		_C = new double[clen]; 
@@ -118,6 +127,18 @@ Compressor::Compressor(
 	_Compressor(dims);
 }
 
+Compressor::Compressor(
+	vector <size_t> dims, const string &wavename, int maxlevels
+) : MatWaveWavedec(wavename) {
+
+	_C = NULL; 
+	_L = NULL;
+	_CLen = 0;
+	_LLen = 0;
+
+	_Compressor(dims, maxlevels);
+}
+
 Compressor::~Compressor() {
 
 	if (_C) delete [] _C;
@@ -146,6 +167,132 @@ inline bool my_compare_l(const void * x1, const void * x2) {
 
 namespace {
 
+// Maximum absolute difference between two arrays
+//
+template <class T>
+double max_abs_diff(const T *a, const T *b, size_t n) {
+	double maxdiff = 0.0;
+	for (size_t i = 0; i<n; i++) {
+		double d = fabs((double) a[i] - (double) b[i]);
+		if (d > maxdiff) maxdiff = d;
+	}
+	return(maxdiff);
+}
+
+// Return the maximum pointwise error permitted by the compressor's error
+// bound attributes for the array, 'src_arr', of 'n' elements
+//
+template <class T>
+double error_bound(Compressor *cmp, const T *src_arr, size_t n) {
+	double bound = fabs(cmp->ErrorBound());
+	if (! cmp->ErrorBoundRelativeOnOff() || n == 0) return(bound);
+
+	double min = src_arr[0];
+	double max = src_arr[0];
+	for (size_t i = 1; i<n; i++) {
+		if (src_arr[i] < min) min = src_arr[i];
+		if (src_arr[i] > max) max = src_arr[i];
+	}
+	return(bound * (max - min));
+}
+
+// Find the fewest coefficients needed to meet an error bound. 
+//
+// The wavelet coefficients, C, of the array 'src_arr' are always 
+// reconstructed from the first 'numkeep' coefficients (approximations,
+// if retained verbatim) plus the coefficients referenced by 'indexvec'.
+// The first 'nfixed' elements of 'indexvec' are always used; the 
+// following 'nmax' elements must be sorted by decreasing magnitude. 
+// The smallest n <= nmax such that the reconstruction from the first
+// nfixed + n elements of 'indexvec' is within 'maxerror' of
+// 'src_arr' is returned, and the achieved error is returned in 'error'. 
+// If the bound can't be met nmax is returned.
+//
+template <class T>
+size_t error_bound_search(
+	Compressor *cmp, const T *src_arr, const T *C, size_t clen,
+	const size_t *L, int nlevels, const vector <size_t> &dims,
+	size_t numkeep, const vector <void *> &indexvec, size_t nfixed, 
+	size_t nmax, double maxerror, double &error
+) {
+	size_t n = 1;
+	for (int i=0; i<dims.size(); i++) n *= dims[i];
+
+	vector <T> Ctrial(clen);
+	vector <T> trial(n);
+	
+	// Reconstruct using the first 'k' of the candidate coefficients
+	// and return the maximum pointwise error
+	//
+	auto try_ncoeffs = [&](size_t k) {
+		for (size_t i = 0; i<clen; i++) Ctrial[i] = 0.0;
+		for (size_t i = 0; i<numkeep; i++) Ctrial[i] = C[i];
+		for (size_t i = 0; i<nfixed+k; i++) {
+			size_t idx = (const T *) indexvec[i] - C;
+			Ctrial[idx] = C[idx];
+		}
+
+		if (dims.size() == 3) {
+			cmp->waverec3(Ctrial.data(), L, nlevels, trial.data());
+		}
+		else if (dims.size() == 2) {
+			cmp->waverec2(Ctrial.data(), L, nlevels, trial.data());
+		}
+		else {
+			cmp->waverec(Ctrial.data(), L, nlevels, trial.data());
+		}
+		return(max_abs_diff(trial.data(), src_arr, n));
+	};
+
+	// Binary search for the smallest count that meets the bound. 
+	// Error is assumed to be (approximately) non-increasing with 
+	// the number of coefficients. The returned count is always one 
+	// that was verified.
+	//
+	size_t lo = 0;
+	size_t hi = nmax;
+	error = try_ncoeffs(hi);
+	if (error > maxerror) return(nmax);
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		double e = try_ncoeffs(mid);
+		if (e <= maxerror) {
+			hi = mid;
+			error = e;
+		}
+		else {
+			lo = mid + 1;
+		}
+	}
+	return(hi);
+}
+
+// Partition the coefficient references in [first, last) so that the 
+// lens[0] largest magnitude coefficients come first, followed by the 
+// next lens[1] largest, and so on. The order within each partition is
+// unspecified. Only a partial selection is performed at each partition 
+// boundary, which is much cheaper than sorting all of the coefficients 
+// when just a fraction of them are retained.
+//
+void select_largest(
+	vector <void *>::iterator first, vector <void *>::iterator last,
+	const vector <size_t> &lens,
+	bool my_compare(const void *, const void *)
+) {
+	size_t tlen = 0;
+	for (int j=0; j<lens.size(); j++) tlen += lens[j];
+	VAssert(tlen <= (size_t) (last - first));
+
+	vector <void *>::iterator end = first + tlen;
+	if (end != last) nth_element(first, end, last, my_compare);
+
+	for (int j=0; j+1<lens.size(); j++) {
+		nth_element(first, first + lens[j], end, my_compare);
+		first += lens[j];
+	}
+}
+
 template <class T>
 int compress_template(
 	Compressor *cmp,
@@ -158,9 +305,11 @@ int compress_template(
 	SignificanceMap *sigmap,
 	const vector <size_t> &dims,
 	size_t nlevels,
-	vector <void *> indexvec,
-	bool my_compare(const void *, const void *)
+	vector <void *> &indexvec,
+	bool my_compare(const void *, const void *),
+	double &error
 ) {
+	error = 0.0;
 
 	if (! C) {
 		Compressor::SetErrMsg("Invalid state");
@@ -204,12 +353,13 @@ int compress_template(
 	VAssert(dst_arr_len >= numkeep);
 
 	rc = sigmap->Reshape(clen); if (rc<0) return(-1);
+	rc = sigmap->SetVersion(cmp->SigMapVersion()); if (rc<0) return(-1);
 	
 	sigmap->Clear();
 
-	// Data has been transformed. Now we need to sort it and find
-	// the threshold value. Note: we don't actually move the data. We
-	// sort an index array that references the data array.
+	// Data has been transformed. Now we need to find the largest
+	// coefficients. Note: we don't actually move the data. We
+	// partition an index array that references the data array.
 
 	for (size_t i = 0; i<dst_arr_len; i++) dst_arr[i] = 0.0;
 
@@ -221,15 +371,44 @@ int compress_template(
 			if (rc<0) return(-1);
 			dst_arr[idx] = C[idx];
 		}
-		if (numkeep == dst_arr_len) return(0);
+		if (numkeep == dst_arr_len) {
+
+			// Only the approximations are retained. Their error still
+			// has to be measured
+			//
+			if (cmp->ErrorBoundOnOff()) {
+				(void) error_bound_search(
+					cmp, src_arr, C, clen, L, nlevels, dims, numkeep, 
+					indexvec, 0, 0, 0.0, error
+				);
+			}
+			return(0);
+		}
 		dst_arr += numkeep;
 		dst_arr_len -= numkeep;
 	}
 
 	indexvec.clear();
 	for (size_t i=numkeep; i<clen; i++) indexvec.push_back(&C[i]);
-    sort(indexvec.begin(), indexvec.end(), my_compare);
+	select_largest(
+		indexvec.begin(), indexvec.end(), vector <size_t> (1, dst_arr_len),
+		my_compare
+	);
+
+	// In error bounded mode keep only as many of the coefficients as 
+	// needed. The search requires the candidates sorted by magnitude
+	//
+	if (cmp->ErrorBoundOnOff()) {
+		sort(indexvec.begin(), indexvec.begin()+dst_arr_len, my_compare);
+
+		size_t n = 1;
+		for (int i=0; i<dims.size(); i++) n *= dims[i];
 
+		dst_arr_len = error_bound_search(
+			cmp, src_arr, C, clen, L, nlevels, dims, numkeep, indexvec, 0,
+			dst_arr_len, error_bound(cmp, src_arr, n), error
+		);
+	}
 
 	// Copy coefficients that are larger than the threshold to
 	// the destination array. Record their location in the significance
@@ -253,9 +432,11 @@ int Compressor::Compress(
 	SignificanceMap *sigmap
 ) {
 
+	_czero = false;
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (float *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_f
+		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_f,
+		_error
 	);
 }
 
@@ -266,9 +447,11 @@ int Compressor::Compress(
 	SignificanceMap *sigmap
 ) {
 
+	_czero = false;
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (double *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_d
+		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_d,
+		_error
 	);
 }
 
@@ -279,9 +462,11 @@ int Compressor::Compress(
 	SignificanceMap *sigmap
 ) {
 
+	_czero = false;
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (int *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_i
+		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_i,
+		_error
 	);
 }
 
@@ -292,9 +477,11 @@ int Compressor::Compress(
 	SignificanceMap *sigmap
 ) {
 
+	_czero = false;
 	return compress_template(
 		this, src_arr, dst_arr, dst_arr_len, (long *) _C, _CLen,
-		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_l
+		_L, sigmap, _dims, _nlevels, _indexvec, my_compare_l,
+		_error
 	);
 }
 
@@ -309,7 +496,8 @@ int decompress_template(
 	const size_t *L,
 	int nlevels,
 	SignificanceMap *sigmap,
-	const vector <size_t> &dims
+	const vector <size_t> &dims,
+	bool &czero
 ) {
 	if (! C) {
 		Compressor::SetErrMsg("Invalid state");
@@ -321,25 +509,21 @@ int decompress_template(
 		return(-1);
 	}
 
-	for (size_t i = 0; i<clen; i++) {
-		C[i] = 0.0;
+	// C is left zeroed on return so that only the coefficients restored 
+	// here need to be cleared again. Compress() and Decompose() 
+	// overwrite all of C.
+	//
+	if (! czero) {
+		for (size_t i = 0; i<clen; i++) {
+			C[i] = 0.0;
+		}
 	}
+	czero = false;
+
 	//
 	// Restore the non-zero wavelet coefficients
 	//
-	sigmap->GetNextEntryRestart();
-
-	size_t nsig = sigmap->GetNumSignificant();
-	for(size_t i=0; i<nsig; i++) {
-		size_t idx;
-
-		if (! sigmap->GetNextEntry(&idx)) {
-			Compressor::SetErrMsg("Invalid significance map");
-			return(-1);
-		}
-
-		C[idx] = src_arr[i];
-	}
+	sigmap->Scatter(src_arr, C);
 
 	bool normalize = cmp->wavelet()->IsNormalized();
 	
@@ -360,6 +544,10 @@ int decompress_template(
 		rc = cmp->appcoef(C, L, nlevels, nlevels, normalize, dst_arr);
 		cmp->approxlength(L, nlevels, nlevels, &dst_dim[0]);
 	}
+
+	sigmap->Fill((T) 0, C);
+	czero = true;
+
 	if (rc<0) return(rc);
 
 	if (cmp->ClampMinOnOff() || cmp->ClampMaxOnOff() || cmp->EpsilonOnOff()) {
@@ -391,7 +579,7 @@ int Compressor::Decompress(
 
 	return decompress_template(
 		this, src_arr, dst_arr, (float *) _C, _CLen, _L, 
-		_nlevels, sigmap, _dims
+		_nlevels, sigmap, _dims, _czero
 	);
 } 
 
@@ -403,7 +591,7 @@ int Compressor::Decompress(
 
 	return decompress_template(
 		this, src_arr, dst_arr, (double *) _C, _CLen, _L, 
-		_nlevels, sigmap, _dims
+		_nlevels, sigmap, _dims, _czero
 	);
 } 
 
@@ -415,7 +603,7 @@ int Compressor::Decompress(
 
 	return decompress_template(
 		this, src_arr, dst_arr, (int *) _C, _CLen, _L, 
-		_nlevels, sigmap, _dims
+		_nlevels, sigmap, _dims, _czero
 	);
 } 
 
@@ -427,7 +615,7 @@ int Compressor::Decompress(
 
 	return decompress_template(
 		this, src_arr, dst_arr, (long *) _C, _CLen, _L, 
-		_nlevels, sigmap, _dims
+		_nlevels, sigmap, _dims, _czero
 	);
 } 
 
@@ -444,9 +632,12 @@ int decompose_template(
 	vector <SignificanceMap> &sigmaps,
 	const vector <size_t> &dims,
 	size_t nlevels,
-	vector <void *> indexvec,
-	bool my_compare(const void *, const void *)
+	vector <void *> &indexvec,
+	bool my_compare(const void *, const void *),
+	double &error
 ) {
+	error = 0.0;
+
 	if (! C) {
 		Compressor::SetErrMsg("Invalid state");
 		return(-1);
@@ -501,12 +692,14 @@ int decompose_template(
 	for (int i=0; i<sigmaps.size(); i++) {
 		rc = sigmaps[i].Reshape(clen);
 		if (rc<0) return(-1);
+		rc = sigmaps[i].SetVersion(cmp->SigMapVersion());
+		if (rc<0) return(-1);
 		sigmaps[i].Clear();
 	}
 
-	// Data has been transformed. Now we need to sort it and find
-	// the threshold value. Note: we don't actually move the data. We
-	// sort an index array that references the data array.
+	// Data has been transformed. Now we need to find the largest
+	// coefficients. Note: we don't actually move the data. We
+	// partition an index array that references the data array.
 
 	for (size_t i = 0; i<tlen; i++) dst_arr[i] = 0.0;
 
@@ -518,19 +711,58 @@ int decompose_template(
 			if (rc<0) return(-1);
 			dst_arr[idx] = C[idx];
 		}
-		if (numkeep == tlen) return(0);
+		if (numkeep == tlen) {
+
+			// Only the approximations are retained. Their error still
+			// has to be measured
+			//
+			if (cmp->ErrorBoundOnOff()) {
+				(void) error_bound_search(
+					cmp, src_arr, C, clen, L, nlevels, dims, numkeep, 
+					indexvec, 0, 0, 0.0, error
+				);
+			}
+			return(0);
+		}
 		dst_arr += numkeep;
 		my_dst_arr_lens[0] -= numkeep;
 	}
 
 	//
-	// sort the **indecies** of the coefficients based on the 
-	// coefficient's magnitude
+	// partition the **indecies** of the coefficients based on the 
+	// coefficient's magnitude, so that each set S<sub>i</sub> is 
+	// selected in a single pass
 	//
 	indexvec.clear();
 	for (size_t i=numkeep; i<clen; i++)  indexvec.push_back(&C[i]); 
-    sort(indexvec.begin(), indexvec.end(), my_compare);
+	select_largest(
+		indexvec.begin(), indexvec.end(), my_dst_arr_lens, my_compare
+	);
+
+	// In error bounded mode the coefficients of the final (finest) 
+	// level are limited to as many as needed. Coarser levels are 
+	// unaffected. The search requires the final level's candidates 
+	// sorted by magnitude
+	//
+	if (cmp->ErrorBoundOnOff()) {
+		size_t n = 1;
+		for (int i=0; i<dims.size(); i++) n *= dims[i];
 
+		size_t nfixed = 0;
+		for (int i=0; i<my_dst_arr_lens.size()-1; i++) {
+			nfixed += my_dst_arr_lens[i];
+		}
+		sort(
+			indexvec.begin() + nfixed, 
+			indexvec.begin() + nfixed + my_dst_arr_lens.back(), my_compare
+		);
+
+		my_dst_arr_lens.back() = error_bound_search(
+			cmp, src_arr, C, clen, L, nlevels, dims, numkeep, indexvec, 
+			nfixed, my_dst_arr_lens.back(), error_bound(cmp, src_arr, n),
+			error
+		);
+	}
 	
 	vector <void *>::iterator itr = indexvec.begin();
 	for (int j = 0, idx=0; j<my_dst_arr_lens.size(); j++) {
@@ -559,7 +791,8 @@ int reconstruct_template(
 	int nlevels,
 	int l,
 	vector <SignificanceMap> &sigmaps,
-	const vector <size_t> &dims
+	const vector <size_t> &dims,
+	bool &czero
 ) {
 	if (! C) {
 		Compressor::SetErrMsg("Invalid state");
@@ -571,26 +804,18 @@ int reconstruct_template(
 		return(-1);
 	}
 
-	for (size_t count = 0; count<clen; count++) {
-		C[count] = 0.0;
+	// See decompress_template()
+	//
+	if (! czero) {
+		for (size_t count = 0; count<clen; count++) {
+			C[count] = 0.0;
+		}
 	}
+	czero = false;
 
 	size_t count = 0;
-	size_t idx;
 	for (int j=0; j<sigmaps.size(); j++) {
-		sigmaps[j].GetNextEntryRestart();
-
-		size_t nsig = sigmaps[j].GetNumSignificant();
-		for(size_t i=0; i<nsig; i++) {
-
-			if (! sigmaps[j].GetNextEntry(&idx)) {
-				Compressor::SetErrMsg("Invalid significance map");
-				return(-1);
-			}
-
-			C[idx] = src_arr[count];
-			count++;
-		}
+		count += sigmaps[j].Scatter(src_arr + count, C);
 	}
 
 	bool normalize = cmp->wavelet()->IsNormalized();
@@ -612,6 +837,12 @@ int reconstruct_template(
 		rc = cmp->appcoef(C, L, nlevels, l, normalize, dst_arr);
 		cmp->approxlength(L, nlevels, l, &dst_dim[0]);
 	}
+
+	for (int j=0; j<sigmaps.size(); j++) {
+		sigmaps[j].Fill((T) 0, C);
+	}
+	czero = true;
+
 	if (rc < 0) return(-1);
 
 	if (cmp->ClampMinOnOff() || cmp->ClampMaxOnOff()) {
@@ -636,9 +867,11 @@ int Compressor::Decompose(
 	const float *src_arr, float *dst_arr, const vector <size_t> &dst_arr_lens,
 	vector <SignificanceMap> &sigmaps
 ) {
+	_czero = false;
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (float *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_f
+		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_f,
+		_error
 	);
 }
 
@@ -646,9 +879,11 @@ int Compressor::Decompose(
 	const double *src_arr, double *dst_arr, const vector <size_t> &dst_arr_lens,
 	vector <SignificanceMap> &sigmaps
 ) {
+	_czero = false;
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (double *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_d
+		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_d,
+		_error
 	);
 }
 
@@ -656,9 +891,11 @@ int Compressor::Decompose(
 	const int *src_arr, int *dst_arr, const vector <size_t> &dst_arr_lens,
 	vector <SignificanceMap> &sigmaps
 ) {
+	_czero = false;
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (int *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_i
+		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_i,
+		_error
 	);
 }
 
@@ -666,9 +903,11 @@ int Compressor::Decompose(
 	const long *src_arr, long *dst_arr, const vector <size_t> &dst_arr_lens,
 	vector <SignificanceMap> &sigmaps
 ) {
+	_czero = false;
 	return decompose_template(
 		this, src_arr, dst_arr, dst_arr_lens, (long *) _C, _CLen,
-		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_l
+		_L, sigmaps, _dims, _nlevels, _indexvec, my_compare_l,
+		_error
 	);
 }
 
@@ -679,7 +918,7 @@ int Compressor::Reconstruct(
 	if (l==-1) l = GetNumLevels();
 	return reconstruct_template(
 		this, src_arr, dst_arr, (float *) _C, _CLen, _L, _nlevels, l, sigmaps, 
-		_dims
+		_dims, _czero
 	);
 }
 
@@ -690,7 +929,7 @@ int Compressor::Reconstruct(
 	if (l==-1) l = GetNumLevels();
 	return reconstruct_template(
 		this, src_arr, dst_arr, (double *) _C, _CLen, _L, _nlevels, l, sigmaps, 
-		_dims
+		_dims, _czero
 	);
 }
  
@@ -701,7 +940,7 @@ int Compressor::Reconstruct(
 	if (l==-1) l = GetNumLevels();
 	return reconstruct_template(
 		this, src_arr, dst_arr, (int *) _C, _CLen, _L, _nlevels, l, sigmaps, 
-		_dims
+		_dims, _czero
 	);
 }
 
@@ -712,7 +951,7 @@ int Compressor::Reconstruct(
 	if (l==-1) l = GetNumLevels();
 	return reconstruct_template(
 		this, src_arr, dst_arr, (long *) _C, _CLen, _L, _nlevels, l, sigmaps, 
-		_dims
+		_dims, _czero
 	);
 }
 
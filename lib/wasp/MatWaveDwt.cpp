@@ -4,6 +4,7 @@
 #include <cmath>
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <vapor/MatWaveDwt.h>
 #include <vapor/WaveFiltInt.h>
 #ifdef WIN32
@@ -11,6 +12,26 @@
 #define isfinite _finite
 #endif
 
+// SIMD kernels are compiled for x86-64 with GCC compatible compilers,
+// and selected at run time
+//
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DWT_SIMD_X86
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DWT_INLINE inline __attribute__ ((always_inline))
+#else
+#define DWT_INLINE inline
+#endif
+
+#if defined(__clang__)
+#define DWT_SIMD_TARGET(isa) __attribute__ ((target (isa)))
+#else
+#define DWT_SIMD_TARGET(isa) \
+	__attribute__ ((target (isa), optimize ("fp-contract=off")))
+#endif
+
 using namespace VAPoR;
 using namespace Wasp;
 
@@ -469,6 +490,460 @@ void inverse_xform (
 }
 
 
+//
+// Multi-signal kernels
+//
+// The following operate on 'nlanes' signals at once, stored 
+// interleaved: sample i of signal l is found at sig[i*nlanes + l]. The
+// signals are processed in groups of as many lanes as fit in a VEC, 
+// with every lane performing exactly the same sequence of floating
+// point operations as forward_xform() and inverse_xform(), so results
+// are bit-for-bit identical. Products and sums are kept in separate 
+// statements, and the SIMD variants are compiled without floating 
+// point contraction, so that no fused multiply-adds are generated.
+//
+
+// Number of signals filtered together by the multi-signal transforms.
+// Sized so that the working set for a block fits in L1 cache
+//
+const size_t rowsLanes = 16;
+
+#ifdef DWT_SIMD_X86
+typedef double v2df_t __attribute__ ((vector_size (16)));
+typedef double v4df_t __attribute__ ((vector_size (32)));
+typedef double v8df_t __attribute__ ((vector_size (64)));
+#endif
+
+template <class VEC>
+DWT_INLINE void forward_xform_lanes(
+	const double *sigIn, size_t sigInLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *cA, double *cD, bool oddlow, bool oddhigh,
+	size_t nlanes, size_t l
+) {
+	size_t xlstart = oddlow ? 1 : 0;
+	size_t xhstart = oddhigh ? 1 : 0;
+
+	for (size_t yi = 0; yi < sigInLen; yi += 2) {
+		VEC a = VEC();
+		VEC d = VEC();
+
+		const double *sl = sigIn + xlstart*nlanes + l;
+		const double *sh = sigIn + xhstart*nlanes + l;
+
+		for (int k = filterLen - 1; k >= 0; k--) {
+			VEC s, p;
+			memcpy(&s, sl, sizeof(s));
+			p = low_filter[k] * s;
+			a = a + p;
+
+			memcpy(&s, sh, sizeof(s));
+			p = high_filter[k] * s;
+			d = d + p;
+
+			sl += nlanes;
+			sh += nlanes;
+		}
+		memcpy(cA + (yi>>1)*nlanes + l, &a, sizeof(a));
+		memcpy(cD + (yi>>1)*nlanes + l, &d, sizeof(d));
+
+		xlstart+=2;
+		xhstart+=2;
+	}
+}
+
+template <class VEC>
+DWT_INLINE void inverse_xform_even_lanes(
+	const double *cA, const double *cD, size_t sigOutLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *sigOut, bool matlab, size_t nlanes, size_t l
+) {
+	size_t xi;
+	int k;
+
+	for (size_t yi = 0; yi < sigOutLen; yi++ ) {
+		VEC sum = VEC();
+
+		if (matlab  || (filterLen>>1)%2) { // odd length half filter
+			xi = yi >> 1;
+			k = (yi % 2) ? filterLen - 1 : filterLen - 2;
+		} else {
+			xi = (yi+1) >> 1;
+			k = (yi % 2) ? filterLen - 2 : filterLen - 1;
+		}
+
+		for (; k >= 0; k-=2) {
+			VEC a, d, p, q;
+			memcpy(&a, cA + xi*nlanes + l, sizeof(a));
+			memcpy(&d, cD + xi*nlanes + l, sizeof(d));
+			p = low_filter[k] * a;
+			q = high_filter[k] * d;
+			p = p + q;
+			sum = sum + p;
+			xi++;
+		}
+		memcpy(sigOut + yi*nlanes + l, &sum, sizeof(sum));
+	}
+}
+
+template <class VEC>
+DWT_INLINE void inverse_xform_odd_lanes(
+	const double *cA, const double *cD, size_t sigOutLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *sigOut, size_t nlanes, size_t l
+) {
+	size_t xi;
+	int k;
+
+	for (size_t yi = 0; yi < sigOutLen; yi++ ) {
+		VEC sum = VEC();
+
+		xi = (yi+1) >> 1;
+		k = (yi % 2) ? filterLen - 2 : filterLen - 1;
+		for (; k >= 0; k-=2) {
+			VEC a, p;
+			memcpy(&a, cA + xi*nlanes + l, sizeof(a));
+			p = low_filter[k] * a;
+			sum = sum + p;
+			xi++;
+		}
+
+		xi = (yi) >> 1;
+		k = (yi % 2) ? filterLen - 1 : filterLen - 2;
+		for (; k >= 0; k-=2) {
+			VEC d, p;
+			memcpy(&d, cD + xi*nlanes + l, sizeof(d));
+			p = high_filter[k] * d;
+			sum = sum + p;
+			xi++;
+		}
+		memcpy(sigOut + yi*nlanes + l, &sum, sizeof(sum));
+	}
+}
+
+// Filter all lanes, a VEC at a time, finishing any remaining lanes
+// one at a time
+//
+template <class VEC>
+DWT_INLINE void forward_xform_rows(
+	const double *sigIn, size_t sigInLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *cA, double *cD, bool oddlow, bool oddhigh,
+	size_t nlanes
+) {
+	const size_t w = sizeof(VEC) / sizeof(double);
+
+	size_t l = 0;
+	for (; l + w <= nlanes; l += w) {
+		forward_xform_lanes<VEC>(
+			sigIn, sigInLen, low_filter, high_filter, filterLen, 
+			cA, cD, oddlow, oddhigh, nlanes, l
+		);
+	}
+	for (; l < nlanes; l++) {
+		forward_xform_lanes<double>(
+			sigIn, sigInLen, low_filter, high_filter, filterLen, 
+			cA, cD, oddlow, oddhigh, nlanes, l
+		);
+	}
+}
+
+template <class VEC>
+DWT_INLINE void inverse_xform_rows(
+	const double *cA, const double *cD, size_t sigOutLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *sigOut, bool matlab, size_t nlanes
+) {
+	const size_t w = sizeof(VEC) / sizeof(double);
+
+	size_t l = 0;
+	for (; l + w <= nlanes; l += w) {
+		if (filterLen % 2) {
+			inverse_xform_odd_lanes<VEC>(
+				cA, cD, sigOutLen, low_filter, high_filter, filterLen, 
+				sigOut, nlanes, l
+			);
+		}
+		else {
+			inverse_xform_even_lanes<VEC>(
+				cA, cD, sigOutLen, low_filter, high_filter, filterLen, 
+				sigOut, matlab, nlanes, l
+			);
+		}
+	}
+	for (; l < nlanes; l++) {
+		if (filterLen % 2) {
+			inverse_xform_odd_lanes<double>(
+				cA, cD, sigOutLen, low_filter, high_filter, filterLen, 
+				sigOut, nlanes, l
+			);
+		}
+		else {
+			inverse_xform_even_lanes<double>(
+				cA, cD, sigOutLen, low_filter, high_filter, filterLen, 
+				sigOut, matlab, nlanes, l
+			);
+		}
+	}
+}
+
+typedef void (*forward_rows_t)(
+	const double *sigIn, size_t sigInLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *cA, double *cD, bool oddlow, bool oddhigh,
+	size_t nlanes
+);
+
+typedef void (*inverse_rows_t)(
+	const double *cA, const double *cD, size_t sigOutLen, 
+	const double *low_filter, const double *high_filter, 
+	int filterLen, double *sigOut, bool matlab, size_t nlanes
+);
+
+// Instantiate a forward and inverse kernel for vector type VEC, 
+// compiled with the function attributes ATTR
+//
+#define DWT_ROWS_KERNELS(NAME, VEC, ATTR) \
+ATTR void forward_xform_rows_##NAME( \
+	const double *sigIn, size_t sigInLen, \
+	const double *low_filter, const double *high_filter, \
+	int filterLen, double *cA, double *cD, bool oddlow, bool oddhigh, \
+	size_t nlanes \
+) { \
+	forward_xform_rows<VEC>( \
+		sigIn, sigInLen, low_filter, high_filter, filterLen, \
+		cA, cD, oddlow, oddhigh, nlanes \
+	); \
+} \
+ATTR void inverse_xform_rows_##NAME( \
+	const double *cA, const double *cD, size_t sigOutLen, \
+	const double *low_filter, const double *high_filter, \
+	int filterLen, double *sigOut, bool matlab, size_t nlanes \
+) { \
+	inverse_xform_rows<VEC>( \
+		cA, cD, sigOutLen, low_filter, high_filter, filterLen, \
+		sigOut, matlab, nlanes \
+	); \
+}
+
+DWT_ROWS_KERNELS(generic, double, )
+
+#ifdef DWT_SIMD_X86
+DWT_ROWS_KERNELS(sse2, v2df_t, DWT_SIMD_TARGET("sse2"))
+DWT_ROWS_KERNELS(avx2, v4df_t, DWT_SIMD_TARGET("avx2"))
+DWT_ROWS_KERNELS(avx512, v8df_t, DWT_SIMD_TARGET("avx512f"))
+#endif
+
+MatWaveDwt::simd_t detect_simd() {
+#ifdef DWT_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return(MatWaveDwt::SIMD_AVX512);
+	if (__builtin_cpu_supports("avx2")) return(MatWaveDwt::SIMD_AVX2);
+	return(MatWaveDwt::SIMD_SSE2);
+#else
+	return(MatWaveDwt::SIMD_GENERIC);
+#endif
+}
+
+// Instruction set selected with MatWaveDwt::SetSIMD()
+//
+MatWaveDwt::simd_t &simd_selected() {
+	static MatWaveDwt::simd_t simd = MatWaveDwt::GetSIMDSupported();
+	return(simd);
+}
+
+void rows_kernels(forward_rows_t &forward, inverse_rows_t &inverse) {
+	switch (simd_selected()) {
+#ifdef DWT_SIMD_X86
+	case MatWaveDwt::SIMD_AVX512:
+		forward = forward_xform_rows_avx512;
+		inverse = inverse_xform_rows_avx512;
+		break;
+	case MatWaveDwt::SIMD_AVX2:
+		forward = forward_xform_rows_avx2;
+		inverse = inverse_xform_rows_avx2;
+		break;
+	case MatWaveDwt::SIMD_SSE2:
+		forward = forward_xform_rows_sse2;
+		inverse = inverse_xform_rows_sse2;
+		break;
+#endif
+	default:
+		forward = forward_xform_rows_generic;
+		inverse = inverse_xform_rows_generic;
+		break;
+	}
+}
+
+// Use the multi-signal transforms for intermediate type V?
+//
+template <class V>
+bool use_rows(V dummy) {
+	return(
+		! std::numeric_limits<V>::is_integer && 
+		simd_selected() != MatWaveDwt::SIMD_NONE
+	);
+}
+
+//
+// Boundary extension of 'nlanes' signals at once. Sample i of signal l 
+// is read from sigIn[i*stride + l], and written to 
+// sigOut[i*nlanes + l]. Samples are converted to U before any 
+// arithmetic is performed. Otherwise identical to wextend_1D_center()
+//
+template <class T, class U>
+void wextend_rows (
+	const T *sigIn, size_t sigInLen, size_t stride,
+	U *sigOut, size_t addLen, size_t nlanes,
+	MatWaveBase::dwtmode_t leftExtMethod,
+	MatWaveBase::dwtmode_t rightExtMethod
+) {
+	auto zero = [&](size_t o) {
+		for (size_t l=0; l<nlanes; l++) sigOut[o*nlanes + l] = 0;
+	};
+	auto copy = [&](size_t o, size_t i) {
+		for (size_t l=0; l<nlanes; l++) {
+			sigOut[o*nlanes + l] = (U) sigIn[i*stride + l];
+		}
+	};
+	auto negate = [&](size_t o, size_t i) {
+		for (size_t l=0; l<nlanes; l++) {
+			sigOut[o*nlanes + l] = (U) sigIn[i*stride + l] * (-1);
+		}
+	};
+	auto slope = [&](size_t o, size_t i0, size_t i1, size_t n) {
+		for (size_t l=0; l<nlanes; l++) {
+			U a0 = sigIn[i0*stride + l];
+			U a1 = sigIn[i1*stride + l];
+			sigOut[o*nlanes + l] = a0 - (a1 - a0)*n;
+		}
+	};
+
+	int count = 0;
+
+	for (count = 0; count < addLen; count++) {
+		zero(count);
+		zero(count + sigInLen + addLen);
+	}
+
+	for (count = 0; count < sigInLen; count++) {
+		copy(count + addLen, count);
+	}
+
+	if (! addLen) return;
+
+	switch (leftExtMethod) {
+	case MatWaveBase::ZPD: break;
+	case MatWaveBase::SYMH:
+		for (count = 0; count < addLen; count++) {
+			copy(count, addLen - count - 1);
+		}
+		break;
+	case MatWaveBase::SYMW:
+		for (count = 0; count < addLen; count++) {
+			copy(count, addLen - count);
+		}
+		break;
+	case MatWaveBase::ASYMH:
+		for (count = 0; count < addLen; count++) {
+			negate(count, addLen - count - 1);
+		}
+		break;
+	case MatWaveBase::ASYMW:
+		for (count = 0; count < addLen; count++) {
+			negate(count, addLen - count);
+		}
+		break;
+	case MatWaveBase::SP0:
+		for (count = 0; count < addLen; count++) {
+			copy(count, 0);
+		}
+		break;
+	case MatWaveBase::SP1:
+		for (count = (addLen - 1); count >= 0; count--) {
+			slope(count, 0, 1, addLen - count);
+		}
+		break;
+	case MatWaveBase::PPD:
+		for (count = 0; count < addLen; count++) {
+			copy(count, sigInLen - addLen + count);
+		}
+		break;
+	case MatWaveBase::PER:
+		if (sigInLen%2 == 0) {
+			for (count = 0; count < addLen; count++) {
+				copy(count, sigInLen - addLen + count);
+			}
+		}
+		else {
+			copy(addLen-1, sigInLen-1);
+			addLen--;
+			for (count = 0; count < addLen; count++) {
+				copy(count, sigInLen - addLen + count);
+			}
+		}
+		break;
+	default: break;
+	}
+
+	switch (rightExtMethod) {
+	case MatWaveBase::ZPD: break;
+	case MatWaveBase::SYMH:
+		for (count = 0; count < addLen; count++) {
+			copy(count + sigInLen + addLen, sigInLen - count - 1);
+		}
+		break;
+	case MatWaveBase::SYMW:
+		for (count = 0; count < addLen; count++) {
+			copy(count + sigInLen + addLen, sigInLen - count - 2);
+		}
+		break;
+	case MatWaveBase::ASYMH:
+		for (count = 0; count < addLen; count++) {
+			negate(count + sigInLen + addLen, sigInLen - count - 1);
+		}
+		break;
+	case MatWaveBase::ASYMW:
+		for (count = 0; count < addLen; count++) {
+			negate(count + sigInLen + addLen, sigInLen - count - 2);
+		}
+		break;
+	case MatWaveBase::SP0:
+		for (count = 0; count < addLen; count++) {
+			copy(count + sigInLen + addLen, sigInLen - 1);
+		}
+		break;
+	case MatWaveBase::SP1:
+		for (count = (addLen - 1); count >= 0; count--) {
+			slope(
+				sigInLen + 2 * addLen - count - 1, sigInLen - 1, sigInLen - 2,
+				addLen - count
+			);
+		}
+		break;
+	case MatWaveBase::PPD:
+		for (count = 0; count < addLen; count++) {
+			copy(count + sigInLen + addLen, count);
+		}
+		break;
+	case MatWaveBase::PER:
+		if (sigInLen%2 == 0) {
+			for (count = 0; count < addLen; count++) {
+				copy(count + sigInLen + addLen, count);
+			}
+		}
+		else {
+			copy(addLen + sigInLen, sigInLen - 1);
+			addLen--;
+			for (count = 0; count < addLen; count++) {
+				copy(count + sigInLen + addLen + 2, count);
+			}
+		}
+		break;
+	default: break;
+	}
+}
+
 #define Minimum(a,b) ((a<b)?a:b)
 #define BlockSize 32
 
@@ -536,6 +1011,22 @@ MatWaveDwt::MatWaveDwt(const string &wname ) : MatWaveBase(wname) {
 MatWaveDwt::~MatWaveDwt() {
 }
 
+void MatWaveDwt::SetSIMD(simd_t simd) {
+	simd_t supported = GetSIMDSupported();
+
+	if (simd > supported) simd = supported;
+	simd_selected() = simd;
+}
+
+MatWaveDwt::simd_t MatWaveDwt::GetSIMD() {
+	return(simd_selected());
+}
+
+MatWaveDwt::simd_t MatWaveDwt::GetSIMDSupported() {
+	static simd_t supported = detect_simd();
+	return(supported);
+}
+
 template <class T, class U, class V>
 int dwt_template(
 	MatWaveDwt *dwt,
@@ -1033,6 +1524,282 @@ int MatWaveDwt::idwt(
 	);
 } 
 
+//
+// Single-level forward transform of 'nsig' signals at once. Sample i 
+// of signal j is read from sigIn[i*stride + j]. The approximation and
+// detail coefficients of signal j are returned in cA[i*cstride + j]
+// and cD[i*cstride + j]. Results are identical to transforming each 
+// signal with dwt_template()
+//
+template <class T, class U>
+int dwt_rows_template(
+	MatWaveDwt *dwt,
+	const T *sigIn, size_t sigInLen, size_t nsig, size_t stride,
+	const WaveFiltBase *wf, MatWaveBase::dwtmode_t mode,
+	U *cA, U *cD, size_t cstride, SmartBuf &sbuf
+) {
+	if (! wf) {
+		MatWaveDwt::SetErrMsg("Invalid state, no wavelet");
+		return(-1);
+	}
+
+	if (dwt->wmaxlev(sigInLen) < 1) {
+		MatWaveDwt::SetErrMsg("Can't transform signal of length : %d", sigInLen);
+		return(-1);
+	}
+	if (mode == MatWaveBase::PER) {
+		MatWaveDwt::SetErrMsg("Invalid boundary extension mode: %d", mode);
+		return(-1);
+	}
+
+	size_t L[3];
+	L[0] = dwt->approxlength(sigInLen);
+	L[1] = dwt->detaillength(sigInLen);
+	L[2] = sigInLen;
+
+	int filterLen = wf->GetLength();
+
+	bool do_sym_conv = false;
+	if (wf->issymmetric()) {
+		if (
+			(mode == MatWaveBase::SYMW && (filterLen % 2)) ||
+			(mode == MatWaveBase::SYMH && (! (filterLen % 2)))
+		)  {
+		
+			do_sym_conv = true;
+		}
+	}
+
+	size_t sigConvolvedLen =  L[0] + L[1];
+	size_t extendLen;
+
+	bool oddlow = true;
+	bool oddhigh = true;
+	if (filterLen % 2) oddlow = false;
+	if (do_sym_conv) {
+		extendLen = filterLen>>1;
+		if (sigInLen % 2) sigConvolvedLen += 1;
+	}
+	else {
+		extendLen = filterLen-1;
+	}
+	size_t sigExtendedLen = sigInLen + (2*extendLen);
+
+	// Buffers are laid out as in dwt_template(), with every sample 
+	// widened to a row of lanes
+	//
+	size_t nlanes = min(nsig, rowsLanes);
+	double *buf = (double *) sbuf.Alloc(
+		sizeof(double) * nlanes * (sigExtendedLen + sigConvolvedLen)
+	);
+
+	forward_rows_t forward;
+	inverse_rows_t inverse;
+	rows_kernels(forward, inverse);
+
+	for (size_t j0 = 0; j0 < nsig; j0 += nlanes) {
+		size_t nl = min(nlanes, nsig - j0);
+
+		double *sigExtended = buf;
+		double *sigConvolved = sigExtended + (nl * sigExtendedLen);
+
+		wextend_rows(
+			sigIn + j0, sigInLen, stride, sigExtended, extendLen, nl, 
+			mode, mode
+		);
+
+		int rc = valid_float(
+			sigExtended, nl * sigExtendedLen, dwt->InvalidFloatAbortOnOff()
+		);
+		if (rc<0) return(-1);
+
+		forward(
+			sigExtended, L[0]+L[1], wf->GetLowDecomFilCoef(),
+			wf->GetHighDecomFilCoef(), filterLen, 
+			sigConvolved, sigConvolved + (nl * L[0]), oddlow, oddhigh, nl
+		);
+
+		for (size_t i=0; i<L[0]; i++) {
+			for (size_t l=0; l<nl; l++) {
+				cA[i*cstride + j0 + l] = sigConvolved[i*nl + l];
+			}
+		}
+		for (size_t i=0; i<L[1]; i++) {
+			for (size_t l=0; l<nl; l++) {
+				cD[i*cstride + j0 + l] = sigConvolved[(i+L[0])*nl + l];
+			}
+		}
+	}
+
+	return(0);
+}
+
+//
+// Single-level inverse transform of 'nsig' signals at once. The 
+// approximation and detail coefficients of signal j are read from
+// cA[i*cstride + j] and cD[i*cstride + j]. Sample i of reconstructed 
+// signal j is returned in sigOut[i*stride + j]. Results are identical
+// to transforming each signal with idwt_template()
+//
+template <class T, class U>
+int idwt_rows_template(
+	MatWaveDwt *dwt,
+	const T *cA, const T *cD, size_t cstride, const size_t L[3], 
+	size_t nsig, const WaveFiltBase *wf, MatWaveBase::dwtmode_t mode, 
+	U *sigOut, size_t stride, SmartBuf &sbuf
+) {
+	if (! wf) {
+		MatWaveDwt::SetErrMsg("Invalid state, no wavelet");
+		return(-1);
+	}
+	if (mode == MatWaveBase::PER) {
+		MatWaveDwt::SetErrMsg("Invalid boundary extension mode: %d", mode);
+		return(-1);
+	}
+
+	int filterLen = wf->GetLength();
+
+	bool do_sym_conv = false;
+	MatWaveBase::dwtmode_t cALeftMode = mode;
+	MatWaveBase::dwtmode_t cARightMode = mode;
+	MatWaveBase::dwtmode_t cDLeftMode = mode;
+	MatWaveBase::dwtmode_t cDRightMode = mode;
+	if (wf->issymmetric()) {
+		if (
+			(mode == MatWaveBase::SYMW && (filterLen % 2)) ||
+			(mode == MatWaveBase::SYMH && (! (filterLen % 2)))
+		)  {
+
+			if (mode == MatWaveBase::SYMH) {
+				cDLeftMode = MatWaveBase::ASYMH;
+				if (L[2]%2) {
+					cARightMode = MatWaveBase::SYMW;
+					cDRightMode = MatWaveBase::ASYMW;
+				}
+				else {
+					cDRightMode = MatWaveBase::ASYMH;
+				}
+			}
+			else {
+				cDLeftMode = MatWaveBase::SYMH;
+				if (L[2]%2) {
+					cARightMode = MatWaveBase::SYMW;
+					cDRightMode = MatWaveBase::SYMH;
+				}
+				else {
+					cARightMode = MatWaveBase::SYMH;
+				}
+			}
+		
+			do_sym_conv = true;
+		}
+	}
+
+	size_t cATempLen, cDTempLen, reconTempLen;
+
+	size_t extendLen = 0;
+	size_t cDPadLen = 0;
+	if (do_sym_conv) {
+		extendLen = filterLen>>2;
+		if ((L[0] > L[1]) && (mode == MatWaveBase::SYMH)) cDPadLen = L[0];
+
+		cATempLen = L[0] + (2*extendLen);
+
+		if (filterLen % 2) {
+			cDTempLen = L[1] + (2*extendLen);
+		}
+		else {
+			cDTempLen = cATempLen;
+		}
+	} else {
+		cATempLen = L[0];
+		cDTempLen = L[1];
+	}
+	reconTempLen = L[2];
+	if (reconTempLen % 2) reconTempLen++;
+
+	// Buffers are laid out as in idwt_template(), with every sample 
+	// widened to a row of lanes
+	//
+	size_t nlanes = min(nsig, rowsLanes);
+	double *buf = (double *) sbuf.Alloc(
+		sizeof(double) * nlanes * 
+		(cATempLen + cDTempLen + reconTempLen + cDPadLen)
+	);
+
+	forward_rows_t forward;
+	inverse_rows_t inverse;
+	rows_kernels(forward, inverse);
+
+	for (size_t j0 = 0; j0 < nsig; j0 += nlanes) {
+		size_t nl = min(nlanes, nsig - j0);
+
+		double *cATemp = buf;
+		double *cDTemp = cATemp + (nl * cATempLen);
+		double *reconTemp = cDTemp + (nl * cDTempLen);
+		double *cDPad = reconTemp + (nl * reconTempLen);
+
+		if (do_sym_conv) {
+			wextend_rows(
+				cA + j0, L[0], cstride, cATemp, extendLen, nl,
+				cALeftMode, cARightMode
+			);
+
+			if (cDPadLen) {
+				for (size_t i=0; i<L[1]; i++) {
+					for (size_t l=0; l<nl; l++) {
+						cDPad[i*nl + l] = cD[i*cstride + j0 + l];
+					}
+				}
+				for (size_t l=0; l<nl; l++) cDPad[L[1]*nl + l] = 0.0;
+
+				wextend_rows(
+					cDPad, L[0], nl, cDTemp, extendLen, nl, 
+					cDLeftMode, cDRightMode
+				);
+			}
+			else {
+				wextend_rows(
+					cD + j0, L[1], cstride, cDTemp, extendLen, nl,
+					cDLeftMode, cDRightMode
+				);
+			}
+		}
+		else {
+			wextend_rows(
+				cA + j0, L[0], cstride, cATemp, 0, nl, cALeftMode, cARightMode
+			);
+			wextend_rows(
+				cD + j0, L[1], cstride, cDTemp, 0, nl, cDLeftMode, cDRightMode
+			);
+		}
+
+		int rc = valid_float(
+			cATemp, nl * cATempLen, dwt->InvalidFloatAbortOnOff()
+		);
+		if (rc<0) return(-1);
+
+		rc = valid_float(
+			cDTemp, nl * cDTempLen, dwt->InvalidFloatAbortOnOff()
+		);
+		if (rc<0) return(-1);
+
+		inverse(
+			cATemp, cDTemp, L[2], wf->GetLowReconFilCoef(), 
+			wf->GetHighReconFilCoef(), filterLen, reconTemp, ! do_sym_conv,
+			nl
+		);
+
+		for (size_t i=0; i<L[2]; i++) {
+			for (size_t l=0; l<nl; l++) {
+				sigOut[i*stride + j0 + l] = (U) reconTemp[i*nl + l];
+			}
+		}
+	}
+
+	return(0);
+}
+
 template <class T, class U, class V>
 int dwt2d_template(
 	MatWaveDwt *dwt,
@@ -1112,6 +1879,23 @@ int dwt2d_template(
 	// detail coefficients
 	//
 
+	// Columns are interleaved in memory, so filter several at once 
+	// when possible, avoiding the transposes
+	//
+	if (use_rows(dummy)) {
+		rc = dwt_rows_template(
+			dwt, cAXbuf, sigInY, L[0], L[0], wf, mode, cA, cDh, L[0], sbuf1d
+		);
+		if (rc < 0) return(-1);
+
+		rc = dwt_rows_template(
+			dwt, cDXbuf, sigInY, L[4], L[4], wf, mode, cDv, cDd, L[4], sbuf1d
+		);
+		if (rc < 0) return(-1);
+
+		return(0);
+	}
+
 	transpose(cAXbuf, buftranspose, L[0], sigInY);
 
 	for (size_t y = 0; y<L[0]; y++) {
@@ -1309,47 +2093,64 @@ int idwt2d_template(
 	// First: transform columns. First detail coefficients, then
 	// approximation coefficients
 	//
+	int rc; 
 
-	// cDv and cDd detail coefficients
+	// Columns are interleaved in memory, so filter several at once 
+	// when possible, avoiding the transposes
 	//
-
-	transpose(cDv, cAYbuf, L[4], L[1]);
-	transpose(cDd, cDYbuf, L[4], L[3]);
-	int rc; 
-	for (size_t y = 0; y<L[4]; y++) {
+	if (use_rows(dummy)) {
 		size_t yL[3] = {L[1], L[3], L[9]};
-		const V *cAptr = &cAYbuf[L[1]*y];
-		const V *cDptr = &cDYbuf[L[3]*y];
-		V *row = &buftranspose[L[9]*y];
+		rc = idwt_rows_template(
+			dwt, cDv, cDd, L[4], yL, L[4], wf, mode, cDXbuf, L[4], sbuf1d
+		);
+		if (rc < 0) return (-1);
 
-		rc = idwt_template(
-			dwt, cAptr, cDptr, yL, wf, mode, row,
-			sbuf1d, dummy
+		rc = idwt_rows_template(
+			dwt, cA, cDh, L[0], yL, L[0], wf, mode, cAXbuf, L[0], sbuf1d
 		);
 		if (rc < 0) return (-1);
 	}
-	transpose(buftranspose, cDXbuf, L[9], L[4]);
-	//printmatrix2d("cDXbuf", cDXbuf, L[4], L[9]);
+	else {
+		// cDv and cDd detail coefficients
+		//
 
+		transpose(cDv, cAYbuf, L[4], L[1]);
+		transpose(cDd, cDYbuf, L[4], L[3]);
+		for (size_t y = 0; y<L[4]; y++) {
+			size_t yL[3] = {L[1], L[3], L[9]};
+			const V *cAptr = &cAYbuf[L[1]*y];
+			const V *cDptr = &cDYbuf[L[3]*y];
+			V *row = &buftranspose[L[9]*y];
 
-	// cA approximation and cDh detail coefficients
-	//
+			rc = idwt_template(
+				dwt, cAptr, cDptr, yL, wf, mode, row,
+				sbuf1d, dummy
+			);
+			if (rc < 0) return (-1);
+		}
+		transpose(buftranspose, cDXbuf, L[9], L[4]);
+		//printmatrix2d("cDXbuf", cDXbuf, L[4], L[9]);
 
-	transpose(cA, cAYbuf, L[0], L[1]);
-	transpose(cDh, cDYbuf, L[0], L[3]);
-	for (size_t y = 0; y<L[0]; y++) {
-		size_t yL[3] = {L[1], L[3], L[9]};
-		const V *cAptr = &cAYbuf[L[1]*y];
-		const V *cDptr = &cDYbuf[L[3]*y];
-		V *row = &buftranspose[L[9]*y];
 
-		rc = idwt_template(
-			dwt, cAptr, cDptr, yL, wf, mode, row,
-			sbuf1d, dummy
-		);
-		if (rc < 0) return (-1);
+		// cA approximation and cDh detail coefficients
+		//
+
+		transpose(cA, cAYbuf, L[0], L[1]);
+		transpose(cDh, cDYbuf, L[0], L[3]);
+		for (size_t y = 0; y<L[0]; y++) {
+			size_t yL[3] = {L[1], L[3], L[9]};
+			const V *cAptr = &cAYbuf[L[1]*y];
+			const V *cDptr = &cDYbuf[L[3]*y];
+			V *row = &buftranspose[L[9]*y];
+
+			rc = idwt_template(
+				dwt, cAptr, cDptr, yL, wf, mode, row,
+				sbuf1d, dummy
+			);
+			if (rc < 0) return (-1);
+		}
+		transpose(buftranspose, cAXbuf, L[9], L[0]);
 	}
-	transpose(buftranspose, cAXbuf, L[9], L[0]);
 
 	//
 	//  Second: tranform rows
@@ -1498,6 +2299,16 @@ int _dwtz_template(
 	size_t cALen = dwt->approxlength(sigInZ); 
 	size_t cDLen = dwt->detaillength(sigInZ);
 
+	// Signals along Z are interleaved in memory, so filter several at
+	// once when possible, avoiding the transposes
+	//
+	if (use_rows(dummy)) {
+		return(dwt_rows_template(
+			dwt, sigIn, sigInZ, sigInX*sigInY, sigInX*sigInY, wf, mode,
+			cA, cD, sigInX*sigInY, sbuf1d
+		));
+	}
+
 	size_t sigInLen = sigInX * sigInY * sigInZ;
 	size_t sigOutLen = sigInX * sigInY * (cALen + cDLen);
 
@@ -1770,6 +2581,17 @@ int _idwtz_template(
 	}
 
 
+	// Signals along Z are interleaved in memory, so filter several at
+	// once when possible, avoiding the transposes
+	//
+	if (use_rows(dummy)) {
+		size_t zL[3] = {cALen, cDLen, sigOutZ};
+		return(idwt_rows_template(
+			dwt, cA, cD, sigInX*sigInY, zL, sigInX*sigInY, wf, mode,
+			sigOut, sigInX*sigInY, sbuf1d
+		));
+	}
+
 	size_t sigInLen = sigInX * sigInY * (cALen + cDLen);
 	size_t sigOutLen = sigInX * sigInY * sigOutZ;
 
@@ -4,6 +4,13 @@
 #include <iterator>
 #include "vapor/NetCDFCpp.h"
 #include "vapor/MatWaveBase.h"
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace VAPoR;
 
@@ -20,9 +27,16 @@ using namespace VAPoR;
 NetCDFCpp::NetCDFCpp() {
 	_ncid = -1;
 	_path.clear();
+	_mode = NC_NOWRITE;
+	_map = NULL;
+	_mapLen = 0;
+	_mapFailed = false;
+	_recSize = 0;
+	_numRecs = 0;
 }
 
 NetCDFCpp::~NetCDFCpp() {
+	_unmapFile();
 }
 
 
@@ -41,6 +55,7 @@ int NetCDFCpp::Create(
 
 	_path = path;
 	_ncid = ncid;
+	_mode = NC_WRITE;
 
 	return(NC_NOERR);
 }
@@ -60,6 +75,7 @@ int NetCDFCpp::Open(
 
 	_path = path;
 	_ncid = ncid;
+	_mode = mode;
 
 	return(NC_NOERR);
 }
@@ -84,6 +100,8 @@ int NetCDFCpp::ReDef() const {
 }
 
 int NetCDFCpp::Close() {
+	_unmapFile();
+
 	if (_ncid < 0) return(NC_NOERR);
 
 	int rc = nc_close(_ncid);
@@ -123,6 +141,38 @@ int NetCDFCpp::DefVar(
 	return(NC_NOERR);
 }
 
+int NetCDFCpp::DefVarDeflate(string name, bool shuffle, int deflate_level) {
+
+	int varid;
+	int rc = NetCDFCpp::InqVarid(name, varid);
+	if (rc<0) return(rc);
+
+	rc = nc_def_var_deflate(
+		_ncid, varid, shuffle ? 1 : 0, deflate_level > 0 ? 1 : 0, 
+		deflate_level
+	);
+	MY_NC_ERR(rc, _path, "nc_def_var_deflate("+ name +")");
+	return(NC_NOERR);
+}
+
+int NetCDFCpp::DefVarChunking(string name, vector <size_t> chunksizes) {
+
+	int varid;
+	int rc = NetCDFCpp::InqVarid(name, varid);
+	if (rc<0) return(rc);
+
+	rc = nc_def_var_chunking(_ncid, varid, NC_CHUNKED, chunksizes.data());
+	MY_NC_ERR(rc, _path, "nc_def_var_chunking("+ name +")");
+	return(NC_NOERR);
+}
+
+int NetCDFCpp::InqFormat(int &format) const {
+
+	int rc = nc_inq_format(_ncid, &format);
+	MY_NC_ERR(rc, _path, "nc_inq_format()");
+	return(NC_NOERR);
+}
+
 
 int NetCDFCpp::InqVarDims(
     string name, vector <string> &dimnames, vector <size_t> &dims
@@ -1200,6 +1250,16 @@ bool NetCDFCpp::InqDimDefined(string dimname) {
 	return(false);
 }
 
+bool NetCDFCpp::InqVarDefined(string varname) const {
+
+	int dummy;
+	int rc = nc_inq_varid(_ncid, varname.c_str(), &dummy);
+
+	if (rc == NC_NOERR) return(true);
+
+	return(false);
+}
+
 bool NetCDFCpp::InqAttDefined(string varname, string attname) {
 
 	int varid = -1;
@@ -1240,3 +1300,335 @@ int NetCDFCpp::InqVarnames(vector <string> &varnames) const {
 	return(0);
 }
 
+
+namespace {
+
+// Sequential reader for the header of a classic format file. All
+// values are big-endian. See the netCDF "File Format Specification".
+//
+class header_reader {
+public:
+ header_reader(const unsigned char *buf, size_t len, int version) :
+	_buf(buf), _len(len), _pos(0), _version(version), _ok(true) {}
+
+ bool ok() const { return(_ok); }
+
+ void fail() { _ok = false; }
+
+ size_t get(int nbytes) {
+	if (_pos + nbytes > _len) { _ok = false; return(0); }
+	size_t v = 0;
+	for (int i=0; i<nbytes; i++) v = (v << 8) | _buf[_pos++];
+	return(v);
+ }
+
+ // NON_NEG values are 64 bits in CDF-5, 32 bits otherwise
+ //
+ size_t get_nonneg() { return(get(_version == 5 ? 8 : 4)); }
+
+ // OFFSET values are 32 bits only in CDF-1
+ //
+ size_t get_offset() { return(get(_version == 1 ? 4 : 8)); }
+
+ void skip(size_t nbytes) {
+	nbytes = ((nbytes + 3) / 4) * 4;	// padded to 4 byte boundary
+	if (_pos + nbytes > _len) { _ok = false; return; }
+	_pos += nbytes;
+ }
+
+ string get_name() {
+	size_t n = get_nonneg();
+	if (! _ok || _pos + n > _len) { _ok = false; return(""); }
+	string name((const char *) _buf + _pos, n);
+	skip(n);
+	return(name);
+ }
+
+ void skip_atts() {
+	size_t tag = get(4);
+	size_t natts = get_nonneg();
+	if (tag == 0) return;	// ABSENT
+	for (size_t i=0; i<natts && _ok; i++) {
+		(void) get_name();
+		nc_type xtype = (nc_type) get(4);
+		size_t nelems = get_nonneg();
+		skip(nelems * NetCDFCpp::SizeOf(xtype));
+	}
+ }
+
+private:
+ const unsigned char *_buf;
+ size_t _len;
+ size_t _pos;
+ int _version;
+ bool _ok;
+};
+
+// Multiply 'a' by 'b' in place. Returns false on overflow
+//
+bool mul_size(size_t &a, size_t b) {
+	if (b && a > ((size_t) -1) / b) return(false);
+	a *= b;
+	return(true);
+}
+
+// Add 'b' to 'a' in place. Returns false on overflow
+//
+bool add_size(size_t &a, size_t b) {
+	if (a > ((size_t) -1) - b) return(false);
+	a += b;
+	return(true);
+}
+
+};
+
+bool NetCDFCpp::_mapFile() {
+	if (_map) return(true);
+	if (_mapFailed || _ncid < 0 || (_mode & NC_WRITE)) return(false);
+
+	// Don't retry on failure
+	//
+	_mapFailed = true;
+
+#ifdef WIN32
+	return(false);
+#else
+	int format;
+	if (nc_inq_format(_ncid, &format) != NC_NOERR) return(false);
+	bool classic = format == NC_FORMAT_CLASSIC || 
+		format == NC_FORMAT_64BIT_OFFSET;
+#ifdef NC_FORMAT_CDF5
+	classic = classic || format == NC_FORMAT_CDF5;
+#endif
+	if (! classic) return(false);
+
+	int fd = open(_path.c_str(), O_RDONLY);
+	if (fd < 0) return(false);
+
+	struct stat statbuf;
+	if (fstat(fd, &statbuf) < 0 || statbuf.st_size < 8) {
+		close(fd);
+		return(false);
+	}
+
+	size_t len = statbuf.st_size;
+	void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return(false);
+
+	const unsigned char *buf = (const unsigned char *) map;
+	if (buf[0] != 'C' || buf[1] != 'D' || buf[2] != 'F') {
+		munmap(map, len);
+		return(false);
+	}
+	int version = buf[3];
+	header_reader hdr(buf + 4, len - 4, version);
+
+	size_t numrecs = hdr.get_nonneg();
+
+	// dim_list. A length of zero identifies the record dimension
+	//
+	vector <size_t> dimlens;
+	(void) hdr.get(4);
+	size_t ndims = hdr.get_nonneg();
+	for (size_t i=0; i<ndims && hdr.ok(); i++) {
+		(void) hdr.get_name();
+		dimlens.push_back(hdr.get_nonneg());
+	}
+
+	hdr.skip_atts();	// gatt_list
+
+	// var_list
+	//
+	std::map <string, _var_layout_t> layouts;
+	std::map <string, size_t> vsizes;
+	size_t recsize = 0;
+	size_t recsize_unpadded = 0;
+	size_t nrecvars = 0;
+	(void) hdr.get(4);
+	size_t nvars = hdr.get_nonneg();
+	for (size_t i=0; i<nvars && hdr.ok(); i++) {
+		string name = hdr.get_name();
+
+		_var_layout_t layout;
+		layout.record = false;
+
+		size_t nvdims = hdr.get_nonneg();
+		for (size_t j=0; j<nvdims && hdr.ok(); j++) {
+			size_t dimid = hdr.get_nonneg();
+			if (dimid >= dimlens.size()) { hdr.fail(); break; }
+
+			if (j == 0 && dimlens[dimid] == 0) layout.record = true;
+			layout.dims.push_back(dimlens[dimid]);
+		}
+
+		hdr.skip_atts();	// vatt_list
+
+		layout.xtype = (nc_type) hdr.get(4);
+		size_t hdr_vsize = hdr.get_nonneg();
+		layout.begin = hdr.get_offset();
+		if (! hdr.ok()) break;
+
+		// Size of the variable, or of one record of a record variable
+		//
+		size_t vsize = NetCDFCpp::SizeOf(layout.xtype);
+		bool ok = vsize > 0;
+		for (int j = layout.record ? 1 : 0; j<layout.dims.size() && ok; j++) {
+			ok = mul_size(vsize, layout.dims[j]);
+		}
+		size_t padded = vsize;
+		ok = ok && add_size(padded, 3);
+		padded = (padded / 4) * 4;
+
+		// The header's vsize is padded, and is only unreliable if it is
+		// too large for 32 bits
+		//
+		bool truncated = version != 5 && padded >= 0xfffffffc;
+		if (ok && ! truncated) {
+			ok = hdr_vsize == padded || hdr_vsize == vsize;
+		}
+
+		// Non-record variables must lie entirely within the file
+		//
+		if (ok && ! layout.record) {
+			ok = layout.begin <= len && vsize <= len - layout.begin;
+		}
+		if (! ok) { hdr.fail(); break; }
+
+		if (layout.record) {
+			if (! add_size(recsize, padded)) { hdr.fail(); break; }
+			recsize_unpadded = vsize;
+			nrecvars++;
+		}
+
+		layouts[name] = layout;
+		vsizes[name] = vsize;
+	}
+
+	// No padding if there is only one record variable
+	//
+	_recSize = nrecvars == 1 ? recsize_unpadded : recsize;
+
+	// Records must lie within the file too
+	//
+	for (auto itr = layouts.begin(); itr != layouts.end() && hdr.ok(); ++itr) {
+		const _var_layout_t &layout = itr->second;
+		if (! layout.record || numrecs == 0) continue;
+
+		size_t end = numrecs - 1;
+		bool ok = mul_size(end, _recSize);
+		ok = ok && add_size(end, layout.begin);
+		ok = ok && add_size(end, vsizes[itr->first]);
+		if (! ok || end > len) hdr.fail();
+	}
+
+	// The header parser duplicates the NetCDF library's. Don't trust it
+	// unless it agrees with the library about every variable
+	//
+	for (auto itr = layouts.begin(); itr != layouts.end() && hdr.ok(); ++itr) {
+		const _var_layout_t &layout = itr->second;
+
+		int varid;
+		nc_type xtype;
+		int ndims;
+		int dimids[NC_MAX_VAR_DIMS];
+		if (
+			nc_inq_varid(_ncid, itr->first.c_str(), &varid) != NC_NOERR ||
+			nc_inq_var(_ncid, varid, NULL, &xtype, &ndims, dimids, NULL) !=
+			NC_NOERR ||
+			xtype != layout.xtype || ndims != layout.dims.size()
+		) {
+			hdr.fail();
+			break;
+		}
+
+		for (int j=0; j<ndims && hdr.ok(); j++) {
+			size_t dimlen;
+			if (nc_inq_dimlen(_ncid, dimids[j], &dimlen) != NC_NOERR) {
+				hdr.fail();
+			}
+			else if (layout.record && j == 0) {
+				if (dimlen != numrecs) hdr.fail();
+			}
+			else if (dimlen != layout.dims[j]) {
+				hdr.fail();
+			}
+		}
+	}
+
+	if (! hdr.ok()) {
+		munmap(map, len);
+		_recSize = 0;
+		return(false);
+	}
+
+	_varLayouts = layouts;
+	_numRecs = numrecs;
+	_map = map;
+	_mapLen = len;
+	_mapFailed = false;
+	return(true);
+#endif
+}
+
+void NetCDFCpp::_unmapFile() {
+#ifndef WIN32
+	if (_map) munmap(_map, _mapLen);
+#endif
+	_map = NULL;
+	_mapLen = 0;
+	_mapFailed = false;
+	_recSize = 0;
+	_numRecs = 0;
+	_varLayouts.clear();
+}
+
+bool NetCDFCpp::MapVara(
+	string varname, vector <size_t> start, vector <size_t> count,
+	nc_type xtype, const void *&addr
+) {
+	addr = NULL;
+
+	if (! _mapFile()) return(false);
+
+	auto itr = _varLayouts.find(varname);
+	if (itr == _varLayouts.end()) return(false);
+	const _var_layout_t &layout = itr->second;
+
+	if (layout.xtype != xtype) return(false);
+	if (start.size() != layout.dims.size()) return(false);
+	if (count.size() != layout.dims.size()) return(false);
+
+	// The hyperslab is contiguous if it spans all but the first 
+	// dimension whose count exceeds one. Records of a record variable 
+	// are not contiguous with each other
+	//
+	size_t elem_size = NetCDFCpp::SizeOf(xtype);
+	size_t offset = 0;		// offset of first element from start of record
+	size_t nbytes = elem_size;	// size of hyperslab
+	size_t stride = elem_size;	// size of one element of dimension i
+	bool spanning = true;
+	for (int i=(int) layout.dims.size()-1; i>=0; i--) {
+		if (layout.record && i == 0) {
+			if (count[0] > 1 || start[0] >= _numRecs) return(false);
+			break;
+		}
+
+		if (start[i] + count[i] > layout.dims[i]) return(false);
+		if (! spanning && count[i] > 1) return(false);
+		if (count[i] != layout.dims[i]) spanning = false;
+
+		offset += start[i] * stride;
+		nbytes *= count[i];
+		stride *= layout.dims[i];
+	}
+
+	if (layout.record && layout.dims.size()) {
+		offset += start[0] * _recSize;
+	}
+
+	if (layout.begin + offset + nbytes > _mapLen) return(false);
+
+	addr = (const unsigned char *) _map + layout.begin + offset;
+	return(true);
+}
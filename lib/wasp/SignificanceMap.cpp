@@ -22,6 +22,85 @@ using namespace VAPoR;
 
 using namespace std;
 
+namespace {
+
+// Index of least significant set bit in a non-zero word
+//
+inline int count_trailing_zeros(unsigned long long word) {
+#if defined(__GNUC__) || defined(__clang__)
+	return(__builtin_ctzll(word));
+#else
+	int n = 0;
+	while (! (word & 1ULL)) {
+		word >>= 1;
+		n++;
+	}
+	return(n);
+#endif
+}
+
+// Bit stream writer for packed, MSB first, fixed width indices. Bits 
+// are accumulated in a word and flushed a byte at a time.
+//
+class bit_writer {
+public:
+	bit_writer(unsigned char *ptr) : _ptr(ptr), _acc(0), _nacc(0) {}
+
+	void Put(size_t value, int nbits) {
+		while (nbits) {
+			int n = nbits > 32 ? 32 : nbits;
+			nbits -= n;
+			_acc = (_acc << n) | ((value >> nbits) & ((1ULL << n) - 1));
+			_nacc += n;
+			while (_nacc >= BITSPERBYTE) {
+				_nacc -= BITSPERBYTE;
+				*_ptr++ = (unsigned char) (_acc >> _nacc);
+			}
+		}
+	}
+
+	void Flush() {
+		if (_nacc) {
+			*_ptr++ = (unsigned char) (_acc << (BITSPERBYTE - _nacc));
+			_nacc = 0;
+		}
+	}
+
+private:
+	unsigned char *_ptr;
+	unsigned long long _acc;
+	int _nacc;
+};
+
+// Bit stream reader matching bit_writer
+//
+class bit_reader {
+public:
+	bit_reader(const unsigned char *ptr) : _ptr(ptr), _acc(0), _nacc(0) {}
+
+	size_t Get(int nbits) {
+		size_t value = 0;
+		while (nbits) {
+			int n = nbits > 32 ? 32 : nbits;
+			nbits -= n;
+			while (_nacc < n) {
+				_acc = (_acc << BITSPERBYTE) | *_ptr++;
+				_nacc += BITSPERBYTE;
+			}
+			_nacc -= n;
+			value = (value << n) | ((_acc >> _nacc) & ((1ULL << n) - 1));
+		}
+		return(value);
+	}
+
+private:
+	const unsigned char *_ptr;
+	unsigned long long _acc;
+	int _nacc;
+};
+
+};
+
 
 
 template <class T> void swapbytes(T *ptr, size_t nelem) {
@@ -110,6 +189,7 @@ SignificanceMap::SignificanceMap() {
 
 	_sigMapEncode = NULL;
 	_sigMapEncodeSize = 0;
+	_version = VDF_VERSION;
 	if (_SignificanceMap(dims) < 0) return;
 }
 
@@ -124,6 +204,7 @@ SignificanceMap::SignificanceMap(size_t nx, size_t ny, size_t nz, size_t nt) {
 
 	_sigMapEncode = NULL;
 	_sigMapEncodeSize = 0;
+	_version = VDF_VERSION;
 	if (_SignificanceMap(dims) < 0) return;
 }
 
@@ -131,6 +212,7 @@ SignificanceMap::SignificanceMap(vector <size_t> dims) {
 
 	_sigMapEncode = NULL;
 	_sigMapEncodeSize = 0;
+	_version = VDF_VERSION;
 	if (_SignificanceMap(dims) < 0) return;
 }
 
@@ -150,6 +232,7 @@ SignificanceMap::SignificanceMap(
 
 	_sigMapEncode = NULL;
 	_sigMapEncodeSize = 0;
+	_version = VDF_VERSION;
 	if (_SignificanceMap(map, dims) < 0) return;
 
 }
@@ -159,6 +242,7 @@ SignificanceMap::SignificanceMap(
 ) {
 	_sigMapEncode = NULL;
 	_sigMapEncodeSize = 0;
+	_version = VDF_VERSION;
 	if (_SignificanceMap(map, dims) < 0) return;
 
 }
@@ -183,6 +267,7 @@ SignificanceMap::SignificanceMap(const SignificanceMap &rhs) {
 	this->_sigMapEncode = NULL;
 
     this->_idxentry = rhs._idxentry;
+    this->_version = rhs._version;
 
 	// handle raw pointers
 	//
@@ -212,6 +297,7 @@ SignificanceMap &SignificanceMap::operator=( const SignificanceMap& rhs ) {
 	this->_sigMapEncode = NULL;
 
     this->_idxentry = rhs._idxentry;
+    this->_version = rhs._version;
 
 	// handle raw pointers
 	//
@@ -432,12 +518,44 @@ int SignificanceMap::GetNextEntryXYZT(
 	return(0);
 
 }
+bool SignificanceMap::_UseBitmap(
+	const vector <size_t> &dims, size_t num_entries, int version
+) {
+	if (version < 3 || num_entries == 0) return(false);
+
+	size_t size = 1;
+	for (int i = 0; i<dims.size(); i++) size *= dims[i];
+
+	// Use a bitmap if it is no larger than the packed indices
+	//
+	size_t bitmapbytes = (size - 1) / BITSPERBYTE + 1;
+	size_t packedbytes = 
+		(num_entries * _GetBitsPerIdx(dims) - 1) / BITSPERBYTE + 1;
+
+	return(bitmapbytes <= packedbytes);
+}
+
 size_t SignificanceMap::GetMapSize(
 	vector <size_t> dims,
 	size_t num_entries
+) {
+	return(GetMapSize(dims, num_entries, VDF_VERSION));
+}
+
+size_t SignificanceMap::GetMapSize(
+	vector <size_t> dims,
+	size_t num_entries,
+	int version
 ) {
 	// Calculate size of encoded map
 	//
+	if (_UseBitmap(dims, num_entries, version)) {
+		size_t size = 1;
+		for (int i = 0; i<dims.size(); i++) size *= dims[i];
+
+		return((size - 1) / BITSPERBYTE + 1 + HEADER_SIZE);
+	}
+
 	size_t mapsize;
 	size_t tbits  = num_entries * _GetBitsPerIdx(dims);
 	if (tbits) 
@@ -451,7 +569,16 @@ size_t SignificanceMap::GetMapSize(
 
 size_t SignificanceMap::GetMapSize(size_t num_entries) const {
 
-	return(GetMapSize(_dimsVec, num_entries));
+	return(GetMapSize(_dimsVec, num_entries, _version));
+}
+
+int SignificanceMap::SetVersion(int version) {
+	if (version < 2 || version > VDF_VERSION) {
+		SetErrMsg("Unsupported significance map version : %d", version);
+		return(-1);
+	}
+	_version = version;
+	return(0);
 }
 
 void SignificanceMap::GetMap(unsigned char *encodedMap) {
@@ -474,7 +601,7 @@ void SignificanceMap::GetMap(unsigned char *encodedMap) {
 	//		bytes[20-] : _dimsVec[i]
 	//
 	encodedMap[0] = encodedMap[1] = encodedMap[2] = 'c';
-	encodedMap[3] = VDF_VERSION;
+	encodedMap[3] = _version;
 
 	vector <size_t> header_data;
 	header_data.push_back(_sigMapVec.size());
@@ -505,27 +632,26 @@ void SignificanceMap::GetMap(unsigned char *encodedMap) {
 	}
 
 	unsigned char *ptr = encodedMap + HEADER_SIZE;
-	int bib = BITSPERBYTE; // bits available in current byte
-	int p = BITSPERBYTE-1;
 
 	if (! _sorted) SignificanceMap::Sort();
 
-	for (size_t i = 0; i<_sigMapVec.size(); i++) {
-		size_t idx = _sigMapVec[i];
-		int tbits = _bits_per_idx;
-		while (tbits) {
-			int n = min(tbits, bib);
-			PUTBITS(*ptr, p, n, idx>>(tbits-n));
-			p -= n;
-			tbits -= n;
-			bib -= n;
-			if (bib == 0) {
-				ptr++;
-				bib = BITSPERBYTE;
-				p = BITSPERBYTE-1;
-			}
+	// Bitmap encoding: bit (idx % 8) of byte (idx / 8) is set for 
+	// each significant coordinate, idx.
+	//
+	if (_UseBitmap(_dimsVec, _sigMapVec.size(), _version)) {
+		memset(ptr, 0, (_sigMapSize - 1) / BITSPERBYTE + 1);
+		for (size_t i = 0; i<_sigMapVec.size(); i++) {
+			size_t idx = _sigMapVec[i];
+			ptr[idx / BITSPERBYTE] |= 1 << (idx % BITSPERBYTE);
 		}
+		return;
+	}
+
+	bit_writer writer(ptr);
+	for (size_t i = 0; i<_sigMapVec.size(); i++) {
+		writer.Put(_sigMapVec[i], _bits_per_idx);
 	}
+	writer.Flush();
 }
 
 void SignificanceMap::GetMap(const unsigned char **map, size_t *maplen) {
@@ -624,25 +750,46 @@ int SignificanceMap::SetMap(const unsigned char *map) {
 	_sigMapVec.reserve(numentries);
 
 	const unsigned char *ptr = map + header_size;
-	int bib = BITSPERBYTE; // bits remaining in current byte
 
 	_sorted = true;
-	size_t idxprev = 0;
-	for (size_t i = 0; i<numentries; i++) {
-		size_t idx = 0;
-		int tbits = _bits_per_idx;
-		int p = _bits_per_idx - 1;
-		while (tbits) {
-			int n = min(tbits, bib);
-			PUTBITS(idx, p, n, *ptr >> (bib-n));
-			p -= n;
-			tbits -= n;
-			bib -= n;
-			if (bib == 0) {
-				ptr++;
-				bib = BITSPERBYTE;
+	_version = version < 2 ? 2 : version;
+
+	if (_UseBitmap(_dimsVec, numentries, version)) {
+
+		// Scan the bitmap a word at a time. Coordinates are decoded in 
+		// ascending order.
+		//
+		size_t nbytes = (_sigMapSize - 1) / BITSPERBYTE + 1;
+		for (size_t offset = 0; offset < nbytes; offset += 8) {
+			size_t n = min((size_t) 8, nbytes - offset);
+
+			unsigned long long word = 0;
+			for (size_t j = 0; j<n; j++) {
+				word |= (unsigned long long) ptr[offset + j] << (j*BITSPERBYTE);
+			}
+
+			size_t base = offset * BITSPERBYTE;
+			while (word) {
+				_sigMapVec.push_back(base + count_trailing_zeros(word));
+				word &= word - 1;
 			}
 		}
+
+		if (_sigMapVec.size() != numentries ||
+			(numentries && _sigMapVec.back() >= _sigMapSize)) {
+
+			_sigMapVec.clear();
+			SetErrMsg("Invalid significance map - corrupt bitmap");
+			return(-1);
+		}
+		return(0);
+	}
+
+	bit_reader reader(ptr);
+	size_t idxprev = 0;
+	for (size_t i = 0; i<numentries; i++) {
+		size_t idx = reader.Get(_bits_per_idx);
+
 		//
 		// Should probably call SignificanceMap::Set() here so
 		// that we check for duplicate values. But this is quicker.
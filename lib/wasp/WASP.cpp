@@ -2,6 +2,13 @@
 #include <sstream>
 #include <sstream>
 #include <iterator>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
 #include <sys/stat.h>
 #include "vapor/utils.h"
 #include "vapor/MatWaveBase.h"
@@ -18,6 +25,45 @@ namespace {
 //
 const size_t BLK_HDR_SZ = 2;
 
+// Deflate level used to entropy code the coefficients of integer 
+// wavelets in netCDF-4 files. Higher levels buy little for wavelet 
+// coefficients, and cost a lot of encoding time
+//
+const int INT_DEFLATE_LEVEL = 1;
+
+// Returns true if 'wname' names an integer wavelet. See 
+// MatWaveBase::_create_wf()
+//
+bool is_int_wavelet(const string &wname) {
+	return(wname.compare(0, 3, "int") == 0);
+}
+
+// When selecting a wavelet for a block, candidates whose squared 
+// reconstruction errors are within this fraction of the smallest are 
+// considered equally good. 
+//
+const double selectTolerance = 0.01;
+
+// Squared reconstruction errors smaller than this fraction of a block's
+// energy are considered round off, and are ignored when selecting a 
+// wavelet for the block
+//
+const double selectRoundOff = 1e-20;
+
+// The wavelet name stored with a variable that has per-block wavelets is
+// given this prefix. Readers that predate per-block wavelets can't 
+// construct the prefixed wavelet, and refuse the variable rather than
+// decoding every block with the wrong wavelet
+//
+const string adaptivePrefix = "adaptive:";
+
+string strip_adaptive_prefix(const string &wname) {
+	if (wname.compare(0, adaptivePrefix.size(), adaptivePrefix) == 0) {
+		return(wname.substr(adaptivePrefix.size()));
+	}
+	return(wname);
+}
+
 size_t linearize_coords(
     vector <size_t> coords, vector <size_t> dims
 ) {
@@ -61,6 +107,34 @@ vector <size_t> compressor_bs(vector <size_t> bs) {
 	return(my_bs);
 }
 
+// Returns true if blocks transformed with the wavelet 'cname', limited
+// to the number of transformation levels of the wavelet 'wname', share
+// the storage layout and multiresolution hierarchy of blocks 
+// transformed with 'wname'
+//
+bool compatible_wavelets(
+	const vector <size_t> &bs, const string &wname, const string &cname
+) {
+	MatWaveBase mwb(cname);
+	if (! mwb.wavelet()) return(false);
+	if (is_int_wavelet(wname) != is_int_wavelet(cname)) return(false);
+
+	Compressor wcmp(compressor_bs(bs), wname);
+	Compressor ccmp(compressor_bs(bs), cname, wcmp.GetNumLevels());
+
+	if (ccmp.GetNumLevels() != wcmp.GetNumLevels()) return(false);
+	if (ccmp.GetNumWaveCoeffs() != wcmp.GetNumWaveCoeffs()) return(false);
+	if (ccmp.GetMinCompression() != wcmp.GetMinCompression()) return(false);
+
+	for (int l=0; l<=wcmp.GetNumLevels(); l++) {
+		vector <size_t> wdims, cdims;
+		wcmp.GetDimension(wdims, l);
+		ccmp.GetDimension(cdims, l);
+		if (wdims != cdims) return(false);
+	}
+	return(true);
+}
+
 
 // vector subtraction. Return a - b
 //
@@ -164,21 +238,16 @@ void vectorinc::ith(
 	start.clear();
 	offset = 0;
 
+	// Decompose index into per-axis increments, fastest varying 
+	// axis last
+	//
 	start = _start;
-	for (size_t idx = 0; idx < index; idx++) {
+	for (int i=start.size()-1; i>=0; i--) {
+		size_t n = (_end[i] - _start[i] + _inc[i] - 1) / _inc[i];
+		if (n < 1) n = 1;
 
-		int i = start.size()-1;
-		bool done = false;
-		while (i >= 0 && ! done) {
-			start[i] += _inc[i];
-			if (start[i] >= _end[i]) {
-				start[i] = _start[i];
-			}
-			else {
-				done = true;
-			}
-			i--;
-		}
+		start[i] += (index % n) * _inc[i];
+		index /= n;
 	}
 
 	offset = linearize_coords(start, _dims);
@@ -233,6 +302,12 @@ public:
  unsigned char *_maps;	// private (not shared)
  int _level;
  bool _unblock_flag; // unblock the data after reconstruction?
+ string _summary_varname;	// name of block summary variable, if any
+ string _error_varname;	// name of block error variable, if any
+ int _keepbits;	// mantissa bits retained in coefficients, or 0 for all
+ string _wavelet_varname;	// name of block wavelet variable, if any
+ vector <vector <Compressor *> > _wcompressors;	// candidates, per thread
+ void *_pipeline;	// global read_ or write_pipeline <U> for compressed IO
  static int _status;	// error indicator
 
  thread_state(
@@ -253,7 +328,8 @@ public:
 	_compressors(compressors), _data(data), _data_type(data_type), 
 	_mask(mask), _block(block), _coeffs(coeffs), _block_type(block_type),
 	_xtype(xtype), _maps(maps), _level(level),
-	_unblock_flag(unblock_flag)
+	_unblock_flag(unblock_flag), _summary_varname(), _error_varname(),
+	_keepbits(0), _wavelet_varname(), _wcompressors(), _pipeline(NULL)
  {_status = 0;}
 
 };
@@ -469,6 +545,11 @@ vector <size_t> vdiff(vector <size_t> a, vector <size_t> b) {
 // block : pointer to start of block where data should be copied
 // bs : dimensions of block. 
 // min, max : range of data values within block
+// missing : 0 if block has no missing values, 1 if some values are missing,
+// 2 if all values are missing
+// fill : if true values excluded by 'mask' are replaced with the average
+// of the valid values, which compresses well. Otherwise they are copied
+// verbatim, and only excluded from the range
 //
 template <class T, class U>
 void Block(
@@ -479,10 +560,12 @@ void Block(
 	U *block,
 	vector <size_t> bs, 
 	string mode, 
-	U &min, U &max
+	U &min, U &max, int &missing,
+	bool fill = true
 ) {
 	min = 0;
 	max = 0;
+	missing = 0;
 
 	VAssert(dims.size() >= 1 && dims.size() <= 4);
 	VAssert(dims.size() == start.size());
@@ -543,8 +626,6 @@ void Block(
 	bool zbdry = rank >= 3 && start[rank-3] + nbz > nz;
 
 	double  ave = 0.0; 
-	min = (U) data[0];
-	max = (U) data[0];
 	if (mask) {
 		size_t n = 0;
 		double total = 0.0;
@@ -555,9 +636,6 @@ void Block(
 			if (! mask[index]) continue;
 			U v = (U) data[index];
 
-			if (n == 0) {
-				min = max = (U) v;
-			}
 			n++;
 			total += v;
 
@@ -567,10 +645,15 @@ void Block(
 		if (n) {
 			ave = total / (double) n;
 		}
+		if (n == 0) missing = 2;
+		else if (n < xstop*ystop*zstop) missing = 1;
 	}
 
-	// copy data to block and handle mask if there is one
+	// copy data to block and handle mask if there is one. The range is
+	// seeded with the first valid value that is not a NaN, so that NaNs
+	// can not propagate into min and max
 	//
+	bool seeded = false;
 	for (size_t z = 0; z<zstop; z++) {
 	for (size_t y = 0; y<ystop; y++) {
 	for (size_t x = 0; x<xstop; x++) {
@@ -578,10 +661,19 @@ void Block(
 		double v;
 
 		if (mask && ! mask[index]) {
-			v = ave;
+
+			// Integer blocks are transformed losslessly. Fill with
+			// the nearest integer rather than truncating toward zero
+			//
+			if (fill) v = std::is_integral<U>::value ? std::round(ave) : ave;
+			else v = data[index];
 		}
 		else {
 			v = data[index];
+			if (! seeded && ! std::isnan(v)) {
+				min = max = (U) v;
+				seeded = true;
+			}
 			if (v < min) min = (U) v;
 			if (v > max) max = (U) v;
 		}
@@ -861,6 +953,85 @@ int ReconstructBlock(
 	return(0);
 }
 
+// Select the candidate wavelet, from the compressors 'cmps', that best
+// compresses the 'n' element 'block'. Each candidate decomposes the 
+// block into the coefficients described by 'ncoeffs', and the block is
+// reconstructed from them. The candidate with the smallest squared
+// reconstruction error is selected, except that a candidate with a 
+// shorter filter, which decodes faster, is preferred if its error is
+// within selectTolerance of the smallest.
+//
+// coeffs : scratch storage for vsum(ncoeffs) coefficients
+// recon : scratch storage for 'n' reconstructed values
+//
+// Returns the index of the selected candidate, or -1 on failure
+//
+template <class U>
+int select_wavelet(
+	const vector <Compressor *> &cmps, const U *block, size_t n,
+	const vector <size_t> &ncoeffs, U *coeffs, U *recon
+) {
+	double energy = 0.0;
+	for (size_t i=0; i<n; i++) energy += (double) block[i] * block[i];
+
+	vector <double> errors(cmps.size());
+	for (int j=0; j<cmps.size(); j++) {
+		vector <SignificanceMap> sigmaps(ncoeffs.size());
+
+		int rc = cmps[j]->Decompose(block, coeffs, ncoeffs, sigmaps);
+		if (rc<0) return(-1);
+
+		rc = cmps[j]->Reconstruct(coeffs, recon, sigmaps, -1);
+		if (rc<0) return(-1);
+
+		double sse = 0.0;
+		for (size_t i=0; i<n; i++) {
+			double d = (double) block[i] - (double) recon[i];
+			sse += d * d;
+		}
+		errors[j] = sse;
+	}
+
+	double best = *std::min_element(errors.begin(), errors.end());
+	double threshold = best * (1.0 + selectTolerance) + selectRoundOff*energy;
+
+	int choice = -1;
+	for (int j=0; j<cmps.size(); j++) {
+		if (errors[j] > threshold) continue;
+
+		if (choice < 0 || 
+			cmps[j]->wavelet()->GetLength() < 
+			cmps[choice]->wavelet()->GetLength()) {
+
+			choice = j;
+		}
+	}
+	return(choice);
+}
+
+// Round each of the 'n' coefficients in 'coeffs' to 'keepbits' 
+// significant mantissa bits, leaving the low order bits zero so that
+// they entropy code well. Rounding is to nearest, by adding half a unit
+// in the last retained place before truncating; a carry into the
+// exponent correctly rounds up to the next power of two. The loop is
+// branch free so that the compiler can vectorize it.
+//
+void round_mantissa(double *coeffs, size_t n, int keepbits) {
+	const int mbits = 52;	// explicit mantissa bits of a double
+
+	if (keepbits < 1 || keepbits >= mbits) return;
+
+	const uint64_t half = (uint64_t) 1 << (mbits - keepbits - 1);
+	const uint64_t mask = ~(((uint64_t) 1 << (mbits - keepbits)) - 1);
+
+	for (size_t i=0; i<n; i++) {
+		uint64_t bits;
+		memcpy(&bits, &coeffs[i], sizeof(bits));
+		bits = (bits + half) & mask;
+		memcpy(&coeffs[i], &bits, sizeof(bits));
+	}
+}
+
 // Write a single block (no compression) to disk
 //
 // varname : name of variable
@@ -891,26 +1062,46 @@ int StoreBlock(
 	return(0);
 }
 
-// Write a single transformed & compressed block to disk
+// Gather 'nblocks' runs of 'n' elements each, spaced 'stride' elements
+// apart in 'src', into consecutive runs in 'dst'. The inverse of 
+// scatter_runs()
+//
+template <class T>
+void gather_runs(
+	const T *src, size_t nblocks, size_t n, size_t stride, T *dst
+) {
+	for (size_t j=0; j<nblocks; j++) {
+		std::copy(src + j*stride, src + j*stride + n, dst + j*n);
+	}
+}
+
+// Write a run of transformed & compressed blocks to disk. The blocks
+// are adjacent along the fastest varying block axis, so each component
+// of the encoding is written for all of the blocks with a single call
 //
 // varname : name of variable
 // ncdfcptrs : NetCDFCpp file points, one for each compression level
-// bcoords : coordinates of block in voxel coords relative to start of variable
+// bcoords : coordinates of first block
+// nblocks : number of blocks
 // ncoeffs : vector describing partitioning of coefficients in 'coeffs'
 // encoded_dims : vector describing dimension of encoded block at
 // each compression level.
-// coeffs : transformed coefficients for each compression level
-// maps : encoded significance maps for each compression level
+// coeffs : transformed coefficients for each compression level. The 
+// coefficients for successive blocks are vsum(ncoeffs) elements apart
+// datarange : data range for each block. The ranges for successive
+// blocks are BLK_HDR_SZ elements apart
+// maps : encoded significance maps for each compression level. The 
+// maps for successive blocks are (vsum(encoded_dims) - vsum(ncoeffs) - 
+// BLK_HDR_SZ) elements of type 'xtype' apart. The maps are byte swapped
+// in place on big endian hosts
 //
 template <class T>
-int StoreBlockCompressed(
+int StoreBlocksCompressed(
 	string varname, vector <NetCDFCpp *> ncdfcptrs, vector <size_t> bcoords, 
-	vector <size_t> ncoeffs, vector <size_t> encoded_dims,
+	size_t nblocks, vector <size_t> ncoeffs, vector <size_t> encoded_dims,
 	const T *coeffs, const T *datarange, unsigned char *maps, int xtype
 	
 ) {
-
-
     unsigned long LSBTest = 1;
     bool do_swapbytes = false;
     if (! (*(char *) &LSBTest)) {
@@ -918,11 +1109,26 @@ int StoreBlockCompressed(
         do_swapbytes = true;
     }
 
+	VAssert(bcoords.size() >= 1);
+	VAssert(nblocks >= 1);
+
+	size_t coeffs_stride = vsum(ncoeffs);
+	size_t xsize = NetCDFCpp::SizeOf(xtype);
+	size_t maps_stride = 
+		(vsum(encoded_dims) - vsum(ncoeffs) - BLK_HDR_SZ) * xsize;
+
 	vector <size_t> start = bcoords;
 	start.push_back(0);
 
 	vector <size_t> count;
 	count.resize(start.size(), 1);
+	count[count.size()-2] = nblocks;
+
+	// Runs of more than one block are gathered into a temporary buffer, 
+	// and then written
+	//
+	vector <T> tbuf;
+	vector <unsigned char> tmaps;
 
 	// First write the min and max data value in the header
 	// of the base file
@@ -941,8 +1147,17 @@ int StoreBlockCompressed(
 		start[start.size()-1] = i==0 ? BLK_HDR_SZ : 0;	// skip header
 		count[start.size()-1] = ncoeffs[i];
 
+		const T *coeffsbuf = coeffs;
+		if (nblocks > 1) {
+			tbuf.resize(nblocks * ncoeffs[i]);
+			gather_runs(
+				coeffs, nblocks, ncoeffs[i], coeffs_stride, tbuf.data()
+			);
+			coeffsbuf = tbuf.data();
+		}
+
 		int rc = ncdfcptrs[i]->NetCDFCpp::PutVara(
-			varname, start, count, coeffs
+			varname, start, count, coeffsbuf
 		);
 		if (rc<0) return(rc);
 
@@ -968,27 +1183,146 @@ int StoreBlockCompressed(
 			start[start.size()-1] = i==0 ? ncoeffs[i] + BLK_HDR_SZ : ncoeffs[i];
 			count[start.size()-1] = n;
 
+			unsigned char *mapsbuf = maps;
+			if (nblocks > 1) {
+				tmaps.resize(nblocks * n * xsize);
+				gather_runs(
+					(const unsigned char *) maps, nblocks, n * xsize, 
+					maps_stride, tmaps.data()
+				);
+				mapsbuf = tmaps.data();
+			}
+
 			//
 			// Should be checking size of external type for var
 			//
 			if (do_swapbytes) {
-				swapbytes((void *) maps, NetCDFCpp::SizeOf(xtype), n);
+				swapbytes((void *) mapsbuf, xsize, n * nblocks);
 			}
 
 			// Signficance map is concatenated to the wavelet coefficients
 			// variable to improve IO performance
 			//
 			int rc = ncdfcptrs[i]->NetCDFCpp::PutVara(
-				varname, start, count, (const void *) maps
+				varname, start, count, (const void *) mapsbuf
 			);
 			if (rc<0) return(rc);
 
-			maps += n * NetCDFCpp::SizeOf(xtype);
+			maps += n * xsize;
 		}
 	}
 	return(0);
 }
 
+// Write the summaries of a run of blocks, adjacent along the fastest 
+// varying block axis, to disk. The summary is the range of the valid 
+// data values in the block, and whether any of the block's values are 
+// missing.
+//
+// svarname : name of block summary variable
+// ncdfcptr : NetCDFCpp file pointer for the base file
+// bcoords : coordinates of first block 
+// nblocks : number of blocks
+// summaries : (min, max, missing) triple for each block, where missing
+// is 0 if block has no missing values, 1 if some values are missing,
+// 2 if all values are missing
+//
+int StoreBlockSummaries(
+	string svarname, NetCDFCpp * ncdfcptr, vector <size_t> bcoords,
+	size_t nblocks, const double *summaries
+) {
+
+	vector <size_t> start = bcoords;
+	start.push_back(0);
+
+	vector <size_t> count(start.size(), 1);
+	count[count.size()-2] = nblocks;
+	count[count.size()-1] = 3;
+
+	int rc = ncdfcptr->NetCDFCpp::PutVara(svarname, start, count, summaries);
+	if (rc<0) return(rc);
+
+	return(0);
+}
+
+// Write the summary of a single block to disk. 
+//
+// svarname : name of block summary variable
+// ncdfcptr : NetCDFCpp file pointer for the base file
+// bcoords : coordinates of block 
+// min, max : range of valid data values within block
+// missing : 0 if block has no missing values, 1 if some values are missing,
+// 2 if all values are missing
+//
+int StoreBlockSummary(
+	string svarname, NetCDFCpp * ncdfcptr, vector <size_t> bcoords,
+	double min, double max, int missing
+) {
+	double summary[] = {min, max, (double) missing};
+
+	return(StoreBlockSummaries(svarname, ncdfcptr, bcoords, 1, summary));
+}
+
+// Write the achieved reconstruction errors of a run of blocks, adjacent
+// along the fastest varying block axis, to disk
+//
+// evarname : name of block error variable
+// ncdfcptr : NetCDFCpp file pointer for the base file
+// bcoords : coordinates of first block 
+// nblocks : number of blocks
+// errors : maximum pointwise error of each block's reconstruction
+//
+int StoreBlockErrors(
+	string evarname, NetCDFCpp * ncdfcptr, vector <size_t> bcoords,
+	size_t nblocks, const double *errors
+) {
+	vector <size_t> count(bcoords.size(), 1);
+	count[count.size()-1] = nblocks;
+
+	int rc = ncdfcptr->NetCDFCpp::PutVara(evarname, bcoords, count, errors);
+	if (rc<0) return(rc);
+
+	return(0);
+}
+
+// Write the wavelet ids of a run of blocks, adjacent along the fastest
+// varying block axis, to disk
+//
+// wvarname : name of block wavelet variable
+// ncdfcptr : NetCDFCpp file pointer for the base file
+// bcoords : coordinates of first block 
+// nblocks : number of blocks
+// wavelets : wavelet id of each block
+//
+int StoreBlockWavelets(
+	string wvarname, NetCDFCpp * ncdfcptr, vector <size_t> bcoords,
+	size_t nblocks, const unsigned char *wavelets
+) {
+	vector <size_t> count(bcoords.size(), 1);
+	count[count.size()-1] = nblocks;
+
+	int rc = ncdfcptr->NetCDFCpp::PutVara(wvarname, bcoords, count, wavelets);
+	if (rc<0) return(rc);
+
+	return(0);
+}
+
+// Read the wavelet ids of a run of blocks, adjacent along the fastest
+// varying block axis, from disk. The inverse of StoreBlockWavelets()
+//
+int FetchBlockWavelets(
+	string wvarname, NetCDFCpp * ncdfcptr, vector <size_t> bcoords,
+	size_t nblocks, unsigned char *wavelets
+) {
+	vector <size_t> count(bcoords.size(), 1);
+	count[count.size()-1] = nblocks;
+
+	int rc = ncdfcptr->NetCDFCpp::GetVara(wvarname, bcoords, count, wavelets);
+	if (rc<0) return(rc);
+
+	return(0);
+}
+
 // Read a single block (no compression) from disk
 //
 // varname : name of variable
@@ -1017,21 +1351,41 @@ int FetchBlock(
 	return(0);
 }
 
-// Read a single transformed & compressed block from disk
+// Scatter 'nblocks' consecutive runs of 'n' elements each from 'src' 
+// into 'dst', where successive runs are 'stride' elements apart
+//
+template <class T>
+void scatter_runs(
+	const T *src, size_t nblocks, size_t n, T *dst, size_t stride
+) {
+	for (size_t j=0; j<nblocks; j++) {
+		std::copy(src + j*n, src + (j+1)*n, dst + j*stride);
+	}
+}
+
+// Read a run of transformed & compressed blocks from disk. The blocks
+// are adjacent along the fastest varying block axis, so each component
+// of the encoding is read for all of the blocks with a single call
 //
 // varname : name of variable
 // ncdfcptrs : NetCDFCpp file points, one for each compression level
-// bcoords : coordinates of block
+// bcoords : coordinates of first block
+// nblocks : number of blocks
 // ncoeffs : vector describing partitioning of coefficients in 'coeffs'
 // encoded_dims : vector describing dimension of encoded block at
 // each compression level.
-// coeffs : transformed coefficients for each compression level
-// maps : encoded significance maps for each compression level
+// coeffs : transformed coefficients for each compression level. The 
+// coefficients for successive blocks are vsum(ncoeffs) elements apart
+// datarange : data range for each block. The ranges for successive
+// blocks are BLK_HDR_SZ elements apart
+// maps : encoded significance maps for each compression level. The 
+// maps for successive blocks are (vsum(encoded_dims) - vsum(ncoeffs) - 
+// BLK_HDR_SZ) elements of type 'xtype' apart
 //
 template <class T>
-int FetchBlockCompressed(
+int FetchBlocksCompressed(
 	string varname, vector <NetCDFCpp *> ncdfcptrs, vector <size_t> bcoords, 
-	vector <size_t> ncoeffs, vector <size_t> encoded_dims,
+	size_t nblocks, vector <size_t> ncoeffs, vector <size_t> encoded_dims,
 	T *coeffs, T *datarange, unsigned char *maps, int xtype
 	
 ) {
@@ -1042,11 +1396,26 @@ int FetchBlockCompressed(
         do_swapbytes = true;
     }
 
+	VAssert(bcoords.size() >= 1);
+	VAssert(nblocks >= 1);
+
+	size_t coeffs_stride = vsum(ncoeffs);
+	size_t xsize = NetCDFCpp::SizeOf(xtype);
+	size_t maps_stride = 
+		(vsum(encoded_dims) - vsum(ncoeffs) - BLK_HDR_SZ) * xsize;
+
 	vector <size_t> start = bcoords;
 	start.push_back(0);
 
 	vector <size_t> count;
 	count.resize(start.size(), 1);
+	count[count.size()-2] = nblocks;
+
+	// Runs of more than one block are read into a temporary buffer, 
+	// and then scattered
+	//
+	vector <T> tbuf;
+	vector <unsigned char> tmaps;
 
 	// Read header (first two elements contain data range)
 	//
@@ -1064,10 +1433,23 @@ int FetchBlockCompressed(
 		start[start.size()-1] = i==0 ? BLK_HDR_SZ : 0;	// skip header
 		count[start.size()-1] = ncoeffs[i];
 
-		int rc = ncdfcptrs[i]->NetCDFCpp::GetVara(
-			varname, start, count, coeffs
-		);
-		if (rc<0) return(rc);
+		if (nblocks == 1) {
+			int rc = ncdfcptrs[i]->NetCDFCpp::GetVara(
+				varname, start, count, coeffs
+			);
+			if (rc<0) return(rc);
+		}
+		else {
+			tbuf.resize(nblocks * ncoeffs[i]);
+			int rc = ncdfcptrs[i]->NetCDFCpp::GetVara(
+				varname, start, count, tbuf.data()
+			);
+			if (rc<0) return(rc);
+
+			scatter_runs(
+				tbuf.data(), nblocks, ncoeffs[i], coeffs, coeffs_stride
+			);
+		}
 
 		coeffs += ncoeffs[i];
 
@@ -1085,12 +1467,17 @@ int FetchBlockCompressed(
 			start[start.size()-1] = i==0 ? ncoeffs[i] + BLK_HDR_SZ : ncoeffs[i];
 			count[start.size()-1] = n;
 
+			unsigned char *mapsbuf = maps;
+			if (nblocks > 1) {
+				tmaps.resize(nblocks * n * xsize);
+				mapsbuf = tmaps.data();
+			}
 
 			// Signficance map is concatenated to the wavelet coefficients
 			// variable to improve IO performance
 			//
 			int rc = ncdfcptrs[i]->NetCDFCpp::GetVara(
-				varname, start, count, (void *) maps
+				varname, start, count, (void *) mapsbuf
 			);
 			if (rc<0) return(rc);
 
@@ -1098,15 +1485,298 @@ int FetchBlockCompressed(
 			// Should be checking size of external type for var
 			//
 			if (do_swapbytes) {
-				swapbytes((void *) maps, NetCDFCpp::SizeOf(xtype), n);
+				swapbytes((void *) mapsbuf, xsize, n * nblocks);
 			}
 
-			maps += n * NetCDFCpp::SizeOf(xtype);
+			if (nblocks > 1) {
+				scatter_runs(mapsbuf, nblocks, n * xsize, maps, maps_stride);
+			}
+
+			maps += n * xsize;
 		}
 	}
+
 	return(0);
 }
 
+// Shared state of a multithreaded compressed read. 
+//
+// Coefficients are read from disk in batches of consecutive blocks, 
+// using as few NetCDF calls as possible, into a ring of buffers. 
+// Threads claim blocks with an atomic counter and decode them straight 
+// from the ring. The thread that claims the first block of a batch
+// reads the following batch, holding the NetCDF lock, while the 
+// other threads keep decoding; decoding requires no locks. Inflating
+// entropy coded variables (see DefVarEntropyCode()) is done by the 
+// NetCDF library during the read, and so is serialized by the lock.
+//
+template <class U>
+class read_pipeline {
+public:
+ static const int NSLOTS = 3;
+
+ class slot_t {
+ public:
+  long _batch;		// batch held by slot, or -1
+  bool _ready;		// batch has been read
+  size_t _remaining;	// blocks of batch not yet decoded
+  U *_coeffs;
+  U *_ranges;
+  unsigned char *_maps;
+  unsigned char *_wavelets;	// wavelet id of each block
+ };
+
+ read_pipeline(
+	size_t nblocks, size_t batch_size, size_t coeffs_size, 
+	size_t maps_size, U *coeffs, unsigned char *maps
+ ) : _nblocks(nblocks), _batch_size(batch_size), 
+	_coeffs_size(coeffs_size), _maps_size(maps_size), _next(0), 
+	_error(false) {
+
+	_ranges.resize(NSLOTS * batch_size * BLK_HDR_SZ);
+	_wavelets.resize(NSLOTS * batch_size, 0);
+	for (int i=0; i<NSLOTS; i++) {
+		_slots[i]._batch = -1;
+		_slots[i]._ready = false;
+		_slots[i]._remaining = 0;
+		_slots[i]._coeffs = coeffs + i * batch_size * coeffs_size;
+		_slots[i]._ranges = _ranges.data() + i * batch_size * BLK_HDR_SZ;
+		_slots[i]._maps = maps + i * batch_size * maps_size;
+		_slots[i]._wavelets = _wavelets.data() + i * batch_size;
+	}
+ }
+
+ size_t _nblocks;	// total blocks to read
+ size_t _batch_size;	// blocks per batch
+ size_t _coeffs_size;	// coefficients per block
+ size_t _maps_size;	// bytes of significance map per block
+ std::atomic <size_t> _next;	// next block to claim
+ bool _error;
+ slot_t _slots[NSLOTS];
+ vector <U> _ranges;
+ vector <unsigned char> _wavelets;
+ std::mutex _mutex;	// guards slots and _error
+ std::condition_variable _cond;
+};
+
+// Size of a batch of blocks, in bytes, read by a read_pipeline 
+//
+const size_t readBatchBytes = 16 * 1024 * 1024;
+
+// Find the run of blocks, starting with the j'th block of 'vec' and
+// ending before the 'last'th, that are adjacent along the fastest 
+// varying block axis. Returns the length of the run, and the block 
+// coordinates of its first block in 'bcoords'
+//
+size_t block_run(
+	const vectorinc &vec, const vector <size_t> &bs, size_t j, size_t last,
+	vector <size_t> &bcoords
+) {
+	size_t offset;
+	vector <size_t> start;
+	size_t residual;
+	vec.ith(j, start, offset);
+	to_block_coords(start, bs, bcoords, residual);
+	VAssert(residual == 0);
+
+	size_t nrun = 1;
+	while (j + nrun < last) {
+		vector <size_t> nstart, nbcoords;
+		vec.ith(j + nrun, nstart, offset);
+		to_block_coords(nstart, bs, nbcoords, residual);
+		nbcoords.back() -= nrun;
+		if (nbcoords != bcoords) break;
+		nrun++;
+	}
+	return(nrun);
+}
+
+// Read batch 'batch' into its slot of the ring, after the batch that
+// previously occupied the slot has been decoded
+//
+template <class U>
+int LoadBatch(
+	thread_state &s, read_pipeline <U> &p, const vectorinc &vec, 
+	size_t batch
+) {
+	typename read_pipeline <U>::slot_t &slot = 
+		p._slots[batch % read_pipeline <U>::NSLOTS];
+
+	size_t first = batch * p._batch_size;
+	size_t last = std::min(first + p._batch_size, p._nblocks);
+	{
+		std::unique_lock <std::mutex> lock(p._mutex);
+		p._cond.wait(lock, [&] {return(slot._remaining == 0 || p._error);});
+		if (p._error) return(-1);
+
+		slot._batch = batch;
+		slot._ready = false;
+		slot._remaining = last - first;
+	}
+
+	// Coalesce runs of blocks adjacent along the fastest varying axis
+	//
+	int rc = 0;
+	s._et->MutexLock();
+	for (size_t j = first; j < last && rc >= 0; ) {
+		vector <size_t> bcoords;
+		size_t nrun = block_run(vec, s._bs, j, last, bcoords);
+
+		size_t k = j - first;
+		rc = FetchBlocksCompressed(
+			s._varname, s._ncdfcptrs, bcoords, nrun, s._ncoeffs, 
+			s._encoded_dims, slot._coeffs + k * p._coeffs_size, 
+			slot._ranges + k * BLK_HDR_SZ, slot._maps + k * p._maps_size, 
+			s._xtype
+		);
+		if (rc>=0 && ! s._wavelet_varname.empty()) {
+			rc = FetchBlockWavelets(
+				s._wavelet_varname, s._ncdfcptrs[0], bcoords, nrun,
+				slot._wavelets + k
+			);
+		}
+		j += nrun;
+	}
+	s._et->MutexUnlock();
+
+	{
+		std::lock_guard <std::mutex> lock(p._mutex);
+		if (rc < 0) p._error = true;
+		slot._ready = true;
+	}
+	p._cond.notify_all();
+	return(rc < 0 ? -1 : 0);
+}
+
+
+// Shared state of a multithreaded compressed write. 
+//
+// The mirror image of a read_pipeline: threads claim blocks with an
+// atomic counter and encode them straight into a ring of batch 
+// buffers. The thread that encodes the last outstanding block of a 
+// batch writes the whole batch to disk, holding the NetCDF lock, using
+// as few NetCDF calls as possible, and then recycles the slot for the 
+// batch NSLOTS ahead. The other threads keep encoding in the meantime; 
+// encoding requires no locks.
+//
+template <class U>
+class write_pipeline {
+public:
+ static const int NSLOTS = 3;
+
+ class slot_t {
+ public:
+  size_t _batch;		// batch held by slot
+  size_t _remaining;	// blocks of batch not yet encoded
+  U *_coeffs;
+  U *_ranges;
+  unsigned char *_maps;
+  double *_summaries;	// (min, max, missing) for each block
+  double *_errors;		// achieved error for each block
+  unsigned char *_wavelets;	// wavelet id of each block
+ };
+
+ write_pipeline(
+	size_t nblocks, size_t batch_size, size_t coeffs_size, 
+	size_t maps_size, U *coeffs, unsigned char *maps
+ ) : _nblocks(nblocks), _batch_size(batch_size), 
+	_coeffs_size(coeffs_size), _maps_size(maps_size), _next(0), 
+	_error(false) {
+
+	_ranges.resize(NSLOTS * batch_size * BLK_HDR_SZ);
+	_summaries.resize(NSLOTS * batch_size * 3);
+	_errors.resize(NSLOTS * batch_size);
+	_wavelets.resize(NSLOTS * batch_size, 0);
+	for (int i=0; i<NSLOTS; i++) {
+		_slots[i]._batch = i;
+		_slots[i]._remaining = batch_blocks(i);
+		_slots[i]._coeffs = coeffs + i * batch_size * coeffs_size;
+		_slots[i]._ranges = _ranges.data() + i * batch_size * BLK_HDR_SZ;
+		_slots[i]._maps = maps + i * batch_size * maps_size;
+		_slots[i]._summaries = _summaries.data() + i * batch_size * 3;
+		_slots[i]._errors = _errors.data() + i * batch_size;
+		_slots[i]._wavelets = _wavelets.data() + i * batch_size;
+	}
+ }
+
+ // Number of blocks in batch 'batch'
+ //
+ size_t batch_blocks(size_t batch) const {
+	size_t first = batch * _batch_size;
+	if (first >= _nblocks) return(0);
+	return(std::min(_batch_size, _nblocks - first));
+ }
+
+ size_t _nblocks;	// total blocks to write
+ size_t _batch_size;	// blocks per batch
+ size_t _coeffs_size;	// coefficients per block
+ size_t _maps_size;	// bytes of significance map per block
+ std::atomic <size_t> _next;	// next block to claim
+ bool _error;
+ slot_t _slots[NSLOTS];
+ vector <U> _ranges;
+ vector <double> _summaries;
+ vector <double> _errors;
+ vector <unsigned char> _wavelets;
+ std::mutex _mutex;	// guards slots and _error
+ std::condition_variable _cond;
+};
+
+// Size of a batch of blocks, in bytes, written by a write_pipeline 
+//
+const size_t writeBatchBytes = 16 * 1024 * 1024;
+
+// Write the encoded batch held by 'slot' to disk
+//
+template <class U>
+int FlushBatch(
+	thread_state &s, write_pipeline <U> &p, const vectorinc &vec, 
+	typename write_pipeline <U>::slot_t &slot
+) {
+	size_t first = slot._batch * p._batch_size;
+	size_t last = first + p.batch_blocks(slot._batch);
+
+	// Coalesce runs of blocks adjacent along the fastest varying axis.
+	// Need a mutex because NetCDF library is not thread safe
+	//
+	int rc = 0;
+	s._et->MutexLock();
+	for (size_t j = first; j < last && rc >= 0; ) {
+		vector <size_t> bcoords;
+		size_t nrun = block_run(vec, s._bs, j, last, bcoords);
+
+		size_t k = j - first;
+		rc = StoreBlocksCompressed(
+			s._varname, s._ncdfcptrs, bcoords, nrun, s._ncoeffs, 
+			s._encoded_dims, slot._coeffs + k * p._coeffs_size, 
+			slot._ranges + k * BLK_HDR_SZ, slot._maps + k * p._maps_size, 
+			s._xtype
+		);
+		if (rc>=0 && ! s._summary_varname.empty()) {
+			rc = StoreBlockSummaries(
+				s._summary_varname, s._ncdfcptrs[0], bcoords, nrun,
+				slot._summaries + k * 3
+			);
+		}
+		if (rc>=0 && ! s._error_varname.empty()) {
+			rc = StoreBlockErrors(
+				s._error_varname, s._ncdfcptrs[0], bcoords, nrun,
+				slot._errors + k
+			);
+		}
+		if (rc>=0 && ! s._wavelet_varname.empty()) {
+			rc = StoreBlockWavelets(
+				s._wavelet_varname, s._ncdfcptrs[0], bcoords, nrun,
+				slot._wavelets + k
+			);
+		}
+		j += nrun;
+	}
+	s._et->MutexUnlock();
+
+	return(rc < 0 ? -1 : 0);
+}
+
 
 template <class T>
 void *RunWriteThreadTemplate(thread_state &s, T dummy) 
@@ -1134,12 +1804,14 @@ void *RunWriteThreadTemplate(thread_state &s, T dummy)
 
 		//
 		// Extract the block with coordinates 'start' from the 
-		// array, 'data'. 
+		// array, 'data'. Values excluded by the mask are stored as
+		// is, but not included in the block summary
 		//
 		T min, max;
+		int missing;
 		Block(
-			(T *) s._data, NULL, s._count, roi_start, (T *) s._block, 
-			s._bs, "symh", min, max
+			(T *) s._data, s._mask, s._count, roi_start, (T *) s._block, 
+			s._bs, "symh", min, max, missing, false
 		);
 
 		// Convert from voxel to block coordinates
@@ -1161,6 +1833,15 @@ void *RunWriteThreadTemplate(thread_state &s, T dummy)
 			if (rc<0) {
 				s._status = -1;
 			}
+			if (rc>=0 && ! s._summary_varname.empty()) {
+				rc = StoreBlockSummary(
+					s._summary_varname, s._ncdfcptrs[0], bcoords, 
+					min, max, missing
+				);
+				if (rc<0) {
+					s._status = -1;
+				}
+			}
 		s._et->MutexUnlock();
 		if (s._status < 0) break;
 	}
@@ -1205,11 +1886,35 @@ void *RunWriteThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 
 	s._status = 0;
 
+	write_pipeline <U> &p = *((write_pipeline <U> *) s._pipeline);
+	size_t n = p._nblocks;
+
+	// Scratch space for evaluating candidate wavelets
 	//
-	// Process blocks of data assigned to this thread
-	//
-	int n = vec.num();
-	for (int i=s._id; i<n; i += s._nthreads) {
+	vector <U> tcoeffs, tblock;
+	if (! s._wcompressors.empty()) {
+		tcoeffs.resize(p._coeffs_size);
+		tblock.resize(vproduct(s._bs));
+	}
+
+	for (size_t i = p._next++; i<n; i = p._next++) {
+
+		// Wait for the batch containing the i'th block to be assigned
+		// a slot in the ring
+		//
+		size_t batch = i / p._batch_size;
+		typename write_pipeline <U>::slot_t &slot = 
+			p._slots[batch % write_pipeline <U>::NSLOTS];
+		{
+			std::unique_lock <std::mutex> lock(p._mutex);
+			p._cond.wait(lock, [&] {
+				return(slot._batch == batch || p._error);
+			});
+			if (p._error) {
+				s._status = -1;
+				break;
+			}
+		}
 
 		// Get starting coordinates of i'th block
 		//
@@ -1225,45 +1930,78 @@ void *RunWriteThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 		// Extract the block with coordinates 'start' from the 
 		// array, 'data'. 
 		//
-		U datarange[2];
+		size_t k = i - batch * p._batch_size;
+		U *datarange = slot._ranges + k * BLK_HDR_SZ;
+		int missing;
 		Block(
 			(T *) s._data, s._mask, s._count, roi_start, (U *) s._block, s._bs, 
-			s._compressors[s._id]->dwtmode(), datarange[0], datarange[1]
+			s._compressors[s._id]->dwtmode(), datarange[0], datarange[1],
+			missing
 		);
 
+		// Select the wavelet for the current block, if there is a choice
 		//
-		// Wavelet transform the current block
-		//
-		int rc = DecomposeBlock(
-			s._compressors[s._id], (const U *) s._block, vproduct(s._bs),
-			(U *) s._coeffs, s._maps, s._xtype, s._ncoeffs, s._encoded_dims
-		);
-		if (rc<0) {
-			s._status = -1;
-			break;
+		Compressor *cmp = s._compressors[s._id];
+		int wavelet = 0;
+		if (! s._wcompressors.empty()) {
+			wavelet = select_wavelet(
+				s._wcompressors[s._id], (const U *) s._block, 
+				vproduct(s._bs), s._ncoeffs, tcoeffs.data(), tblock.data()
+			);
+			if (wavelet >= 0) cmp = s._wcompressors[s._id][wavelet];
 		}
 
-		// Convert from voxel to block coordinates
 		//
-		vector <size_t> bcoords;
-		size_t residual;
-		to_block_coords(start, s._bs, bcoords, residual);
-		VAssert(residual == 0);
-
-		// Write the transformed block to disk. Need a mutex because
-		// NetCDF library is not thread safe
+		// Wavelet transform the current block straight into the 
+		// batch buffer
 		//
+		int rc = wavelet < 0 ? -1 : DecomposeBlock(
+			cmp, (const U *) s._block, vproduct(s._bs),
+			slot._coeffs + k * p._coeffs_size, slot._maps + k * p._maps_size, 
+			s._xtype, s._ncoeffs, s._encoded_dims
+		);
+
+		// Discard low order coefficient bits of entropy coded variables.
+		// Integer coefficients are exact and are not rounded
 		//
-		s._et->MutexLock();
-			rc = StoreBlockCompressed(
-				s._varname, s._ncdfcptrs, bcoords, s._ncoeffs, s._encoded_dims,
-				(U *) s._coeffs, datarange, s._maps, s._xtype
+		if (s._keepbits > 0 && s._block_type == NC_DOUBLE) {
+			round_mantissa(
+				(double *) (slot._coeffs + k * p._coeffs_size), 
+				p._coeffs_size, s._keepbits
 			);
-			if (rc<0) {
-				s._status = -1;
-			}
-		s._et->MutexUnlock();
-		if (s._status < 0) break;
+		}
+
+		double *summary = slot._summaries + k * 3;
+		summary[0] = datarange[0];
+		summary[1] = datarange[1];
+		summary[2] = missing;
+		slot._errors[k] = cmp->GetError();
+		slot._wavelets[k] = (unsigned char) wavelet;
+
+		// The thread encoding the last outstanding block of a batch
+		// writes the batch
+		//
+		bool flush = false;
+		{
+			std::lock_guard <std::mutex> lock(p._mutex);
+			slot._remaining--;
+			if (rc<0) p._error = true;
+			flush = slot._remaining == 0 && ! p._error;
+		}
+		if (flush) {
+			rc = FlushBatch(s, p, vec, slot);
+
+			std::lock_guard <std::mutex> lock(p._mutex);
+			if (rc<0) p._error = true;
+			slot._batch += write_pipeline <U>::NSLOTS;
+			slot._remaining = p.batch_blocks(slot._batch);
+		}
+		p._cond.notify_all();
+
+		if (rc<0) {
+			s._status = -1;
+			break;
+		}
 	}
 	return(0);
 }
@@ -1466,31 +2204,46 @@ void *RunReadThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 
 	s._status = 0;
 
-	int n = vec.num();
-	for (int i=s._id; i<n; i += s._nthreads) {
+	read_pipeline <U> &p = *((read_pipeline <U> *) s._pipeline);
+	size_t n = p._nblocks;
+	size_t nbatches = (n + p._batch_size - 1) / p._batch_size;
+
+	for (size_t i = p._next++; i<n; i = p._next++) {
+
+		// The thread claiming the first block of a batch reads ahead 
+		// the next batch. The first two batches are read up front.
+		//
+		size_t batch = i / p._batch_size;
+		int rc = 0;
+		if (i == 0) {
+			rc = LoadBatch(s, p, vec, 0);
+			if (rc == 0 && nbatches > 1) rc = LoadBatch(s, p, vec, 1);
+		}
+		else if (i % p._batch_size == 0 && batch + 1 < nbatches) {
+			rc = LoadBatch(s, p, vec, batch + 1);
+		}
+		if (rc<0) {
+			s._status = -1;
+			break;
+		}
+
+		typename read_pipeline <U>::slot_t &slot = 
+			p._slots[batch % read_pipeline <U>::NSLOTS];
+		{
+			std::unique_lock <std::mutex> lock(p._mutex);
+			p._cond.wait(lock, [&] {
+				return((slot._batch == (long) batch && slot._ready) || p._error);
+			});
+			if (p._error) {
+				s._status = -1;
+				break;
+			}
+		}
 
 		size_t offset;
 		vector <size_t> start;
 
 		vec.ith(i, start, offset);
-		
-		vector <size_t> bcoords;
-		size_t residual;
-		to_block_coords(start, s._bs, bcoords, residual);
-		VAssert(residual == 0);
-
-		// Read wavelet coefficients from disk. Need a mutex because
-		// NetCDF API is not thread safe
-		//
-		U datarange[2];
-		s._et->MutexLock();
-			int rc = FetchBlockCompressed(
-				s._varname, s._ncdfcptrs, bcoords, s._ncoeffs, 
-				s._encoded_dims, (U *) s._coeffs, datarange, s._maps, s._xtype
-			);
-			if (rc<0) s._status = -1;
-		s._et->MutexUnlock();
-		if (s._status < 0) break;
 
 		// Transform coordinates from global to the region-of-interest
 		//
@@ -1499,13 +2252,33 @@ void *RunReadThreadCompressedTemplate(thread_state &s, T dummy1, U dummy2) {
 
 		U *blockptr = (U *) s._block;
 
-		// Transform from wavelet to physical space
+		// Transform from wavelet to physical space, decoding directly
+		// from the batch buffer
 		//
-		rc = ReconstructBlock(
-			s._compressors[s._id], (U *) s._coeffs, datarange, s._maps, 
+		size_t k = i - batch * p._batch_size;
+		Compressor *cmp = s._compressors[s._id];
+		if (! s._wcompressors.empty()) {
+			const vector <Compressor *> &cmps = s._wcompressors[s._id];
+			unsigned char wavelet = slot._wavelets[k];
+			cmp = wavelet < cmps.size() ? cmps[wavelet] : NULL;
+		}
+
+		rc = cmp == NULL ? -1 : ReconstructBlock(
+			cmp, slot._coeffs + k * p._coeffs_size, 
+			slot._ranges + k * BLK_HDR_SZ, slot._maps + k * p._maps_size, 
 			s._xtype, s._ncoeffs, s._encoded_dims, blockptr, 
 			vproduct(s._bs), s._level
 		);
+
+		// Release the batch slot once all of its blocks are decoded
+		//
+		{
+			std::lock_guard <std::mutex> lock(p._mutex);
+			slot._remaining--;
+			if (rc<0) p._error = true;
+		}
+		p._cond.notify_all();
+
 		if (rc<0) {
 			s._status = -1;
             break;
@@ -1612,7 +2385,7 @@ WASP::WASP(int nthreads) {
 
 	_waspFile = false;
 	_nthreads = 1;
-	_currentVersion = 3;
+	_currentVersion = 5;
 	_fileVersion = 0;
 
 	_open = false;
@@ -1623,6 +2396,7 @@ WASP::WASP(int nthreads) {
 	_open_dims.clear();
 	_open_lod = 0;
 	_open_level = 0;
+	_open_keepbits = 0;
 	_open_write = false;
 	_open_varname.clear();
 
@@ -1643,6 +2417,7 @@ WASP::WASP(int nthreads) {
 }
 
 WASP::~WASP() {
+	_close_wavelet_compressors();
 	for (int i=0; i<_open_compressors.size(); i++) {
 		if (_open_compressors[i]) delete _open_compressors[i];
 	}
@@ -1743,6 +2518,15 @@ int WASP::Open(
 	rc = GetAtt("", AttNameVersion(), fileVersion);
 	if (rc<0) return(rc);
     _fileVersion = fileVersion;
+
+	if (_fileVersion > _currentVersion) {
+		SetErrMsg(
+			"WASP file version %d is newer than supported version %d",
+			_fileVersion, _currentVersion
+		);
+		NetCDFCpp::Close();
+		return(-1);
+	}
 	
     vector <string> paths;
 	if (numfiles > 1) {
@@ -1898,6 +2682,23 @@ int WASP::DefVar(
 		return(-1);
 	}
 
+	// Integer wavelet coefficients are only compact once entropy 
+	// coded, which requires the netCDF-4 format. Stored verbatim they
+	// take about twice the space of the original data
+	//
+	if (is_int_wavelet(wname)) {
+		int format;
+		int rc = NetCDFCpp::InqFormat(format);
+		if (rc<0) return(rc);
+
+		if (format != NC_FORMAT_NETCDF4) {
+			SetErrMsg(
+				"Integer wavelet %s requires a netCDF-4 file", wname.c_str()
+			);
+			return(-1);
+		}
+	}
+
 	sort(cratios.begin(), cratios.end()); 
 	reverse(cratios.begin(), cratios.end());
 
@@ -1957,59 +2758,343 @@ int WASP::DefVar(
 		}
 	}
 
-	// Now define the variable, one in each file
-	//
-	for (int i=0; i<encoded_dim_names.size(); i++) {
-		vector <string> newdimnames;
-		newdimnames = cdimnames;
-		newdimnames.push_back(encoded_dim_names[i]);
+	// Now define the variable, one in each file
+	//
+	for (int i=0; i<encoded_dim_names.size(); i++) {
+		vector <string> newdimnames;
+		newdimnames = cdimnames;
+		newdimnames.push_back(encoded_dim_names[i]);
+
+		rc = _ncdfcptrs[i]->NetCDFCpp::DefVar(name, xtype, newdimnames);
+		if (rc<0) return(rc);
+
+		// Integer wavelets transform integer data reversibly, leaving
+		// coefficients that are mostly small, or zero, for the masks
+		// and categorical fields they are used for. Entropy code them. 
+		//
+		if (is_int_wavelet(wname)) {
+			rc = _ncdfcptrs[i]->DefVarDeflate(name, true, INT_DEFLATE_LEVEL);
+			if (rc<0) return(rc);
+		}
+	}
+
+	// Per-block summaries (data range and missing value state) are 
+	// stored in the base file alongside the variable so that they
+	// may be read without reconstructing any blocks
+	//
+	if (! _ncdfcptrs[0]->InqDimDefined(DimNameBlockSummary())) {
+		rc = _ncdfcptrs[0]->NetCDFCpp::DefDim(DimNameBlockSummary(), 3);
+		if (rc<0) return(rc);
+	}
+
+	vector <string> sdimnames = cdimnames;
+	sdimnames.push_back(DimNameBlockSummary());
+
+	rc = _ncdfcptrs[0]->NetCDFCpp::DefVar(
+		VarNameBlockSummary(name), NC_DOUBLE, sdimnames
+	);
+	if (rc<0) return(rc);
+
+	// Attributes needed to encode or decode the variable later
+	//
+
+	rc = PutAtt(name, AttNameWASP(), 1);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameDimNames(), dimnames);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameCRatios(), cratios);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameWavelet(), wname);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameBlockSize(), bs);
+	if (rc<0) return(rc);
+
+	return(NC_NOERR);
+}
+
+int WASP::DefVar(
+    string name, int xtype, vector <string> dimnames, 
+	string wname, vector <size_t> bs, vector <size_t> cratios,
+	double missing_value
+) {
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+	if (bs.size()==0 || vproduct(bs) == 1) { 
+		return(NetCDFCpp::DefVar(name, xtype, dimnames));
+	}
+
+	int rc = WASP::DefVar(name, xtype, dimnames, wname, bs, cratios);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameMissingValue(), missing_value);
+	if (rc<0) return(rc);
+
+	return(NC_NOERR);
+
+}
+
+int WASP::DefVarErrorBound(string name, double errbound, bool relative) {
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	bool compressed;
+	int rc = InqVarCompressed(name, compressed);
+	if (rc<0) return(rc);
+
+	if (! compressed || ! (errbound > 0.0)) {
+		SetErrMsg("Invalid error bound for variable %s", name.c_str());
+		return(-1);
+	}
+
+	rc = PutAtt(name, AttNameErrorBound(), errbound);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameErrorBoundRelative(), (int) relative);
+	if (rc<0) return(rc);
+
+	// Per-block achieved errors are stored in the base file, with the
+	// same block dimensions as the block summaries
+	//
+	string evarname = VarNameBlockError(name);
+	if (_ncdfcptrs[0]->InqVarDefined(evarname)) return(NC_NOERR);
+
+	vector <string> sdimnames;
+	vector <size_t> sdims;
+	rc = _ncdfcptrs[0]->NetCDFCpp::InqVarDims(
+		VarNameBlockSummary(name), sdimnames, sdims
+	);
+	if (rc<0) return(rc);
+	sdimnames.pop_back();
+
+	rc = _ncdfcptrs[0]->NetCDFCpp::DefVar(evarname, NC_DOUBLE, sdimnames);
+	if (rc<0) return(rc);
+
+	return(NC_NOERR);
+}
+
+int WASP::InqVarErrorBound(
+	string name, double &errbound, bool &relative
+) const {
+	errbound = 0.0;
+	relative = false;
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	// disable error reporting otherwise an error is generated 
+	// if the attribute doesn't exist
+	//
+	bool enabled = MyBase::EnableErrMsg(false);
+
+	nc_type xtype;
+	size_t len;
+	int rc = NetCDFCpp::InqAtt(name, AttNameErrorBound(), xtype, len);
+
+	(void) MyBase::EnableErrMsg(enabled);
+
+	if (rc<0 || len != 1) return(NC_NOERR);
+
+	rc = GetAtt(name, AttNameErrorBound(), errbound);
+	if (rc<0) return(rc);
+
+	int rel = 0;
+	rc = GetAtt(name, AttNameErrorBoundRelative(), rel);
+	if (rc<0) return(rc);
+	relative = rel != 0;
+
+	return(NC_NOERR);
+}
+
+int WASP::DefVarEntropyCode(string name, int deflate_level, int keepbits) {
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	bool compressed;
+	int rc = InqVarCompressed(name, compressed);
+	if (rc<0) return(rc);
+
+	if (! compressed || deflate_level < 1 || deflate_level > 9 || 
+		keepbits < 0) {
+
+		SetErrMsg("Invalid entropy coding for variable %s", name.c_str());
+		return(-1);
+	}
+
+	// Entropy coding, and chunking, are provided by HDF5, and hence
+	// require the netCDF-4 format. Each block is stored in its own 
+	// chunk so that blocks are coded independently. 
+	//
+	for (int i=0; i<_ncdfcptrs.size(); i++) {
+		int format;
+		rc = _ncdfcptrs[i]->InqFormat(format);
+		if (rc<0) return(rc);
+
+		if (format != NC_FORMAT_NETCDF4) {
+			SetErrMsg("Entropy coding requires a netCDF-4 file");
+			return(-1);
+		}
+
+		if (! _ncdfcptrs[i]->InqVarDefined(name)) continue;
+
+		vector <string> dimnames;
+		vector <size_t> chunksizes;
+		rc = _ncdfcptrs[i]->NetCDFCpp::InqVarDims(name, dimnames, chunksizes);
+		if (rc<0) return(rc);
+
+		for (int j=0; j<chunksizes.size()-1; j++) chunksizes[j] = 1;
+
+		rc = _ncdfcptrs[i]->DefVarChunking(name, chunksizes);
+		if (rc<0) return(rc);
+
+		rc = _ncdfcptrs[i]->DefVarDeflate(name, true, deflate_level);
+		if (rc<0) return(rc);
+	}
+
+	rc = PutAtt(name, AttNameEntropyCode(), deflate_level);
+	if (rc<0) return(rc);
+
+	rc = PutAtt(name, AttNameKeepBits(), keepbits);
+	if (rc<0) return(rc);
+
+	return(NC_NOERR);
+}
+
+int WASP::InqVarEntropyCode(
+	string name, int &deflate_level, int &keepbits
+) const {
+	deflate_level = 0;
+	keepbits = 0;
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	// disable error reporting otherwise an error is generated 
+	// if the attribute doesn't exist
+	//
+	bool enabled = MyBase::EnableErrMsg(false);
+
+	nc_type xtype;
+	size_t len;
+	int rc = NetCDFCpp::InqAtt(name, AttNameEntropyCode(), xtype, len);
+
+	(void) MyBase::EnableErrMsg(enabled);
+
+	if (rc<0 || len != 1) return(NC_NOERR);
+
+	rc = GetAtt(name, AttNameEntropyCode(), deflate_level);
+	if (rc<0) return(rc);
+
+	rc = GetAtt(name, AttNameKeepBits(), keepbits);
+	if (rc<0) return(rc);
+
+	return(NC_NOERR);
+}
+
+int WASP::DefVarAdaptiveWavelet(string name, vector <string> wnames) {
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	bool compressed;
+	int rc = InqVarCompressed(name, compressed);
+	if (rc<0) return(rc);
 
-		rc = _ncdfcptrs[i]->NetCDFCpp::DefVar(name, xtype, newdimnames);
+	vector <size_t> bs;
+	vector <size_t> cratios;
+	vector <size_t> udims;
+	vector <size_t> dims;
+	string wname;
+	if (compressed) {
+		rc = _get_compression_params(name, bs, cratios, udims, dims, wname);
 		if (rc<0) return(rc);
 	}
 
-	// Attributes needed to encode or decode the variable later
+	// Wavelet ids are stored in a byte per block
 	//
+	if (! compressed || wnames.empty() || wnames.size() > 254) {
+		SetErrMsg("Invalid wavelets for variable %s", name.c_str());
+		return(-1);
+	}
 
-	rc = PutAtt(name, AttNameWASP(), 1);
-	if (rc<0) return(rc);
+	for (int i=0; i<wnames.size(); i++) {
+		if (! compatible_wavelets(bs, wname, wnames[i])) {
+			SetErrMsg(
+				"Wavelet %s is incompatible with wavelet %s of variable %s",
+				wnames[i].c_str(), wname.c_str(), name.c_str()
+			);
+			return(-1);
+		}
+	}
+	wnames.insert(wnames.begin(), wname);
 
-	rc = PutAtt(name, AttNameDimNames(), dimnames);
+	rc = PutAtt(name, AttNameWavelets(), wnames);
 	if (rc<0) return(rc);
 
-	rc = PutAtt(name, AttNameCRatios(), cratios);
+	rc = PutAtt(name, AttNameWavelet(), adaptivePrefix + wname);
 	if (rc<0) return(rc);
 
-	rc = PutAtt(name, AttNameWavelet(), wname);
+	// Per-block wavelet ids are stored in the base file, with the
+	// same block dimensions as the block summaries
+	//
+	string wvarname = VarNameBlockWavelet(name);
+	if (_ncdfcptrs[0]->InqVarDefined(wvarname)) return(NC_NOERR);
+
+	vector <string> sdimnames;
+	vector <size_t> sdims;
+	rc = _ncdfcptrs[0]->NetCDFCpp::InqVarDims(
+		VarNameBlockSummary(name), sdimnames, sdims
+	);
 	if (rc<0) return(rc);
+	sdimnames.pop_back();
 
-	rc = PutAtt(name, AttNameBlockSize(), bs);
+	rc = _ncdfcptrs[0]->NetCDFCpp::DefVar(wvarname, NC_BYTE, sdimnames);
 	if (rc<0) return(rc);
 
 	return(NC_NOERR);
 }
 
-int WASP::DefVar(
-    string name, int xtype, vector <string> dimnames, 
-	string wname, vector <size_t> bs, vector <size_t> cratios,
-	double missing_value
-) {
+int WASP::InqVarAdaptiveWavelet(
+	string name, vector <string> &wnames
+) const {
+	wnames.clear();
+
 	if (! _waspFile) {
 		SetErrMsg("Not a WASP file");
 		return(-1);
 	}
-	if (bs.size()==0 || vproduct(bs) == 1) { 
-		return(NetCDFCpp::DefVar(name, xtype, dimnames));
-	}
 
-	int rc = WASP::DefVar(name, xtype, dimnames, wname, bs, cratios);
-	if (rc<0) return(rc);
+	// disable error reporting otherwise an error is generated 
+	// if the attribute doesn't exist
+	//
+	bool enabled = MyBase::EnableErrMsg(false);
 
-	rc = PutAtt(name, AttNameMissingValue(), missing_value);
+	nc_type xtype;
+	size_t len;
+	int rc = NetCDFCpp::InqAtt(name, AttNameWavelets(), xtype, len);
+
+	(void) MyBase::EnableErrMsg(enabled);
+
+	if (rc<0 || len == 0) return(NC_NOERR);
+
+	rc = GetAtt(name, AttNameWavelets(), wnames);
 	if (rc<0) return(rc);
 
 	return(NC_NOERR);
-
 }
 
 int WASP::InqVarDims(
@@ -2043,6 +3128,26 @@ int WASP::InqVarDims(
 	return(NC_NOERR);
 }
 
+int WASP::InqVarnames(vector <string> &varnames) const {
+	varnames.clear();
+
+	vector <string> ncdfvarnames;
+	int rc = NetCDFCpp::InqVarnames(ncdfvarnames);
+	if (rc<0) return(rc);
+
+	string prefix = VarNameBlockSummary("");
+	string eprefix = VarNameBlockError("");
+	string wprefix = VarNameBlockWavelet("");
+	for (int i=0; i<ncdfvarnames.size(); i++) {
+		if (ncdfvarnames[i].compare(0, prefix.size(), prefix) == 0) continue;
+		if (ncdfvarnames[i].compare(0, eprefix.size(), eprefix) == 0) continue;
+		if (ncdfvarnames[i].compare(0, wprefix.size(), wprefix) == 0) continue;
+
+		varnames.push_back(ncdfvarnames[i]);
+	}
+	return(NC_NOERR);
+}
+
 int WASP::InqVarCompressionParams(
 	string name, string &wname, vector <size_t> &bs, vector <size_t> &cratios
 ) const {
@@ -2070,6 +3175,8 @@ int WASP::InqVarCompressionParams(
 	rc = GetAtt(name, AttNameWavelet(), wname);
 	if (rc<0) return(rc);
 
+	wname = strip_adaptive_prefix(wname);
+
 	return(0);
 }
 
@@ -2326,6 +3433,7 @@ int WASP::OpenVarWrite(string name, int lod) {
 	_open_dims.clear();
 	_open_lod = 0;
 	_open_level = 0;
+	_open_keepbits = 0;
 	_open_write = false;
 	_open_varname.clear();
 	_open_varxtype = 0;
@@ -2345,12 +3453,39 @@ int WASP::OpenVarWrite(string name, int lod) {
         return(-1);
     }
 
+	double errbound;
+	bool relative;
+	rc = InqVarErrorBound(name, errbound, relative);
+	if (rc<0) return(rc);
+
+	// The error bound is only applied if the significance map of the 
+	// finest level-of-detail written is stored. I.e. the compression 
+	// ratio is not one.
+	//
+	if (cratios[lod] == 1) errbound = 0.0;
+
+	int deflate_level;
+	int keepbits;
+	rc = InqVarEntropyCode(name, deflate_level, keepbits);
+	if (rc<0) return(rc);
+
+	vector <string> wnames;
+	rc = InqVarAdaptiveWavelet(name, wnames);
+	if (rc<0) return(rc);
+
 	// Create one compressor for each execution thread 
 	//
 	if (! wname.empty()) {
 		for (int i=0; i<_nthreads; i++) {
 			_open_compressors[i] = new Compressor(compressor_bs(bs), wname);
+			_open_compressors[i]->SigMapVersion() = _sigmap_version();
+			if (errbound > 0.0) {
+				_open_compressors[i]->ErrorBoundOnOff() = true;
+				_open_compressors[i]->ErrorBound() = errbound;
+				_open_compressors[i]->ErrorBoundRelativeOnOff() = relative;
+			}
 		}
+		_open_wavelet_compressors(wnames, bs);
 	}
 
 
@@ -2361,6 +3496,7 @@ int WASP::OpenVarWrite(string name, int lod) {
 	_open_dims = dims;
 	_open_lod = lod;
 	_open_level = 0;
+	_open_keepbits = keepbits;
 	_open_write = true;
 	_open_varname = name;
 	_open_varxtype = xtype;
@@ -2409,6 +3545,7 @@ int WASP::OpenVarRead(string name, int level, int lod) {
 	_open_dims.clear();
 	_open_lod = 0;
 	_open_level = 0;
+	_open_keepbits = 0;
 	_open_write = false;
 	_open_varname.clear();
 	_open_varxtype = 0;
@@ -2438,9 +3575,16 @@ int WASP::OpenVarRead(string name, int level, int lod) {
 	if (! wname.empty()) {	// May simply be blocked, not compressed
 		for (int i=0; i<_nthreads; i++) {
 			_open_compressors[i] = new Compressor(compressor_bs(bs), wname);
+			_open_compressors[i]->SigMapVersion() = _sigmap_version();
 		}
 		VAssert(_nthreads >= 1);
 		numlevels = _open_compressors[0]->GetNumLevels();
+
+		vector <string> wnames;
+		rc = InqVarAdaptiveWavelet(name, wnames);
+		if (rc<0) return(rc);
+
+		_open_wavelet_compressors(wnames, bs);
 	}
 	else {
 		numlevels = 1;
@@ -2449,6 +3593,7 @@ int WASP::OpenVarRead(string name, int level, int lod) {
 
 	if (level > numlevels) {
 		SetErrMsg("Invalid refinement level: (%d)", level);
+		_close_wavelet_compressors();
 		for (int i=0; i<_nthreads; i++) {
 			if (_open_compressors[i]) delete _open_compressors[i];
 			_open_compressors[i] = NULL;
@@ -2484,6 +3629,7 @@ int WASP::CloseVar() {
 
 	if (! _open_waspvar) return(0);
 
+	_close_wavelet_compressors();
 	for (int i=0; i<_nthreads; i++) {
 		if (_open_compressors[i]) delete _open_compressors[i];
 		_open_compressors[i] = NULL;
@@ -2492,6 +3638,48 @@ int WASP::CloseVar() {
 	return(0);
 }
 
+// Create the per-block wavelet candidates, 'wnames', of the opened 
+// variable for each thread. The first candidate, the variable's own 
+// wavelet, is the thread's existing compressor. The others are 
+// limited to the same number of transformation levels, and share its
+// settings. If there are fewer than two candidates there is no choice 
+// to make, and none are created.
+//
+void WASP::_open_wavelet_compressors(
+	const vector <string> &wnames, const vector <size_t> &bs
+) {
+	_close_wavelet_compressors();
+
+	if (wnames.size() < 2) return;
+
+	_open_wcompressors.resize(_nthreads);
+	for (int i=0; i<_nthreads; i++) {
+		Compressor *cmp0 = _open_compressors[i];
+		_open_wcompressors[i].push_back(cmp0);
+
+		for (int j=1; j<wnames.size(); j++) {
+			Compressor *cmp = new Compressor(
+				compressor_bs(bs), wnames[j], cmp0->GetNumLevels()
+			);
+			cmp->SigMapVersion() = cmp0->SigMapVersion();
+			cmp->ErrorBoundOnOff() = cmp0->ErrorBoundOnOff();
+			cmp->ErrorBound() = cmp0->ErrorBound();
+			cmp->ErrorBoundRelativeOnOff() = cmp0->ErrorBoundRelativeOnOff();
+
+			_open_wcompressors[i].push_back(cmp);
+		}
+	}
+}
+
+void WASP::_close_wavelet_compressors() {
+	for (int i=0; i<_open_wcompressors.size(); i++) {
+		for (int j=1; j<_open_wcompressors[i].size(); j++) {
+			delete _open_wcompressors[i][j];
+		}
+	}
+	_open_wcompressors.clear();
+}
+
 // Validate parameters to PutVara()
 //
 bool WASP::_validate_put_vara_compressed(
@@ -2593,10 +3781,7 @@ int WASP::_PutVara(
 
 	// Allocate space for coefficients and sigmap if data are compressed
 	//
-	size_t coeffs_size = 0;
-	U *coeffs = NULL;
-	size_t maps_size = 0;
-	unsigned char *maps = NULL;
+	write_pipeline <U> *pipeline = NULL;
 	if (! _open_wname.empty()) {
 
 		// Handle case where not all coefficients are wanted
@@ -2606,13 +3791,34 @@ int WASP::_PutVara(
 			encoded_dims.pop_back();
 		}
 
-		coeffs_size = vsum(ncoeffs);
-		coeffs = (U *) _coeffbuf.Alloc(coeffs_size * _nthreads * sizeof(U));
+		size_t coeffs_size = vsum(ncoeffs);
 
-		maps_size = vsum(encoded_dims) - vsum(ncoeffs);  
+		size_t maps_size = vsum(encoded_dims) - vsum(ncoeffs);  
 		maps_size -= BLK_HDR_SZ; 
-		maps = (unsigned char*) _sigbuf.Alloc(
-			maps_size * _nthreads * NetCDFCpp::SizeOf(_open_varxtype)
+		maps_size *= NetCDFCpp::SizeOf(_open_varxtype);
+
+		// Compressed blocks are written in batches, sized so that each
+		// batch occupies about writeBatchBytes, but holds at least 
+		// one block per thread
+		//
+		size_t nblocks = vectorinc(start, count, _open_udims, _open_bs).num();
+
+		size_t blk_bytes = coeffs_size * sizeof(U) + maps_size;
+		size_t batch_size = writeBatchBytes / (blk_bytes ? blk_bytes : 1);
+		if (batch_size < _nthreads) batch_size = _nthreads;
+		if (batch_size > nblocks) batch_size = nblocks;
+		if (batch_size < 1) batch_size = 1;
+
+		size_t nslots = write_pipeline <U>::NSLOTS;
+		U *coeffs = (U *) _coeffbuf.Alloc(
+			coeffs_size * batch_size * nslots * sizeof(U)
+		);
+		unsigned char *maps = (unsigned char*) _sigbuf.Alloc(
+			maps_size * batch_size * nslots
+		);
+
+		pipeline = new write_pipeline <U> (
+			nblocks, batch_size, coeffs_size, maps_size, coeffs, maps
 		);
 	}
 
@@ -2626,16 +3832,45 @@ int WASP::_PutVara(
 	// Set up thread state for parallel (threaded) execution
 	//
 	vector <void *> argvec;
+	// Files written before block summaries were introduced won't have
+	// a summary variable
+	//
+	string summary_varname = VarNameBlockSummary(_open_varname);
+	if (! _ncdfcptrs[0]->InqVarDefined(summary_varname)) {
+		summary_varname.clear();
+	}
+
+	// Achieved errors are only recorded for error bounded variables
+	//
+	string error_varname;
+	if (_open_compressors[0] && _open_compressors[0]->ErrorBoundOnOff()) {
+		error_varname = VarNameBlockError(_open_varname);
+	}
+
+	// Wavelet ids are only recorded for variables with more than one 
+	// candidate wavelet
+	//
+	string wavelet_varname;
+	if (! _open_wcompressors.empty()) {
+		wavelet_varname = VarNameBlockWavelet(_open_varname);
+	}
+
 	for (int i=0; i<_nthreads; i++) {
 
-		argvec.push_back((void *) new thread_state(
+		thread_state *ts = new thread_state(
 			i, _et, _nthreads, _open_varname, _ncdfcptrs, start, count, 
 			_open_bs, _open_udims, ncoeffs, encoded_dims, _open_compressors, 
 			(void *) data, data_type, (unsigned char *) mask,
-			block + i*block_size, coeffs + i*coeffs_size, 
-			block_type, _open_varxtype,
-			maps + i*maps_size*NetCDFCpp::SizeOf(_open_varxtype), 0, true
-		));
+			block + i*block_size, NULL, block_type, _open_varxtype,
+			NULL, 0, true
+		);
+		ts->_summary_varname = summary_varname;
+		ts->_error_varname = error_varname;
+		ts->_keepbits = _open_keepbits;
+		ts->_wavelet_varname = wavelet_varname;
+		ts->_wcompressors = _open_wcompressors;
+		ts->_pipeline = pipeline;
+		argvec.push_back((void *) ts);
 	}
 
 	if (_nthreads == 1) {
@@ -2657,10 +3892,15 @@ int WASP::_PutVara(
 
 		if (rc < 0) {
 			SetErrMsg("Error spawning threads");
+			for (int i=0; i<argvec.size(); i++) {
+				delete (thread_state *) argvec[i];
+			}
+			if (pipeline) delete pipeline;
 			return(-1);
 		}
 	}
 	for (int i=0; i<argvec.size(); i++) delete (thread_state *) argvec[i];
+	if (pipeline) delete pipeline;
 
 	return(thread_state::_status);
 }
@@ -2913,6 +4153,7 @@ int WASP::_GetVara(
     U *coeffs = NULL;
     size_t maps_size = 0;
     unsigned char *maps = NULL;
+	read_pipeline <U> *pipeline = NULL;
 	if (! _open_wname.empty()) {
 		// Handle case where not all coefficients are wanted
 		//
@@ -2922,12 +4163,40 @@ int WASP::_GetVara(
 		}
 
 		coeffs_size = vsum(ncoeffs);
-		coeffs = (U *) _coeffbuf.Alloc(coeffs_size * _nthreads * sizeof(U));
 
 		maps_size = vsum(encoded_dims) - vsum(ncoeffs);  
 		maps_size -= BLK_HDR_SZ;
+		maps_size *= NetCDFCpp::SizeOf(_open_varxtype);
+
+		// Compressed blocks are read in batches, sized so that each
+		// batch occupies about readBatchBytes, but holds at least 
+		// one block per thread
+		//
+		vector <size_t> aligned_start;
+		vector <size_t> aligned_count;
+		block_align(
+			start, count, bs_at_level, aligned_start, aligned_count
+		);
+		size_t nblocks = vectorinc(
+			aligned_start, aligned_count, dims_at_level, bs_at_level
+		).num();
+
+		size_t blk_bytes = coeffs_size * sizeof(U) + maps_size;
+		size_t batch_size = readBatchBytes / (blk_bytes ? blk_bytes : 1);
+		if (batch_size < _nthreads) batch_size = _nthreads;
+		if (batch_size > nblocks) batch_size = nblocks;
+		if (batch_size < 1) batch_size = 1;
+
+		size_t nslots = read_pipeline <U>::NSLOTS;
+		coeffs = (U *) _coeffbuf.Alloc(
+			coeffs_size * batch_size * nslots * sizeof(U)
+		);
 		maps = (unsigned char*) _sigbuf.Alloc(
-			maps_size * _nthreads * NetCDFCpp::SizeOf(_open_varxtype)
+			maps_size * batch_size * nslots
+		);
+
+		pipeline = new read_pipeline <U> (
+			nblocks, batch_size, coeffs_size, maps_size, coeffs, maps
 		);
 	}
 
@@ -2940,6 +4209,11 @@ int WASP::_GetVara(
 	//
 	// Set up thread state for parallel (threaded) execution
 	//
+	string wavelet_varname;
+	if (! _open_wcompressors.empty()) {
+		wavelet_varname = VarNameBlockWavelet(_open_varname);
+	}
+
 	vector <void *> argvec;
 	for (int i=0; i<_nthreads; i++) {
 
@@ -2949,10 +4223,12 @@ int WASP::_GetVara(
 			i, _et, _nthreads, _open_varname, _ncdfcptrs, start, count, 
 			bs_at_level, dims_at_level, ncoeffs,
 			encoded_dims, _open_compressors, data, data_type, NULL,
-			blkptr, coeffs + i*coeffs_size, block_type, _open_varxtype,
-			maps + i*maps_size*NetCDFCpp::SizeOf(_open_varxtype), 
+			blkptr, NULL, block_type, _open_varxtype, NULL,
 			_open_level, unblock_flag
 		));
+		((thread_state *) argvec.back())->_wavelet_varname = wavelet_varname;
+		((thread_state *) argvec.back())->_wcompressors = _open_wcompressors;
+		((thread_state *) argvec.back())->_pipeline = pipeline;
 	}
 
 	if (_nthreads == 1) {
@@ -2973,11 +4249,16 @@ int WASP::_GetVara(
 		}
 		if (rc < 0) {
 			SetErrMsg("Error spawning threads");
+			for (int i=0; i<argvec.size(); i++) {
+				delete (thread_state *) argvec[i];
+			}
+			if (pipeline) delete pipeline;
 			return(-1);
 		}
 	}
 
 	for (int i=0; i<argvec.size(); i++) delete (thread_state *) argvec[i];
+	if (pipeline) delete pipeline;
 
 	return(thread_state::_status);
 }
@@ -3046,6 +4327,244 @@ int WASP::GetVar(float *data) {
 	return(WASP::GetVara(start, count, data));
 }
 
+bool WASP::MapVara(
+    vector <size_t> start, vector <size_t> count, nc_type xtype,
+	const void *&addr, vector <size_t> &bs
+) {
+	addr = NULL;
+	bs = vector <size_t> (count.size(), 1);
+
+	if (! _waspFile || ! _open || _open_write) return(false);
+
+	if (! _open_waspvar) {
+		return(NetCDFCpp::MapVara(_open_varname, start, count, xtype, addr));
+	}
+
+	// Compressed blocks are not stored as values
+	//
+	if (! _open_wname.empty()) return(false);
+
+	if (start.size() != _open_udims.size()) return(false);
+	if (count.size() != _open_udims.size()) return(false);
+	VAssert(_open_bs.size() == _open_udims.size());
+	VAssert(_open_dims.size() == _open_udims.size() + 1);
+
+	// Translate the user coordinates into those of the blocked variable, 
+	// which has an additional, fastest varying, dimension for the values
+	// within each block. Only entire blocked dimensions can be mapped
+	//
+	vector <size_t> bstart;
+	vector <size_t> bcount;
+	for (int i=0; i<_open_udims.size(); i++) {
+		if (_open_bs[i] == 1) {
+			bstart.push_back(start[i]);
+			bcount.push_back(count[i]);
+			continue;
+		}
+		if (start[i] != 0 || count[i] != _open_udims[i]) return(false);
+
+		bstart.push_back(0);
+		bcount.push_back(_open_dims[i]);
+	}
+	bstart.push_back(0);
+	bcount.push_back(_open_dims[_open_dims.size()-1]);
+
+	if (! NetCDFCpp::MapVara(_open_varname, bstart, bcount, xtype, addr)) {
+		return(false);
+	}
+
+	bs = _open_bs;
+	return(true);
+}
+
+int WASP::GetBlockSummaries(
+    vector <size_t> start, vector <size_t> count, vector <size_t> &bdims,
+	vector <double> &mins, vector <double> &maxs,
+	vector <unsigned char> &missing
+) {
+	bdims.clear();
+	mins.clear();
+	maxs.clear();
+	missing.clear();
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	if (! _open || _open_write) {
+		SetErrMsg("Invalid state");
+        return(-1);
+	}
+
+	if (! _open_waspvar) return(0);
+
+	string svarname = VarNameBlockSummary(_open_varname);
+	if (! _ncdfcptrs[0]->InqVarDefined(svarname)) return(0);
+
+	if (start.size() != _open_udims.size() || 
+		count.size() != _open_udims.size()) {
+
+		SetErrMsg("Invalid parameter");
+        return(-1);
+	}
+	VAssert(_open_bs.size() == start.size());
+
+	// Convert from voxel to block coordinates
+	//
+	vector <size_t> bstart, bcount;
+	for (int i=0; i<start.size(); i++) {
+		if (count[i] < 1 || start[i] + count[i] > _open_udims[i]) {
+			SetErrMsg("Invalid parameter");
+			return(-1);
+		}
+		size_t b0 = start[i] / _open_bs[i];
+		size_t b1 = (start[i] + count[i] - 1) / _open_bs[i];
+
+		bstart.push_back(b0);
+		bcount.push_back(b1 - b0 + 1);
+	}
+
+	size_t nblocks = vproduct(bcount);
+
+	bstart.push_back(0);
+	bcount.push_back(3);
+
+	vector <double> summaries(nblocks * 3);
+	int rc = _ncdfcptrs[0]->NetCDFCpp::GetVara(
+		svarname, bstart, bcount, summaries.data()
+	);
+	if (rc<0) return(rc);
+
+	bcount.pop_back();
+	bdims = bcount;
+
+	mins.resize(nblocks);
+	maxs.resize(nblocks);
+	missing.resize(nblocks);
+	for (size_t i=0; i<nblocks; i++) {
+		mins[i] = summaries[3*i];
+		maxs[i] = summaries[3*i+1];
+		missing[i] = (unsigned char) summaries[3*i+2];
+	}
+
+	return(0);
+}
+
+int WASP::GetBlockErrors(
+    vector <size_t> start, vector <size_t> count, vector <size_t> &bdims,
+	vector <double> &errors
+) {
+	bdims.clear();
+	errors.clear();
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	if (! _open || _open_write) {
+		SetErrMsg("Invalid state");
+        return(-1);
+	}
+
+	if (! _open_waspvar) return(0);
+
+	string evarname = VarNameBlockError(_open_varname);
+	if (! _ncdfcptrs[0]->InqVarDefined(evarname)) return(0);
+
+	if (start.size() != _open_udims.size() || 
+		count.size() != _open_udims.size()) {
+
+		SetErrMsg("Invalid parameter");
+        return(-1);
+	}
+
+	// Convert from voxel to block coordinates
+	//
+	vector <size_t> bstart, bcount;
+	for (int i=0; i<start.size(); i++) {
+		if (count[i] < 1 || start[i] + count[i] > _open_udims[i]) {
+			SetErrMsg("Invalid parameter");
+			return(-1);
+		}
+		size_t b0 = start[i] / _open_bs[i];
+		size_t b1 = (start[i] + count[i] - 1) / _open_bs[i];
+
+		bstart.push_back(b0);
+		bcount.push_back(b1 - b0 + 1);
+	}
+
+	errors.resize(vproduct(bcount));
+	int rc = _ncdfcptrs[0]->NetCDFCpp::GetVara(
+		evarname, bstart, bcount, errors.data()
+	);
+	if (rc<0) {
+		errors.clear();
+		return(rc);
+	}
+
+	bdims = bcount;
+	return(0);
+}
+
+int WASP::GetBlockWavelets(
+    vector <size_t> start, vector <size_t> count, vector <size_t> &bdims,
+	vector <unsigned char> &wavelets
+) {
+	bdims.clear();
+	wavelets.clear();
+
+	if (! _waspFile) {
+		SetErrMsg("Not a WASP file");
+		return(-1);
+	}
+
+	if (! _open || _open_write) {
+		SetErrMsg("Invalid state");
+        return(-1);
+	}
+
+	if (! _open_waspvar) return(0);
+
+	string wvarname = VarNameBlockWavelet(_open_varname);
+	if (! _ncdfcptrs[0]->InqVarDefined(wvarname)) return(0);
+
+	if (start.size() != _open_udims.size() || 
+		count.size() != _open_udims.size()) {
+
+		SetErrMsg("Invalid parameter");
+        return(-1);
+	}
+
+	// Convert from voxel to block coordinates
+	//
+	vector <size_t> bstart, bcount;
+	for (int i=0; i<start.size(); i++) {
+		if (count[i] < 1 || start[i] + count[i] > _open_udims[i]) {
+			SetErrMsg("Invalid parameter");
+			return(-1);
+		}
+		size_t b0 = start[i] / _open_bs[i];
+		size_t b1 = (start[i] + count[i] - 1) / _open_bs[i];
+
+		bstart.push_back(b0);
+		bcount.push_back(b1 - b0 + 1);
+	}
+
+	wavelets.resize(vproduct(bcount));
+	int rc = _ncdfcptrs[0]->NetCDFCpp::GetVara(
+		wvarname, bstart, bcount, wavelets.data()
+	);
+	if (rc<0) {
+		wavelets.clear();
+		return(rc);
+	}
+
+	bdims = bcount;
+	return(0);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //
 // GetVar - double
@@ -3437,6 +4956,13 @@ int WASP::_GetCompressedDims(
 
 	
 
+int WASP::_sigmap_version() const {
+
+	// Version 4 files added bitmap encoded significance maps 
+	//
+	return(_fileVersion >= 4 ? 3 : 2);
+}
+
 // For each compression level (LOD) compute the number of coefficients,
 // ncoeffs, and the dimension of array that will contain both the
 // coefficients and the significance map
@@ -3463,6 +4989,7 @@ void WASP::_get_encoding_vectors(
 	}
 	
     Compressor compressor(compressor_bs(bs), wname);
+	compressor.SigMapVersion() = _sigmap_version();
 
 	// Total number of wavelet coefficients generated by a forward transform
 	//
@@ -105,6 +105,13 @@ void WaveFiltInt::Analysis(
   }
 }
 
+// The lifting steps below are computed entirely in integer arithmetic.
+// For integers a, b: floor(0.5 * (a+b)) == (a+b) >> 1, and 
+// floor(0.25 * (a+b) + 0.5) == (a+b+2) >> 2, given an arithmetic right 
+// shift. Avoiding the round trip through floating point makes the 
+// loops several times faster, and simple enough for the compiler
+// to vectorize.
+//
 void WaveFiltInt::_AnalysisCDF5_3(
     const long *sigIn, size_t sigInLen, long *cA, long *cD
 ) const {
@@ -115,28 +122,28 @@ void WaveFiltInt::_AnalysisCDF5_3(
 	if (sigInLen % 2) nC++;
 
 	for (size_t i=0; i<nD; i++) {
-		cD[i] = x[2*i+1] - floor(0.5 * (x[2*(i+1)] + x[2*i]));
+		cD[i] = x[2*i+1] - ((x[2*(i+1)] + x[2*i]) >> 1);
 	}
 
 	// Left boundary of approximation coefficients requires special 
 	// handling (we don't have cD[i] for i==-1
 	//
-	long cDm1 = x[-1] - floor(0.5 * (x[0] + x[-2]));
-	cA[0] = x[0] + floor(0.25 * (cD[0] + cDm1) + 0.5);
+	long cDm1 = x[-1] - ((x[0] + x[-2]) >> 1);
+	cA[0] = x[0] + ((cD[0] + cDm1 + 2) >> 2);
 
 	// For even length signals nD=nC. For odd, nD=nC-1 and we need
 	// special handling for right boundary
 	//
 	for (size_t i=1; i<nD; i++) {
-		cA[i] = x[2*i] + floor(0.25 * (cD[i] + cD[i-1]) +0.5);
+		cA[i] = x[2*i] + ((cD[i] + cD[i-1] + 2) >> 2);
 	}
 
 	// Boundary handling for odd length signals
 	//
 	if (sigInLen % 2) {
 		size_t i = nC-1;
-		long cDp1  = x[2*i+1] - floor(0.5 * (x[2*(i+1)] + x[2*i]));
-		cA[i] = x[2*i] + floor(0.25 * (cDp1 + cD[i-1]) +0.5);
+		long cDp1  = x[2*i+1] - ((x[2*(i+1)] + x[2*i]) >> 1);
+		cA[i] = x[2*i] + ((cDp1 + cD[i-1] + 2) >> 2);
 	}
 }
 
@@ -162,19 +169,19 @@ void WaveFiltInt::_SynthesisCDF5_3(
 	// Even samples
 	//
 	for (size_t i=0; i<n; i++) {
-		sigOut[2*i] = cA[i] - floor(0.25 * (cD[i-1]+cD[i]) + 0.5);
+		sigOut[2*i] = cA[i] - ((cD[i-1] + cD[i] + 2) >> 2);
 	}
 
 	// Odd  samples
 	//
 	for (size_t i=0; i<n-1; i++) {
-		sigOut[2*i+1] = cD[i] + floor(0.5 * (sigOut[2*(i+1)]+sigOut[2*i]));
+		sigOut[2*i+1] = cD[i] + ((sigOut[2*(i+1)] + sigOut[2*i]) >> 1);
 	}
 
 	// Right boundary requires special handling - we don't have 
 	// even sample for sigOut[2*(i+1)] when i==n-1
 	//
 	size_t i = n-1;
-	long sp1 = cA[n] - floor(0.25 * (cD[n-1]+cD[n]) + 0.5);
-	sigOut[2*i+1] = cD[i] + floor(0.5 * (sp1+sigOut[2*i]));
+	long sp1 = cA[n] - ((cD[n-1] + cD[n] + 2) >> 2);
+	sigOut[2*i+1] = cD[i] + ((sp1 + sigOut[2*i]) >> 1);
 }
@@ -27,6 +27,7 @@ struct {
 	string varname;
 	string savefilebase;
 	string ftype;
+	string trace;
 	std::vector <double> minu;
 	std::vector <double> maxu;
 	OptionParser::Boolean_T	dump;
@@ -34,6 +35,7 @@ struct {
 	OptionParser::Boolean_T	nogeoxform;
 	OptionParser::Boolean_T	novertxform;
 	OptionParser::Boolean_T	verbose;
+	OptionParser::Boolean_T	stats;
 	OptionParser::Boolean_T	help;
 	OptionParser::Boolean_T	quiet;
 	OptionParser::Boolean_T	debug;
@@ -51,6 +53,7 @@ OptionParser::OptDescRec_T	set_opts[] = {
 	{"varname",	1, 	"",	"Name of variable"},
 	{"savefilebase",	1, 	"",	"Base path name to output file"},
 	{"ftype",	1,	"vdc",	"data set type (vdc|wrf|cf|mpas)"},
+	{"trace",	1, 	"",	"Write a Chrome trace of DataMgr I/O to this file"},
 	{
 		"minu",  1,  "",  "Colon delimited 3-element vector "
 		"specifying domain min extents in user coordinates (X0:Y0:Z0)"
@@ -60,6 +63,7 @@ OptionParser::OptDescRec_T	set_opts[] = {
 		"specifying domain max extents in user coordinates (X1:Y1:Z1)"
 	},
 	{"verbose",	0,	"",	"Verobse output"},
+	{"stats",	0,	"",	"Print DataMgr cache statistics"},
 	{"tgetvalue",	0,	"",	"Apply Grid:;GetValue test"},
 	{"dump",	0,	"",	"Dump variable coordinates and data"},
 	{"nogeoxform",	0,	"",	"Do not apply geographic transform (projection to PCS"},
@@ -82,9 +86,11 @@ OptionParser::Option_T	get_options[] = {
 	{"varname", Wasp::CvtToCPPStr, &opt.varname, sizeof(opt.varname)},
 	{"savefilebase", Wasp::CvtToCPPStr, &opt.savefilebase, sizeof(opt.savefilebase)},
 	{"ftype", Wasp::CvtToCPPStr, &opt.ftype, sizeof(opt.ftype)},
+	{"trace", Wasp::CvtToCPPStr, &opt.trace, sizeof(opt.trace)},
 	{"minu", Wasp::CvtToDoubleVec, &opt.minu, sizeof(opt.minu)},
 	{"maxu", Wasp::CvtToDoubleVec, &opt.maxu, sizeof(opt.maxu)},
 	{"verbose", Wasp::CvtToBoolean, &opt.verbose, sizeof(opt.verbose)},
+	{"stats", Wasp::CvtToBoolean, &opt.stats, sizeof(opt.stats)},
 	{"dump", Wasp::CvtToBoolean, &opt.dump, sizeof(opt.dump)},
 	{"tgetvalue", Wasp::CvtToBoolean, &opt.tgetvalue, sizeof(opt.tgetvalue)},
 	{"nogeoxform", Wasp::CvtToBoolean, &opt.nogeoxform, sizeof(opt.nogeoxform)},
@@ -356,6 +362,44 @@ void process(FILE *fp, DataMgr &datamgr, string vname, int loop, int ts) {
 	cout << endl;
 	delete g;
 }
+
+void print_counters(string label, const DataMgr::CacheCounters &c) {
+	cout << setw(16) << label 
+		<< setw(8) << c.hits
+		<< setw(8) << c.superset_hits
+		<< setw(8) << c.misses
+		<< setw(8) << c.evictions
+		<< setw(14) << c.bytes_read
+		<< setw(10) << setprecision(4) << c.read_time
+		<< setw(10) << setprecision(4) << c.derived_time
+		<< setw(10) << setprecision(4) << c.lock_wait_time << endl;
+}
+
+void print_stats(const DataMgr &datamgr) {
+	DataMgr::CacheStats stats;
+	datamgr.GetCacheStats(stats);
+
+	cout << "Cached regions : " << stats.num_regions << " (" <<
+		stats.bytes_cached << " bytes)" << endl;
+	cout << "Pool occupancy : " << stats.pool.Occupancy() << endl;
+	cout << "Pool fragmentation : " << stats.pool.Fragmentation() << endl;
+	cout << "Pool huge page blocks : " << stats.pool.huge_page_blks << endl;
+	cout << "Pool NUMA nodes : " << stats.pool.numa_nodes << endl;
+
+	cout << setw(16) << "" << setw(8) << "hits" << setw(8) << "subset" 
+		<< setw(8) << "misses" << setw(8) << "evicts" << setw(14) << "bytes" 
+		<< setw(10) << "read(s)" << setw(10) << "derive(s)" 
+		<< setw(10) << "wait(s)" << endl;
+	print_counters("total", stats.total);
+	for (auto itr = stats.variables.begin(); itr!=stats.variables.end(); ++itr) {
+		print_counters(itr->first, itr->second);
+	}
+	for (auto itr = stats.timesteps.begin(); itr!=stats.timesteps.end(); ++itr) {
+		ostringstream oss;
+		oss << "ts " << itr->first;
+		print_counters(oss.str(), itr->second);
+	}
+}
 		
 
 int main(int argc, char **argv) {
@@ -412,6 +456,10 @@ int main(int argc, char **argv) {
 	if (! opt.novertxform) {
 		options.push_back("-vertical_xform");
 	}
+	if (! opt.trace.empty()) {
+		options.push_back("-trace");
+		options.push_back(opt.trace);
+	}
 	DataMgr	datamgr(opt.ftype, opt.memsize, opt.nthreads);
 	int rc = datamgr.Initialize(files, options);
 	if (rc<0) exit(1);
@@ -449,6 +497,8 @@ int main(int argc, char **argv) {
 		fprintf(stdout, "total process time : %f\n", timer);
 	}
 
+	if (opt.stats) print_stats(datamgr);
+
 	exit(0);
 }
 
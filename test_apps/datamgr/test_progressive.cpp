@@ -0,0 +1,212 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/DataMgr.h>
+#include <vapor/FileUtils.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Exercise DataMgr::GetVariableProgressive(). A first request is
+// immediately superseded by a second, for a different time step.
+// Verify that
+//
+// - no refinement of the first request is delivered after the second
+// request is made
+// - the refinements of the second request are delivered in order of
+// increasing resolution, ending with the requested level and lod
+//
+
+struct {
+	int memsize;
+	int	nthreads;
+	int	ts0;
+	int	ts1;
+	string varname;
+	string ftype;
+	int timeout;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"memsize",	1, 	"2000","Cache size in MBs"},
+	{"nthreads",    1,  "0",    "Specify number of execution threads "
+		"0 => use number of cores"},
+	{"ts0",		1, 	"0","Time step of the superseded request"},
+	{"ts1",		1, 	"1","Time step of the second request"},
+	{"varname",	1, 	"",	"Name of variable. Default is the first 3D "
+		"variable"},
+	{"ftype",	1,	"vdc",	"data set type (vdc|wrf|cf|mpas)"},
+	{"timeout",	1,	"60",	"Seconds to wait for refinements"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"memsize", Wasp::CvtToInt, &opt.memsize, sizeof(opt.memsize)},
+	{"nthreads", Wasp::CvtToInt, &opt.nthreads, sizeof(opt.nthreads)},
+	{"ts0", Wasp::CvtToInt, &opt.ts0, sizeof(opt.ts0)},
+	{"ts1", Wasp::CvtToInt, &opt.ts1, sizeof(opt.ts1)},
+	{"varname", Wasp::CvtToCPPStr, &opt.varname, sizeof(opt.varname)},
+	{"ftype", Wasp::CvtToCPPStr, &opt.ftype, sizeof(opt.ftype)},
+	{"timeout", Wasp::CvtToInt, &opt.timeout, sizeof(opt.timeout)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// Refinements in order of delivery
+//
+struct event_t {
+	int request;
+	int level;
+	int lod;
+};
+
+std::mutex eventsMutex;
+vector <event_t> events;
+
+DataMgr::RefineCallback make_callback(int request) {
+	return([request](Grid *g, int level, int lod) {
+		delete g;
+
+		std::lock_guard <std::mutex> lock(eventsMutex);
+		event_t e = {request, level, lod};
+		events.push_back(e);
+	});
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] metafiles " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (argc < 2) {
+		cerr << "Usage: " << ProgName << " [options] metafiles " << endl;
+		exit(1);
+	}
+
+	vector <string> files;
+	for (int i=1; i<argc; i++) {
+		files.push_back(argv[i]);
+	}
+
+	DataMgr	datamgr(opt.ftype, opt.memsize, opt.nthreads);
+	int rc = datamgr.Initialize(files, vector <string> ());
+	if (rc<0) exit(1);
+
+	string varname = opt.varname;
+	if (varname.empty()) {
+		vector <string> vars = datamgr.GetDataVarNames(3);
+		if (vars.empty()) {
+			cerr << ProgName << " : no 3D variables" << endl;
+			exit(1);
+		}
+		varname = vars[0];
+	}
+
+	int level = datamgr.GetNumRefLevels(varname) - 1;
+	int lod = datamgr.GetCRatios(varname).size() - 1;
+	if (level < 1 && lod < 1) {
+		cerr << ProgName << " : " << varname << " has a single resolution" <<
+			endl;
+		exit(1);
+	}
+
+	vector <double> min, max;
+
+	Grid *g = datamgr.GetVariableProgressive(
+		opt.ts0, varname, level, lod, min, max, make_callback(0)
+	);
+	if (! g) exit(1);
+	delete g;
+
+	g = datamgr.GetVariableProgressive(
+		opt.ts1, varname, level, lod, min, max, make_callback(1)
+	);
+	if (! g) exit(1);
+	delete g;
+
+	size_t superseded;
+	{
+		std::lock_guard <std::mutex> lock(eventsMutex);
+		superseded = events.size();
+	}
+
+	// Wait for the last refinement of the second request
+	//
+	bool done = false;
+	for (int i=0; i<opt.timeout * 10 && ! done; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		std::lock_guard <std::mutex> lock(eventsMutex);
+		done = ! events.empty() && events.back().request == 1 &&
+			events.back().level == level && events.back().lod == lod;
+	}
+
+	std::lock_guard <std::mutex> lock(eventsMutex);
+
+	for (int i=0; i<events.size(); i++) {
+		cout << "request " << events[i].request << " level " <<
+			events[i].level << " lod " << events[i].lod << endl;
+	}
+
+	if (! done) {
+		cerr << ProgName << " : refinement to level " << level <<
+			" lod " << lod << " not delivered" << endl;
+		exit(1);
+	}
+
+	int level0 = 0;
+	int lod0 = 0;
+	for (size_t i=0; i<events.size(); i++) {
+		const event_t &e = events[i];
+		if (e.request == 0) {
+			if (i >= superseded) {
+				cerr << ProgName << " : superseded refinement delivered" << 
+					endl;
+				exit(1);
+			}
+			continue;
+		}
+		if (e.level < level0 || e.lod < lod0 ||
+			(e.level == level0 && e.lod == lod0)) {
+
+			cerr << ProgName << " : refinements out of order" << endl;
+			exit(1);
+		}
+		level0 = e.level;
+		lod0 = e.lod;
+	}
+
+	return(0);
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include "vapor/VAssert.h"
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/DataMgr.h>
+#include <vapor/FileUtils.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Benchmark DataMgr::RegionCache lookup latency as the number of
+// cached regions grows. Regions are synthesized over a
+// (time step x variable x level x lod x box) space similar to what
+// an interactive session generates.
+//
+
+struct {
+	int	nregions;
+	int	nsteps;
+	int	nlookups;
+	int	nvars;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"nregions",	1, 	"65536","Maximum number of cached regions"},
+	{"nsteps",	1, 	"8","Number of cache sizes to sample (doubling)"},
+	{"nlookups",	1, 	"1000000","Number of lookups per sample"},
+	{"nvars",	1, 	"16","Number of distinct variable names"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"nregions", Wasp::CvtToInt, &opt.nregions, sizeof(opt.nregions)},
+	{"nsteps", Wasp::CvtToInt, &opt.nsteps, sizeof(opt.nsteps)},
+	{"nlookups", Wasp::CvtToInt, &opt.nlookups, sizeof(opt.nlookups)},
+	{"nvars", Wasp::CvtToInt, &opt.nvars, sizeof(opt.nvars)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// Generate the identifying tuple for the i'th synthetic region
+//
+void make_region(
+	size_t i, const vector <string> &varnames, DataMgr::RegionCache::region_t &r
+) {
+	r.varname = varnames[i % varnames.size()];
+	i /= varnames.size();
+	r.level = -1 - (int) (i % 4);
+	i /= 4;
+	r.lod = -1 - (int) (i % 3);
+	i /= 3;
+	r.bmin = {i % 4, (i / 4) % 4, 0};
+	r.bmax = {r.bmin[0] + 3, r.bmin[1] + 3, 7};
+	i /= 16;
+	r.ts = i;
+	r.lock_counter = 0;
+	r.blks = NULL;
+	r.size = 4 * 64 * 64 * 64 * sizeof(float);
+	r.cost = 0.0;
+	r.hits = 1;
+	r.priority = 0.0;
+	r.last_use = 0;
+	r.prefetched = false;
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	vector <string> varnames;
+	for (int i=0; i<opt.nvars; i++) {
+		ostringstream oss;
+		oss << "variable_" << i;
+		varnames.push_back(oss.str());
+	}
+
+	// Unique fake block addresses so the blks index is populated
+	//
+	vector <char> addrs(opt.nregions);
+
+	DataMgr::RegionCache cache;
+	size_t filled = 0;
+
+	cout << setw(12) << "regions" << setw(16) << "ns/lookup" << endl;
+
+	size_t nregions = opt.nregions >> (opt.nsteps - 1);
+	if (nregions < 1) nregions = 1;
+
+	for (int step=0; step<opt.nsteps; step++, nregions <<= 1) {
+		if (nregions > (size_t) opt.nregions) nregions = opt.nregions;
+
+		for (; filled < nregions; filled++) {
+			DataMgr::RegionCache::region_t r;
+			make_region(filled, varnames, r);
+			r.blks = &addrs[filled];
+			cache.Insert(r);
+		}
+
+		// Pre-generate the query tuples so only the lookup is timed
+		//
+		vector <DataMgr::RegionCache::region_t> queries(1024);
+		for (int i=0; i<queries.size(); i++) {
+			make_region(rand() % filled, varnames, queries[i]);
+		}
+
+		size_t hits = 0;
+		double t0 = Wasp::GetTime();
+		for (int i=0; i<opt.nlookups; i++) {
+			const DataMgr::RegionCache::region_t &q = queries[i % queries.size()];
+			DataMgr::RegionCache::iterator itr = cache.Find(
+				q.ts, q.varname, q.level, q.lod, q.bmin, q.bmax
+			);
+			if (itr != cache.end()) {
+				cache.Touch(itr);
+				hits++;
+			}
+		}
+		double t1 = Wasp::GetTime();
+
+		VAssert(hits == opt.nlookups);
+
+		cout << setw(12) << filled << setw(16) <<
+			(t1 - t0) * 1e9 / opt.nlookups << endl;
+	}
+
+	return(0);
+}
@@ -0,0 +1,220 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include "vapor/VAssert.h"
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/DataMgr.h>
+#include <vapor/FileUtils.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Benchmark DataMgr::VarInfoCache lookups, as performed on every
+// call to DataMgr::GetDataRange() and DataMgr::GetVariableExtents(),
+// against the string keyed implementation it replaced.
+//
+
+struct {
+	int	nentries;
+	int	nlookups;
+	int	nvars;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"nentries",	1, 	"10000","Number of cached entries"},
+	{"nlookups",	1, 	"1000000","Number of lookups"},
+	{"nvars",	1, 	"16","Number of distinct variable names"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"nentries", Wasp::CvtToInt, &opt.nentries, sizeof(opt.nentries)},
+	{"nlookups", Wasp::CvtToInt, &opt.nlookups, sizeof(opt.nlookups)},
+	{"nvars", Wasp::CvtToInt, &opt.nvars, sizeof(opt.nvars)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// The original string keyed cache
+//
+class StringKeyedCache {
+public:
+ void Set(
+	size_t ts, vector <string> varnames, int level, int lod, string key,
+	const vector <double> &values
+ ) {
+	_cache[_make_hash(key, ts, varnames, level, lod)] = values;
+ }
+
+ bool Get(
+	size_t ts, vector <string> varnames, int level, int lod, string key,
+	vector <double> &values
+ ) const {
+	values.clear();
+	map <string, vector <double> >::const_iterator itr =
+		_cache.find(_make_hash(key, ts, varnames, level, lod));
+	if (itr == _cache.end()) return(false);
+	values = itr->second;
+	return(true);
+ }
+
+private:
+ map <string, vector <double> > _cache;
+
+ static string _make_hash(
+	string key, size_t ts, vector <string> varnames, int level, int lod
+ ) {
+	ostringstream oss;
+	oss << key << ":" << ts << ":";
+	for (int i=0; i<varnames.size(); i++) oss << varnames[i] << ":";
+	oss << level << ":" << lod;
+	return(oss.str());
+ }
+};
+
+string vector_to_string(const vector <size_t> &v) {
+	ostringstream oss;
+	oss << "[";
+	for (int i=0; i<v.size(); i++) oss << v[i] << " ";
+	oss << "]";
+	return(oss.str());
+}
+
+// Parameters of the i'th synthetic entry
+//
+void make_entry(
+	size_t i, const vector <string> &varnames, size_t &ts, string &varname,
+	int &level, int &lod, vector <size_t> &min, vector <size_t> &max
+) {
+	varname = varnames[i % varnames.size()];
+	i /= varnames.size();
+	level = -1 - (int) (i % 4);
+	i /= 4;
+	lod = -1 - (int) (i % 3);
+	i /= 3;
+	ts = i;
+	min = {0, 0, 0};
+	max = {511, 511, 99};
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	vector <string> varnames;
+	for (int i=0; i<opt.nvars; i++) {
+		ostringstream oss;
+		oss << "variable_" << i;
+		varnames.push_back(oss.str());
+	}
+
+	StringKeyedCache stringCache;
+	DataMgr::VarInfoCache <double> typedCache;
+	vector <double> range = {0.0, 1.0};
+
+	for (int i=0; i<opt.nentries; i++) {
+		size_t ts;
+		string varname;
+		int level, lod;
+		vector <size_t> min, max;
+		make_entry(i, varnames, ts, varname, level, lod, min, max);
+
+		string key = "VariableRange" + vector_to_string(min) +
+			vector_to_string(max);
+		stringCache.Set(ts, vector <string> (1, varname), level, lod, key, range);
+
+		vector <size_t> ext = min;
+		ext.insert(ext.end(), max.begin(), max.end());
+		typedCache.Set(
+			DataMgr::VarInfoKey("VariableRange", ts, varname, level, lod, ext),
+			range
+		);
+	}
+
+	// Pre-generate the query parameters so only the lookup, including
+	// construction of the key, is timed
+	//
+	vector <size_t> tss(1024);
+	vector <string> qvarnames(1024);
+	vector <int> levels(1024), lods(1024);
+	vector <vector <size_t> > mins(1024), maxs(1024);
+	for (int i=0; i<tss.size(); i++) {
+		make_entry(
+			rand() % opt.nentries, varnames, tss[i], qvarnames[i],
+			levels[i], lods[i], mins[i], maxs[i]
+		);
+	}
+
+	vector <double> values;
+	size_t hits = 0;
+	double t0 = Wasp::GetTime();
+	for (int i=0; i<opt.nlookups; i++) {
+		int j = i % tss.size();
+		ostringstream oss;
+		oss << "VariableRange";
+		oss << vector_to_string(mins[j]);
+		oss << vector_to_string(maxs[j]);
+		if (stringCache.Get(
+			tss[j], vector <string> (1, qvarnames[j]), levels[j], lods[j],
+			oss.str(), values
+		)) hits++;
+	}
+	double t1 = Wasp::GetTime();
+	VAssert(hits == opt.nlookups);
+
+	hits = 0;
+	double t2 = Wasp::GetTime();
+	for (int i=0; i<opt.nlookups; i++) {
+		int j = i % tss.size();
+		vector <size_t> ext = mins[j];
+		ext.insert(ext.end(), maxs[j].begin(), maxs[j].end());
+		if (typedCache.Get(
+			DataMgr::VarInfoKey(
+				"VariableRange", tss[j], qvarnames[j], levels[j], lods[j], ext
+			),
+			values
+		)) hits++;
+	}
+	double t3 = Wasp::GetTime();
+	VAssert(hits == opt.nlookups);
+
+	cout << setw(12) << "cache" << setw(16) << "ns/lookup" << endl;
+	cout << setw(12) << "string" << setw(16) <<
+		(t1 - t0) * 1e9 / opt.nlookups << endl;
+	cout << setw(12) << "typed" << setw(16) <<
+		(t3 - t2) * 1e9 / opt.nlookups << endl;
+
+	return(0);
+}
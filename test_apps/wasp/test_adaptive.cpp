@@ -0,0 +1,285 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <netcdf.h>
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/FileUtils.h>
+#include <vapor/NetCDFCpp.h>
+#include <vapor/WASP.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Write a field that is smooth in one half of the domain and piecewise
+// constant in the other with per-block wavelet selection enabled, and
+// verify that
+//
+// - blocks in the two halves select different wavelets
+// - the field is reconstructed at least as accurately as with the
+// default wavelet alone
+// - the file is marked so that readers predating per-block wavelets
+// refuse the variable
+//
+
+struct {
+	std::vector <int> dims;
+	std::vector <int> bs;
+	string wname;
+	std::vector <string> wnames;
+	int cratio;
+	string prefix;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"dims",	1, 	"128:128:64","Field dimensions (NX:NY:NZ)"},
+	{"bs",	1, 	"32:32:32","Block dimensions (NX:NY:NZ)"},
+	{"wname",	1, 	"bior4.4","Default wavelet name"},
+	{"wnames",	1, 	"bior1.1","Colon delimited list of candidate wavelets"},
+	{"cratio",	1, 	"16","Compression ratio"},
+	{"prefix",	1, 	"test_adaptive","Prefix of the files written"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"dims", Wasp::CvtToIntVec, &opt.dims, sizeof(opt.dims)},
+	{"bs", Wasp::CvtToIntVec, &opt.bs, sizeof(opt.bs)},
+	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"wnames", Wasp::CvtToStrVec, &opt.wnames, sizeof(opt.wnames)},
+	{"cratio", Wasp::CvtToInt, &opt.cratio, sizeof(opt.cratio)},
+	{"prefix", Wasp::CvtToCPPStr, &opt.prefix, sizeof(opt.prefix)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// Smooth waves for x < NX/2, and a staircase of constant cells,
+// unaligned with the blocks, for x >= NX/2
+//
+void make_field(const vector <size_t> &dims, vector <float> &data) {
+	data.clear();
+	for (size_t z=0; z<dims[2]; z++) {
+	for (size_t y=0; y<dims[1]; y++) {
+	for (size_t x=0; x<dims[0]; x++) {
+		if (x < dims[0] / 2) {
+			data.push_back(
+				sin(0.05 * x) * cos(0.07 * y) + 0.5 * sin(0.03 * z)
+			);
+		}
+		else {
+			int c = ((x+3) / 5) + 3 * ((y+1) / 7) + 7 * ((z+2) / 6);
+			data.push_back((float) (c % 11));
+		}
+	}
+	}
+	}
+}
+
+int write_field(
+	string path, const vector <size_t> &dims, const vector <size_t> &bs,
+	const vector <string> &wnames, const vector <float> &data
+) {
+	WASP wasp;
+
+	size_t chsz = 1024*1024;
+	int rc = wasp.Create(path, NC_CLOBBER | NC_64BIT_OFFSET, 0, chsz, 1);
+	if (rc<0) return(-1);
+
+	vector <string> dimnames = {"nz", "ny", "nx"};
+	for (int i=0; i<dimnames.size(); i++) {
+		rc = wasp.DefDim(dimnames[i], dims[dims.size()-i-1]);
+		if (rc<0) return(-1);
+	}
+
+	// NetCDF order
+	//
+	vector <size_t> ncbs(bs.rbegin(), bs.rend());
+	vector <size_t> cratios(1, opt.cratio);
+	rc = wasp.DefVar("field", NC_FLOAT, dimnames, opt.wname, ncbs, cratios);
+	if (rc<0) return(-1);
+
+	if (! wnames.empty()) {
+		rc = wasp.DefVarAdaptiveWavelet("field", wnames);
+		if (rc<0) return(-1);
+	}
+
+	rc = wasp.EndDef();
+	if (rc<0) return(-1);
+
+	rc = wasp.OpenVarWrite("field", -1);
+	if (rc<0) return(-1);
+
+	rc = wasp.PutVar(data.data());
+	if (rc<0) return(-1);
+
+	rc = wasp.CloseVar();
+	if (rc<0) return(-1);
+
+	return(wasp.Close());
+}
+
+// Read the field back, returning its RMS error and the set of wavelets
+// selected by its blocks
+//
+int read_field(
+	string path, const vector <size_t> &dims, const vector <float> &data,
+	double &rms, set <unsigned char> &selected
+) {
+	rms = 0.0;
+	selected.clear();
+
+	WASP wasp;
+
+	int rc = wasp.Open(path, NC_NOWRITE);
+	if (rc<0) return(-1);
+
+	string wname;
+	vector <size_t> bs, cratios;
+	rc = wasp.InqVarCompressionParams("field", wname, bs, cratios);
+	if (rc<0) return(-1);
+
+	if (wname != opt.wname) {
+		cerr << ProgName << " : " << path << " : wavelet " << wname <<
+			" should be " << opt.wname << endl;
+		return(-1);
+	}
+
+	rc = wasp.OpenVarRead("field", -1, -1);
+	if (rc<0) return(-1);
+
+	vector <float> result(data.size());
+	rc = wasp.GetVar(result.data());
+	if (rc<0) return(-1);
+
+	vector <size_t> start(dims.size(), 0);
+	vector <size_t> count(dims.rbegin(), dims.rend());
+	vector <size_t> bdims;
+	vector <unsigned char> wavelets;
+	rc = wasp.GetBlockWavelets(start, count, bdims, wavelets);
+	if (rc<0) return(-1);
+
+	selected.insert(wavelets.begin(), wavelets.end());
+
+	(void) wasp.CloseVar();
+	(void) wasp.Close();
+
+	for (size_t i=0; i<data.size(); i++) {
+		double d = result[i] - data[i];
+		rms += d * d;
+	}
+	rms = sqrt(rms / data.size());
+
+	return(0);
+}
+
+// Verify the file version, and that the stored wavelet name can't be
+// used by older readers
+//
+int check_marked(string path) {
+	NetCDFCpp ncdf;
+
+	int rc = ncdf.Open(path, NC_NOWRITE);
+	if (rc<0) return(-1);
+
+	int version;
+	rc = ncdf.GetAtt("", WASP::AttNameVersion(), version);
+	if (rc<0) return(-1);
+
+	string wname;
+	rc = ncdf.GetAtt("field", WASP::AttNameWavelet(), wname);
+	if (rc<0) return(-1);
+
+	(void) ncdf.Close();
+
+	if (version < 5 || wname == opt.wname) {
+		cerr << ProgName << " : " << path <<
+			" : adaptive variable is readable by older versions" << endl;
+		return(-1);
+	}
+	return(0);
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (opt.dims.size() != 3 || opt.bs.size() != 3) {
+		cerr << ProgName << " : dims and bs must be three dimensional" << endl;
+		exit(1);
+	}
+
+	vector <size_t> dims(opt.dims.begin(), opt.dims.end());
+	vector <size_t> bs(opt.bs.begin(), opt.bs.end());
+
+	vector <float> data;
+	make_field(dims, data);
+
+	string adaptive_path = opt.prefix + "_adaptive.nc";
+	string single_path = opt.prefix + "_single.nc";
+
+	if (write_field(adaptive_path, dims, bs, opt.wnames, data) < 0) exit(1);
+	if (write_field(single_path, dims, bs, vector <string> (), data) < 0) {
+		exit(1);
+	}
+
+	double adaptive_rms, single_rms;
+	set <unsigned char> adaptive_selected, single_selected;
+
+	int rc = read_field(
+		adaptive_path, dims, data, adaptive_rms, adaptive_selected
+	);
+	if (rc<0) exit(1);
+
+	rc = read_field(single_path, dims, data, single_rms, single_selected);
+	if (rc<0) exit(1);
+
+	if (check_marked(adaptive_path) < 0) exit(1);
+
+	cout << setw(14) << "single rms" << setw(14) << "adaptive rms" <<
+		setw(10) << "wavelets" << endl;
+	cout << setw(14) << single_rms << setw(14) << adaptive_rms <<
+		setw(10) << adaptive_selected.size() << endl;
+
+	if (adaptive_selected.size() < 2) {
+		cerr << ProgName << " : blocks did not select different wavelets" <<
+			endl;
+		exit(1);
+	}
+
+	if (adaptive_rms > single_rms) {
+		cerr << ProgName << " : per-block wavelets increased error" << endl;
+		exit(1);
+	}
+
+	return(0);
+}
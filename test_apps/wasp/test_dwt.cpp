@@ -0,0 +1,166 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "vapor/VAssert.h"
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/FileUtils.h>
+#include <vapor/Compressor.h>
+#include <vapor/MatWaveDwt.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Benchmark wavelet compression and decompression of blocks with 
+// each of the instruction sets supported by MatWaveDwt::SetSIMD(),
+// and verify that all of them reconstruct identical data.
+//
+
+struct {
+	std::vector <int> bs;
+	string wname;
+	int	nblocks;
+	int	cratio;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"bs",	1, 	"64:64:64","Block dimensions (NX:NY:NZ)"},
+	{"wname",	1, 	"bior4.4","Wavelet name"},
+	{"nblocks",	1, 	"32","Number of blocks to transform"},
+	{"cratio",	1, 	"8","Compression ratio"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"bs", Wasp::CvtToIntVec, &opt.bs, sizeof(opt.bs)},
+	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"nblocks", Wasp::CvtToInt, &opt.nblocks, sizeof(opt.nblocks)},
+	{"cratio", Wasp::CvtToInt, &opt.cratio, sizeof(opt.cratio)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+const char *simd_names[] = {"none", "generic", "sse2", "avx2", "avx512"};
+
+// Smooth field with some noise, so that coefficients compress 
+// realistically
+//
+void make_block(int b, const vector <size_t> &dims, float *data) {
+	size_t n = 0;
+	for (size_t z=0; z<dims[2]; z++) {
+	for (size_t y=0; y<dims[1]; y++) {
+	for (size_t x=0; x<dims[0]; x++) {
+		data[n++] = sin(0.1 * x + b) * cos(0.07 * y) + 0.01 * z + 
+			0.001 * (rand() % 100);
+	}
+	}
+	}
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (opt.bs.size() != 3) {
+		cerr << ProgName << " : block must be three dimensional" << endl;
+		exit(1);
+	}
+
+	vector <size_t> dims(opt.bs.begin(), opt.bs.end());
+	size_t block_size = dims[0] * dims[1] * dims[2];
+
+	Compressor cmp(dims, opt.wname);
+	if (Compressor::GetErrCode() != 0) exit(1);
+
+	size_t ncoeffs = cmp.GetNumWaveCoeffs() / opt.cratio;
+	vector <size_t> sigdims;
+	cmp.GetSigMapShape(sigdims);
+
+	vector <float> data(block_size * opt.nblocks);
+	for (int b=0; b<opt.nblocks; b++) {
+		make_block(b, dims, data.data() + b * block_size);
+	}
+
+	vector <float> coeffs(ncoeffs * opt.nblocks);
+	vector <SignificanceMap> sigmaps(opt.nblocks, SignificanceMap(sigdims));
+	vector <float> reference(block_size * opt.nblocks);
+	vector <float> result(block_size * opt.nblocks);
+
+	double mbytes = (double) block_size * opt.nblocks * sizeof(float) / 1e6;
+	double decode0 = 0.0;
+
+	cout << setw(10) << "simd" << setw(14) << "encode MB/s" << 
+		setw(14) << "decode MB/s" << setw(10) << "speedup" << endl;
+
+	for (int s = MatWaveDwt::SIMD_NONE; s <= MatWaveDwt::GetSIMDSupported(); s++) {
+		MatWaveDwt::SetSIMD((MatWaveDwt::simd_t) s);
+
+		double t0 = Wasp::GetTime();
+		for (int b=0; b<opt.nblocks; b++) {
+			int rc = cmp.Compress(
+				data.data() + b * block_size, coeffs.data() + b * ncoeffs, 
+				ncoeffs, &sigmaps[b]
+			);
+			if (rc<0) exit(1);
+		}
+		double t1 = Wasp::GetTime();
+
+		float *out = s == MatWaveDwt::SIMD_NONE ? 
+			reference.data() : result.data();
+		for (int b=0; b<opt.nblocks; b++) {
+			int rc = cmp.Decompress(
+				coeffs.data() + b * ncoeffs, out + b * block_size, 
+				&sigmaps[b]
+			);
+			if (rc<0) exit(1);
+		}
+		double t2 = Wasp::GetTime();
+
+		if (s == MatWaveDwt::SIMD_NONE) decode0 = t2 - t1;
+		else if (memcmp(
+			reference.data(), result.data(), reference.size() * sizeof(float)
+		) != 0) {
+			cerr << ProgName << " : " << simd_names[s] << 
+				" reconstruction differs" << endl;
+			exit(1);
+		}
+
+		cout << setw(10) << simd_names[s] << 
+			setw(14) << mbytes / (t1 - t0) <<
+			setw(14) << mbytes / (t2 - t1) <<
+			setw(10) << decode0 / (t2 - t1) << endl;
+	}
+
+	return(0);
+}
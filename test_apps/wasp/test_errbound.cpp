@@ -0,0 +1,283 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <netcdf.h>
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/FileUtils.h>
+#include <vapor/WASP.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Write a smooth and a rough field with an absolute error bound, and
+// verify that
+//
+// - every block of the smooth field meets the bound
+// - the rough field has blocks that can't meet the bound within the
+// compression ratio, and reports them
+// - for every block of both fields the maximum error of the decoded
+// data does not exceed the error reported by GetBlockErrors()
+//
+
+struct {
+	std::vector <int> dims;
+	std::vector <int> bs;
+	string wname;
+	int cratio;
+	double errbound;
+	string prefix;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"dims",	1, 	"128:128:64","Field dimensions (NX:NY:NZ). Must be "
+		"a multiple of the block dimensions"},
+	{"bs",	1, 	"32:32:32","Block dimensions (NX:NY:NZ)"},
+	{"wname",	1, 	"bior4.4","Wavelet name"},
+	{"cratio",	1, 	"16","Compression ratio"},
+	{"errbound",	1, 	"0.01","Absolute error bound"},
+	{"prefix",	1, 	"test_errbound","Prefix of the files written"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"dims", Wasp::CvtToIntVec, &opt.dims, sizeof(opt.dims)},
+	{"bs", Wasp::CvtToIntVec, &opt.bs, sizeof(opt.bs)},
+	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"cratio", Wasp::CvtToInt, &opt.cratio, sizeof(opt.cratio)},
+	{"errbound", Wasp::CvtToDouble, &opt.errbound, sizeof(opt.errbound)},
+	{"prefix", Wasp::CvtToCPPStr, &opt.prefix, sizeof(opt.prefix)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// Allowance for rounding the reconstruction to single precision, which
+// isn't accounted for by the recorded errors
+//
+const double roundOff = 1e-6;
+
+void make_smooth(const vector <size_t> &dims, vector <float> &data) {
+	data.clear();
+	for (size_t z=0; z<dims[2]; z++) {
+	for (size_t y=0; y<dims[1]; y++) {
+	for (size_t x=0; x<dims[0]; x++) {
+		data.push_back(
+			sin(0.05 * x) * cos(0.04 * y) + 0.5 * sin(0.03 * z)
+		);
+	}
+	}
+	}
+}
+
+// Uniformly distributed noise, which wavelets can't compress
+//
+void make_rough(const vector <size_t> &dims, vector <float> &data) {
+	data.clear();
+	unsigned long seed = 1;
+	for (size_t i=0; i<dims[0]*dims[1]*dims[2]; i++) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		data.push_back((double) (seed >> 11) / (double) (1UL << 53));
+	}
+}
+
+int write_field(
+	string path, const vector <size_t> &dims, const vector <size_t> &bs,
+	const vector <float> &data
+) {
+	WASP wasp;
+
+	size_t chsz = 1024*1024;
+	int rc = wasp.Create(path, NC_CLOBBER | NC_64BIT_OFFSET, 0, chsz, 1);
+	if (rc<0) return(-1);
+
+	vector <string> dimnames = {"nz", "ny", "nx"};
+	for (int i=0; i<dimnames.size(); i++) {
+		rc = wasp.DefDim(dimnames[i], dims[dims.size()-i-1]);
+		if (rc<0) return(-1);
+	}
+
+	// NetCDF order
+	//
+	vector <size_t> ncbs(bs.rbegin(), bs.rend());
+	vector <size_t> cratios(1, opt.cratio);
+	rc = wasp.DefVar("field", NC_FLOAT, dimnames, opt.wname, ncbs, cratios);
+	if (rc<0) return(-1);
+
+	rc = wasp.DefVarErrorBound("field", opt.errbound);
+	if (rc<0) return(-1);
+
+	rc = wasp.EndDef();
+	if (rc<0) return(-1);
+
+	rc = wasp.OpenVarWrite("field", -1);
+	if (rc<0) return(-1);
+
+	rc = wasp.PutVar(data.data());
+	if (rc<0) return(-1);
+
+	rc = wasp.CloseVar();
+	if (rc<0) return(-1);
+
+	return(wasp.Close());
+}
+
+// Read the field back, and compare the decoded error of each block with
+// the error recorded for it. Returns the number of blocks exceeding the
+// error bound
+//
+int check_field(
+	string path, const vector <size_t> &dims, const vector <size_t> &bs,
+	const vector <float> &data
+) {
+	WASP wasp;
+
+	int rc = wasp.Open(path, NC_NOWRITE);
+	if (rc<0) return(-1);
+
+	double errbound;
+	bool relative;
+	rc = wasp.InqVarErrorBound("field", errbound, relative);
+	if (rc<0) return(-1);
+
+	if (errbound != opt.errbound || relative) {
+		cerr << ProgName << " : " << path << " : wrong error bound" << endl;
+		return(-1);
+	}
+
+	rc = wasp.OpenVarRead("field", -1, -1);
+	if (rc<0) return(-1);
+
+	vector <float> result(data.size());
+	rc = wasp.GetVar(result.data());
+	if (rc<0) return(-1);
+
+	vector <size_t> start(dims.size(), 0);
+	vector <size_t> count(dims.rbegin(), dims.rend());
+	vector <size_t> bdims;
+	vector <double> errors;
+	rc = wasp.GetBlockErrors(start, count, bdims, errors);
+	if (rc<0) return(-1);
+
+	(void) wasp.CloseVar();
+	(void) wasp.Close();
+
+	// Block dimensions in NetCDF order
+	//
+	size_t nbx = dims[0] / bs[0];
+	size_t nby = dims[1] / bs[1];
+	size_t nbz = dims[2] / bs[2];
+	if (bdims.size() != 3 || bdims[0] != nbz || bdims[1] != nby ||
+		bdims[2] != nbx) {
+
+		cerr << ProgName << " : " << path << " : wrong block dimensions" <<
+			endl;
+		return(-1);
+	}
+
+	vector <double> maxerrs(errors.size(), 0.0);
+	for (size_t z=0; z<dims[2]; z++) {
+	for (size_t y=0; y<dims[1]; y++) {
+	for (size_t x=0; x<dims[0]; x++) {
+		size_t i = z*dims[0]*dims[1] + y*dims[0] + x;
+		size_t b = (z/bs[2])*nbx*nby + (y/bs[1])*nbx + (x/bs[0]);
+
+		double err = fabs((double) result[i] - (double) data[i]);
+		if (err > maxerrs[b]) maxerrs[b] = err;
+	}
+	}
+	}
+
+	int nexceed = 0;
+	for (size_t b=0; b<errors.size(); b++) {
+		if (maxerrs[b] > errors[b] + roundOff) {
+			cerr << ProgName << " : " << path << " : block " << b <<
+				" error " << maxerrs[b] << " exceeds recorded error " <<
+				errors[b] << endl;
+			return(-1);
+		}
+		if (errors[b] > opt.errbound) nexceed++;
+	}
+	return(nexceed);
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (opt.dims.size() != 3 || opt.bs.size() != 3) {
+		cerr << ProgName << " : dims and bs must be three dimensional" << endl;
+		exit(1);
+	}
+
+	vector <size_t> dims(opt.dims.begin(), opt.dims.end());
+	vector <size_t> bs(opt.bs.begin(), opt.bs.end());
+	for (int i=0; i<dims.size(); i++) {
+		if (dims[i] % bs[i]) {
+			cerr << ProgName << " : dims must be a multiple of bs" << endl;
+			exit(1);
+		}
+	}
+
+	vector <float> smooth, rough;
+	make_smooth(dims, smooth);
+	make_rough(dims, rough);
+
+	string smooth_path = opt.prefix + "_smooth.nc";
+	string rough_path = opt.prefix + "_rough.nc";
+
+	if (write_field(smooth_path, dims, bs, smooth) < 0) exit(1);
+	if (write_field(rough_path, dims, bs, rough) < 0) exit(1);
+
+	int smooth_exceed = check_field(smooth_path, dims, bs, smooth);
+	if (smooth_exceed < 0) exit(1);
+
+	int rough_exceed = check_field(rough_path, dims, bs, rough);
+	if (rough_exceed < 0) exit(1);
+
+	cout << setw(10) << "field" << setw(20) << "blocks over bound" << endl;
+	cout << setw(10) << "smooth" << setw(20) << smooth_exceed << endl;
+	cout << setw(10) << "rough" << setw(20) << rough_exceed << endl;
+
+	if (smooth_exceed) {
+		cerr << ProgName << " : smooth field exceeds error bound" << endl;
+		exit(1);
+	}
+
+	if (! rough_exceed) {
+		cerr << ProgName << " : rough field unexpectedly meets error bound" <<
+			endl;
+		exit(1);
+	}
+
+	return(0);
+}
@@ -0,0 +1,229 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <netcdf.h>
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/FileUtils.h>
+#include <vapor/WASP.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+//
+// Write a masked, categorical integer field with an integer wavelet
+// and verify that every valid value is reconstructed exactly, and 
+// that the entropy coded file is smaller than the raw data. Integer 
+// wavelets must be refused in a 64-bit offset file, where the 
+// coefficients can't be entropy coded.
+//
+
+struct {
+	std::vector <int> dims;
+	std::vector <int> bs;
+	string wname;
+	int	nclasses;
+	string prefix;
+	OptionParser::Boolean_T	help;
+} opt;
+
+OptionParser::OptDescRec_T	set_opts[] = {
+	{"dims",	1, 	"200:150:50","Field dimensions (NX:NY:NZ)"},
+	{"bs",	1, 	"64:64:64","Block dimensions (NX:NY:NZ)"},
+	{"wname",	1, 	"intbior2.2","Integer wavelet name"},
+	{"nclasses",	1, 	"12","Number of categories in the field"},
+	{"prefix",	1, 	"test_lossless","Prefix of the files written"},
+	{"help",	0,	"",	"Print this message and exit"},
+	{NULL}
+};
+
+OptionParser::Option_T	get_options[] = {
+	{"dims", Wasp::CvtToIntVec, &opt.dims, sizeof(opt.dims)},
+	{"bs", Wasp::CvtToIntVec, &opt.bs, sizeof(opt.bs)},
+	{"wname", Wasp::CvtToCPPStr, &opt.wname, sizeof(opt.wname)},
+	{"nclasses", Wasp::CvtToInt, &opt.nclasses, sizeof(opt.nclasses)},
+	{"prefix", Wasp::CvtToCPPStr, &opt.prefix, sizeof(opt.prefix)},
+	{"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+	{NULL}
+};
+
+const char	*ProgName;
+
+// Piecewise constant categories, like a land use field, with values
+// missing over an elliptical "ocean"
+//
+void make_field(
+	const vector <size_t> &dims, int nclasses,
+	vector <int> &data, vector <unsigned char> &mask
+) {
+	data.clear();
+	mask.clear();
+	for (size_t z=0; z<dims[2]; z++) {
+	for (size_t y=0; y<dims[1]; y++) {
+	for (size_t x=0; x<dims[0]; x++) {
+		int c = (x / 23) + 3 * (y / 17) + 7 * (z / 9);
+		data.push_back(c % nclasses);
+
+		double dx = (double) x / dims[0] - 0.3;
+		double dy = (double) y / dims[1] - 0.6;
+		mask.push_back(dx*dx + 2*dy*dy > 0.04);
+	}
+	}
+	}
+}
+
+size_t file_size(string path) {
+	struct stat statbuf;
+	if (stat(path.c_str(), &statbuf) < 0) return(0);
+	return(statbuf.st_size);
+}
+
+int write_field(
+	string path, int cmode, const vector <size_t> &dims,
+	const vector <size_t> &bs, const vector <int> &data,
+	const vector <unsigned char> &mask
+) {
+	WASP wasp;
+
+	size_t chsz = 1024*1024;
+	int rc = wasp.Create(path, cmode, 0, chsz, 1);
+	if (rc<0) return(-1);
+
+	vector <string> dimnames = {"nz", "ny", "nx"};
+	for (int i=0; i<dimnames.size(); i++) {
+		rc = wasp.DefDim(dimnames[i], dims[dims.size()-i-1]);
+		if (rc<0) return(-1);
+	}
+
+	// NetCDF order
+	//
+	vector <size_t> ncbs(bs.rbegin(), bs.rend());
+	vector <size_t> cratios(1, 1);
+	rc = wasp.DefVar("landuse", NC_INT, dimnames, opt.wname, ncbs, cratios);
+	if (rc<0) return(-1);
+
+	rc = wasp.EndDef();
+	if (rc<0) return(-1);
+
+	rc = wasp.OpenVarWrite("landuse", -1);
+	if (rc<0) return(-1);
+
+	rc = wasp.PutVar(data.data(), mask.data());
+	if (rc<0) return(-1);
+
+	rc = wasp.CloseVar();
+	if (rc<0) return(-1);
+
+	return(wasp.Close());
+}
+
+int check_field(
+	string path, const vector <int> &data, const vector <unsigned char> &mask
+) {
+	WASP wasp;
+
+	int rc = wasp.Open(path, NC_NOWRITE);
+	if (rc<0) return(-1);
+
+	rc = wasp.OpenVarRead("landuse", -1, -1);
+	if (rc<0) return(-1);
+
+	vector <int> result(data.size());
+	rc = wasp.GetVar(result.data());
+	if (rc<0) return(-1);
+
+	(void) wasp.CloseVar();
+	(void) wasp.Close();
+
+	size_t nerrors = 0;
+	for (size_t i=0; i<data.size(); i++) {
+		if (mask[i] && result[i] != data[i]) nerrors++;
+	}
+	if (nerrors) {
+		cerr << ProgName << " : " << path << " : " << nerrors <<
+			" values differ" << endl;
+		return(-1);
+	}
+	return(0);
+}
+
+int main(int argc, char **argv) {
+
+	OptionParser op;
+
+	ProgName = FileUtils::LegacyBasename(argv[0]);
+
+	MyBase::SetErrMsgFilePtr(stderr);
+
+	if (op.AppendOptions(set_opts) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (op.ParseOptions(&argc, argv, get_options) < 0) {
+		cerr << ProgName << " : " << op.GetErrMsg();
+		exit(1);
+	}
+
+	if (opt.help) {
+		cerr << "Usage: " << ProgName << " [options] " << endl;
+		op.PrintOptionHelp(stderr);
+		exit(0);
+	}
+
+	if (opt.dims.size() != 3 || opt.bs.size() != 3) {
+		cerr << ProgName << " : dims and bs must be three dimensional" << endl;
+		exit(1);
+	}
+
+	vector <size_t> dims(opt.dims.begin(), opt.dims.end());
+	vector <size_t> bs(opt.bs.begin(), opt.bs.end());
+
+	vector <int> data;
+	vector <unsigned char> mask;
+	make_field(dims, opt.nclasses, data, mask);
+
+	string coded_path = opt.prefix + "_nc4.nc";
+	string plain_path = opt.prefix + "_nc3.nc";
+
+	int rc = write_field(
+		coded_path, NC_CLOBBER | NC_NETCDF4, dims, bs, data, mask
+	);
+	if (rc<0) exit(1);
+
+	if (check_field(coded_path, data, mask) < 0) exit(1);
+
+	// Expected to fail
+	//
+	bool enabled = MyBase::EnableErrMsg(false);
+	rc = write_field(
+		plain_path, NC_CLOBBER | NC_64BIT_OFFSET, dims, bs, data, mask
+	);
+	(void) MyBase::EnableErrMsg(enabled);
+	if (rc == 0) {
+		cerr << ProgName << " : integer wavelet accepted by " << 
+			plain_path << endl;
+		exit(1);
+	}
+
+	size_t raw_size = data.size() * sizeof(data[0]);
+	size_t coded_size = file_size(coded_path);
+
+	cout << setw(12) << "raw bytes" << setw(14) << "nc4 bytes" <<
+		setw(10) << "ratio" << endl;
+	cout << setw(12) << raw_size << setw(14) << coded_size << setw(10) <<
+		(double) raw_size / (double) coded_size << endl;
+
+	if (! coded_size || coded_size >= raw_size) {
+		cerr << ProgName << " : entropy coding did not reduce file size" <<
+			endl;
+		exit(1);
+	}
+
+	return(0);
+}